@@ -101,6 +101,17 @@ typedef struct  xkrt_access_t
     } region;
 }               xkrt_access_t;
 
+/* outcome of the accesses fetched onto a device */
+typedef struct  xkrt_device_coherence_stats_t
+{
+    unsigned long hits;         /* already valid on the device */
+    unsigned long misses;       /* launched at least one transfer */
+    unsigned long joined;       /* awaited an in-flight transfer or forward instead */
+    unsigned long overwrites;   /* not valid on the device, but never read so nothing transferred */
+    unsigned long evictions;    /* chunks evicted */
+    unsigned long evicted;      /* bytes evicted */
+}               xkrt_device_coherence_stats_t;
+
 /* Runtime init */
 int  xkrt_init  (xkrt_runtime_t ** runtime);
 int  xkrt_deinit(xkrt_runtime_t  * runtime);
@@ -134,6 +145,9 @@ xkrt_device_driver_id_t xkrt_device_driver_id_get(xkrt_runtime_t * runtime, xkrt
 unsigned int xkrt_get_ndevices    (xkrt_runtime_t * runtime);
 unsigned int xkrt_get_ndevices_max(xkrt_runtime_t * runtime);
 
+/* Stats - returns 0 on success, or 1 with zeroed counters if the runtime was built without stats */
+int xkrt_device_coherence_stats_get(xkrt_runtime_t * runtime, xkrt_device_global_id_t device, xkrt_device_coherence_stats_t * stats);
+
 /* TASKING */
 void xkrt_task_commit  (xkrt_runtime_t * runtime, xkrt_task_t * task);
 void xkrt_task_complete(xkrt_runtime_t * runtime, xkrt_task_t * task);
@@ -37,6 +37,7 @@
 #include <xkrt/xkrt.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 XKRT_NAMESPACE_USE;
 
@@ -270,6 +271,35 @@ xkrt_get_ndevices_max(
     return rt->get_ndevices_max();
 }
 
+int
+xkrt_device_coherence_stats_get(
+    xkrt_runtime_t * runtime,
+    xkrt_device_global_id_t device_global_id,
+    xkrt_device_coherence_stats_t * stats
+) {
+    assert(runtime);
+    assert(stats);
+    runtime_t * rt = (runtime_t *) runtime;
+    assert(device_global_id < rt->get_ndevices());
+
+    # if XKRT_SUPPORT_STATS
+    device_t * device = rt->device_get(device_global_id);
+    assert(device);
+    stats->hits      = device->stats.memory.coherence.hits.load();
+    stats->misses    = device->stats.memory.coherence.misses.load();
+    stats->joined    = device->stats.memory.coherence.joined.load();
+    stats->overwrites = device->stats.memory.coherence.overwrites.load();
+    stats->evictions = device->stats.memory.coherence.evictions.load();
+    stats->evicted   = device->stats.memory.coherence.evicted.load();
+    return 0;
+    # else
+    (void) rt;
+    (void) device_global_id;
+    memset(stats, 0, sizeof(xkrt_device_coherence_stats_t));
+    return 1;
+    # endif /* XKRT_SUPPORT_STATS */
+}
+
 // ---------------------------
 // TASKING
 // ---------------------------
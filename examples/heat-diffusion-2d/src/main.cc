@@ -542,13 +542,14 @@ update_tile(TYPE * src, TYPE * dst, int tile_x, int tile_y, int step, unsigned i
     static_assert(AC <= TASK_MAX_ACCESSES);
     access_t * accesses = TASK_ACCESSES(task, flags);
     {
-        const ssize_t x0 = MAX(x-1, 0);
-        const ssize_t y0 = MAX(y-1, 0);
-        const ssize_t x1 = MIN(x+TSX+1, NX);
-        const ssize_t y1 = MIN(y+TSY+1, NY);
-        const  size_t sx = x1 - x0;
-        const  size_t sy = y1 - y0;
-        new (accesses + 0) access_t(task, MATRIX_COLMAJOR, src, LD, x0, y0, sx, sy, sizeof(TYPE), ACCESS_MODE_R);
+        // the tile and its 1-cell border within the grid, the corners are not read
+        const matrix_halo_t halo = {
+            (size_t) (x > 0),
+            (size_t) (x + TSX < NX),
+            (size_t) (y > 0),
+            (size_t) (y + TSY < NY)
+        };
+        new (accesses + 0) access_t(task, MATRIX_COLMAJOR, halo, src, LD, x, y, TSX, TSY, sizeof(TYPE), ACCESS_MODE_R);
     }
     {
         const ssize_t x0 = MAX(x, 1);
@@ -70,9 +70,45 @@ typedef struct  conf_offloader_t
 
 }               conf_offloader_t;
 
+/* policy to select device memory to evict */
+typedef enum    memory_eviction_policy_t
+{
+    XKRT_MEMORY_EVICTION_POLICY_LRU             = 0,    /* least recently used allocations first */
+    XKRT_MEMORY_EVICTION_POLICY_CLEAN_FIRST     = 1,    /* allocations still valid elsewhere first, then least recently used */
+
+}               memory_eviction_policy_t;
+
+/* router to select the source of data transfers */
+typedef enum    router_type_t
+{
+    XKRT_ROUTER_TYPE_AFFINITY   = 0,    /* best perf rank reported by the drivers, random amongst equals */
+    XKRT_ROUTER_TYPE_CFS        = 1,    /* cheapest path over the links, accounting for pending transfers */
+    XKRT_ROUTER_TYPE_BANDWIDTH  = 2,    /* highest bandwidth measured at run time, splitting large transfers */
+
+}               router_type_t;
+
+/* memory coherency controller of segment accesses */
+typedef enum    segment_coherency_t
+{
+    XKRT_SEGMENT_COHERENCY_TREE     = 0,    /* validity tracked per interval in a tree */
+    XKRT_SEGMENT_COHERENCY_PAGED    = 1,    /* validity tracked per fixed-size page in hash tables */
+
+}               segment_coherency_t;
+
+/* policy to decide whether a moldable task splits */
+typedef enum    moldable_split_policy_t
+{
+    XKRT_MOLDABLE_SPLIT_POLICY_USER = 0,    /* split as long as the task split condition returns true */
+    XKRT_MOLDABLE_SPLIT_POLICY_AUTO = 1,    /* split in as many parts as there are idle resources, down to a minimum size */
+
+}               moldable_split_policy_t;
+
 typedef struct  conf_device_t
 {
-    float gpu_mem_percent;      /* % of gpu memory to allocate initially */
+    float gpu_mem_percent;      /* % of gpu memory that the pool may use */
+    size_t pool_grow_size;      /* size in bytes by which the pool grows on demand, or 0 to allocate it entirely initially */
+    memory_eviction_policy_t eviction_policy;   /* device memory eviction policy */
+    float defrag_threshold;     /* fragmentation of the free device memory (in [0..1]) from which chunks are relocated before evicting */
     device_global_id_t ngpus;   /* number of GPU for this node */
     bool use_p2p;               /* enable/disable p2p */
     conf_offloader_t offloader; /* offloader conf */
@@ -98,17 +134,31 @@ typedef struct  conf_s
     conf_drivers_t drivers;    /* driver conf */
     bool merge_transfers;           /* attempt to merge continuous memory to a single transfer */
     bool report_stats_on_deinit;    /* report stats on deinit */
+    router_type_t router;           /* router to select the source of data transfers */
+    size_t router_split_threshold;  /* transfers of at least that many bytes may be split across several sources (bandwidth router) */
+    segment_coherency_t segment_coherency;  /* memory coherency controller of segment accesses */
+    size_t segment_page_size;       /* size in bytes of a page (paged segment coherency) */
+    moldable_split_policy_t moldable_split; /* policy to decide whether a moldable task splits */
+    size_t moldable_split_min_size; /* the automatic policy does not split accesses bellow that many bytes */
 
     /* keep track of registered memory, and split transfers for each registered
      * segment to avoid cuda crashing while transfering memory that is
      * partially registered */
     bool protect_registered_memory_overflow;
 
+    /* lock (and prefault) host memory pages with 'mlock' before registering
+     * them to the drivers, in parallel for asynchronous registrations */
+    bool memory_register_mlock;
+
     /* prefetch memory: when completing a predecessor, if the successor place
      * of execution is known, and its a WaR dependency, then initiate data
      * transfer now */
     bool enable_prefetching;
 
+    /* maximum % of the device memory that may hold prefetched data not
+     * consumed yet, to avoid thrashing memory */
+    float prefetch_mem_percent;
+
     /* pause progress thread until a random command completed,
      * when there is nothing to do but progress pending commands.
      * If disabled, progression threads actively polls queues */
@@ -117,6 +167,10 @@ typedef struct  conf_s
     /* pause progression threads when there is no ready tasks, or no pending/ready commands */
     bool enable_busy_polling;
 
+    /* spread host threads over the NUMA nodes, and enqueue host tasks onto
+     * a thread of the node holding their data */
+    bool enable_numa_scheduling;
+
     /* to warmup threads/devices on init (touch memory pages, allocate device memory...) */
     bool warmup;
 
@@ -46,8 +46,12 @@
 /* maximum number of devices in total */
 # define XKRT_DEVICES_MAX (16)
 
-/* maximum number of memory per device */
-# define XKRT_DEVICE_MEMORIES_MAX (1)
+/* maximum number of memory per device (the host device has one per NUMA node) */
+# define XKRT_DEVICE_MEMORIES_MAX (8)
+
+/* number of entries of the cache of the NUMA node holding host pages, looked
+ * up on host tasks submission (must be a power of 2) */
+# define XKRT_HOST_NUMA_CACHE_SIZE (4096)
 
 /* maximum number of callback per command */
 # define XKRT_COMMAND_CALLBACKS_MAX (2)
@@ -55,6 +59,12 @@
 /* maximum number of performance ranks between devices. */
 # define XKRT_DEVICES_PERF_RANK_MAX (4)
 
+/* maximum number of sources a single transfer may be split across */
+# define XKRT_ROUTER_SPLIT_MAX (4)
+
+/* weight of the last measure in the moving average of a link bandwidth */
+# define XKRT_LINK_BANDWIDTH_EWMA_ALPHA (0.25)
+
 /* an ID representing the host device */
 # define HOST_DEVICE_GLOBAL_ID ((xkrt_device_global_id_t)0)
 
@@ -70,6 +80,14 @@
 /* maximum number of memory per thread */
 # define THREAD_MAX_MEMORY ((size_t)4*1024*1024*1024)
 
+/* size of the segments the tasks stack is split into - a segment is reused
+ * once all tasks it holds were reclaimed (must be a power of 2) */
+# define THREAD_TASKS_SEGMENT_SIZE ((size_t)4*1024*1024)
+
+/* number of completed children tasks of a dependency domain that triggers
+ * their reclamation on the next task commit (0 to disable) */
+# define XKRT_TASK_GC_THRESHOLD (1024)
+
 # define TASK_MAX_ACCESSES (1024)
 # define UNSPECIFIED_TASK_ACCESS ((xkrt_task_access_counter_type_t) TASK_MAX_ACCESSES)
 
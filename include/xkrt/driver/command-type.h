@@ -64,6 +64,13 @@ XKRT_NAMESPACE_BEGIN
 
     const char * command_type_to_str(command_type_t type);
 
+    /* return true if the command type is a copy */
+    static inline bool
+    command_is_copy(command_type_t type)
+    {
+        return COMMAND_TYPE_COPY_H2H_1D <= type && type <= COMMAND_TYPE_COPY_D2D_2D;
+    }
+
 XKRT_NAMESPACE_END
 
 #endif /* __QUEUE_COMMAND_H__ */
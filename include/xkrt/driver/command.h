@@ -114,6 +114,13 @@ XKRT_NAMESPACE_BEGIN
             command_callback_index_t n;
         } callbacks;
 
+        /* copy commands only: the link used and the launch date, to measure its bandwidth */
+        struct {
+            device_global_id_t src;
+            device_global_id_t dst;
+            uint64_t launched;
+        } link;
+
         inline void
         push_callback(const callback_t & callback)
         {
@@ -138,6 +138,20 @@ typedef struct  device_t
                 stats_int_t total;
                 stats_int_t currently;
             } allocated;
+
+            /* outcome of the accesses fetched onto that device */
+            struct {
+                stats_int_t hits;       /* already valid on the device */
+                stats_int_t misses;     /* launched at least one transfer */
+                stats_int_t joined;     /* awaited an in-flight transfer or forward instead */
+                stats_int_t overwrites; /* not valid on the device, but never read so nothing transferred */
+                stats_int_t evictions;  /* chunks evicted */
+                stats_int_t evicted;    /* bytes evicted */
+                stats_int_t relocations;    /* chunks relocated to defragment the memory */
+                stats_int_t relocated;      /* bytes relocated */
+                stats_int_t prefetches;     /* accesses prefetched before their task was ready */
+                stats_int_t prefetched;     /* bytes prefetched */
+            } coherence;
         } memory;
     } stats;
     # endif /* XKRT_SUPPORT_STATS */
@@ -150,6 +164,12 @@ typedef struct  device_t
     device_memory_info_t memories[XKRT_DEVICE_MEMORIES_MAX];
     int nmemories;
 
+    /* caches of chunks freed by each thread of the device team, per area */
+    area_chunk_cache_t chunk_caches[XKRT_MAX_THREADS_PER_DEVICE][XKRT_DEVICE_MEMORIES_MAX];
+
+    /* bytes prefetched for tasks that did not complete yet */
+    std::atomic<size_t> prefetched;
+
     /* allocate memory on a specific area */
     area_chunk_t * memory_allocate_on(const size_t size, int area_idx);
 
@@ -162,15 +182,47 @@ typedef struct  device_t
     /* deallocate the given chunk */
     void memory_deallocate(area_chunk_t * chunk);
 
-    /* free all memory of every area of that device, resetting their state to chunk0 */
+    /* free all memory of every area of that device, resetting their state to one free chunk per segment */
     void memory_reset(void);
 
-    /* free all memory of the given area of that device, resetting their state to chunk0 */
+    /* free all memory of the given area of that device, resetting their state to one free chunk per segment */
     void memory_reset_on(int area_idx);
 
-    /* set chunk0 of an area */
+    /* set the only segment of an area, that cannot grow anymore */
     void memory_set_chunk0(uintptr_t device_ptr, size_t size, int area_idx);
 
+    /* add a segment to an area, whose size was already accounted in the
+     * area reserved bytes - the area must be locked */
+    void memory_grow_on(uintptr_t device_ptr, size_t size, int area_idx);
+
+    /* detach an entirely free segment of the area, keeping at least one, and
+     * return true if there was one, to be released to the driver once the area
+     * is unlocked - the area must be locked */
+    bool memory_release_idle_on(int area_idx, uintptr_t * device_ptr, size_t * size);
+
+    /* give the chunks cached by the calling thread back to the areas */
+    void memory_cache_flush(void);
+
+    /* take a snapshot of the allocator state of an area */
+    void memory_stats_on(int area_idx, area_stats_t * stats);
+
+    /* call 'f(chunk)' on each chunk of the area, in address order within each
+     * segment (the first chunk of a segment has no 'prev') - the area is
+     * locked meanwhile, so 'f' must not allocate nor deallocate */
+    template <typename F>
+    inline void
+    memory_foreach_chunk_on(int area_idx, F && f)
+    {
+        area_t * area = &(this->memories[area_idx].area);
+        XKRT_MUTEX_LOCK(area->lock);
+        {
+            for (area_segment_t * segment = area->segments ; segment ; segment = segment->next)
+                for (area_chunk_t * chunk = segment->first ; chunk ; chunk = chunk->next)
+                    f(chunk);
+        }
+        XKRT_MUTEX_UNLOCK(area->lock);
+    }
+
     ///////////////////////
     // QUEUE MANAGEMENT //
     ///////////////////////
@@ -492,6 +544,8 @@ typedef struct  device_t
             cmd->copy_2D.src_device_view  = src_device_view;
             XKRT_STATS_INCR(queue->stats.transfered, host_view.m * host_view.n * host_view.sizeof_type);
         }
+        cmd->link.src = src_device_global_id;
+        cmd->link.dst = dst_device_global_id;
 
         if (callback)
             cmd->push_callback(*callback);
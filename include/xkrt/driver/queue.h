@@ -131,6 +131,16 @@ class queue_command_list_t
         }
 };
 
+/* copies measured on a (src, dst) link */
+typedef struct  queue_link_t
+{
+    std::atomic<uint64_t> bytes;        /* total bytes copied */
+    std::atomic<uint64_t> ns;           /* total duration of the copies, from launch to completion */
+    std::atomic<uint64_t> n;            /* number of copies */
+    std::atomic<double> bandwidth;      /* moving average of the bandwidth, in bytes per second */
+
+}               queue_link_t;
+
 # pragma message(TODO "make this a C++ class and use inheritance/pure virtual - currently hybrid of C struct C++ class :(")
 
 /* this is a 'io_queue' equivalent */
@@ -147,6 +157,12 @@ class queue_t : public Lockable
         /* queue for pending commands to progress */
         queue_command_list_t pending;
 
+        /* copies completed on that queue, per (src, dst) link */
+        queue_link_t links[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX];
+
+        /* time at which the last command of that queue completed */
+        uint64_t last_completion;
+
         # if XKRT_SUPPORT_STATS
         struct {
             struct {
@@ -184,6 +200,7 @@ class queue_t : public Lockable
             cmd->synchronous = synchronous;
             cmd->completed = false;
             cmd->callbacks.n = 0;
+            cmd->link.launched = 0;
 
             return cmd;
         }
@@ -215,6 +232,14 @@ class queue_t : public Lockable
         /* return true if the queue is empty, false otherwise */
         int is_empty(void) const;
 
+        /* record a copy of 'bytes' that took 'ns' nanoseconds on the link (src, dst) */
+        void link_record(
+            const device_global_id_t src,
+            const device_global_id_t dst,
+            const uint64_t bytes,
+            const uint64_t ns
+        );
+
 
 };  /* queue_t */
 
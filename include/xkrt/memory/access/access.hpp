@@ -41,8 +41,10 @@
 # include <xkrt/memory/access/common/hyperrect.hpp>
 # include <xkrt/memory/access/concurrency.h>
 # include <xkrt/memory/access/mode.h>
+# include <xkrt/memory/access/reduction.hpp>
 # include <xkrt/memory/access/scope.h>
 # include <xkrt/memory/access/type.h>
+# include <xkrt/memory/area.h>
 # include <xkrt/memory/view.hpp>
 
 # include <vector>
@@ -64,6 +66,24 @@
 #  define XKRT_ACCESS_FORCE_ALIGNMENT 0
 # endif
 
+/**
+ *  Triangular BLAS matrices (lower/upper) are represented by a staircase of at
+ *  most that many rects, so dependencies and transfers only cover the
+ *  triangle and the diagonal steps.  On a (n x n) tile, the staircase covers
+ *  (1 + 1/STEPS) / 2 of the tile, and exactly the triangle if n <= STEPS
+ */
+# ifndef XKRT_ACCESS_TRIANGLE_STEPS
+#  define XKRT_ACCESS_TRIANGLE_STEPS 8
+# endif
+static_assert(XKRT_ACCESS_TRIANGLE_STEPS >= 2);
+
+/* Halo matrix accesses are represented by the tile and its 4 borders */
+# define XKRT_ACCESS_HALO_RECTS (5)
+
+/* Maximum number of rects of BLAS matrix accesses - only general ones are
+ * stored in the access, others are computed on demand (see 'access_t::rects') */
+# define XKRT_ACCESS_MATRIX_RECTS MAX(XKRT_ACCESS_TRIANGLE_STEPS, XKRT_ACCESS_HALO_RECTS)
+
 # include <xkrt/namespace.h>
 XKRT_NAMESPACE_BEGIN
 
@@ -203,7 +223,7 @@ matrix_from_rects(
 /* rects must have at least a capacity of 2x Rect */
 static inline void
 matrix_to_rects(
-    matrix_tile_t & mat,
+    const matrix_tile_t & mat,
     Rect (& rects) [2]
 ) {
     const size_t  A = mat.begin_addr();
@@ -286,6 +306,132 @@ matrix_to_rects(
     }
 }
 
+/* rects must have at least a capacity of XKRT_ACCESS_MATRIX_RECTS x Rect */
+static inline void
+matrix_to_triangle_rects(
+    const matrix_tile_t & mat,
+    const matrix_uplo_t uplo,
+    Rect (& rects) [XKRT_ACCESS_MATRIX_RECTS]
+) {
+    assert(uplo == MATRIX_UPLO_LOWER || uplo == MATRIX_UPLO_UPPER);
+
+    const size_t  A = mat.begin_addr();
+    const size_t ld = mat.ld;
+    const size_t  m = mat.m;
+    const size_t  n = mat.n;
+    const size_t  s = mat.sizeof_type;
+
+    for (int k = 0 ; k < XKRT_ACCESS_MATRIX_RECTS ; ++k)
+        new (rects + k) Rect();
+
+    // the tile wraps around 'ld', fallback to the whole tile
+    if ((A % (ld * s)) + m * s > ld * s)
+    {
+        matrix_to_rects(mat, (Rect (&) [2]) rects);
+        return ;
+    }
+
+    /**
+     *  Split the columns in K steps, and for each step, only keep the rows
+     *  that intersects with the triangle.  For instance, the lower part with K = 3
+     *
+     *        ^               y0      y1      y2      y3
+     *        |         |  .   .   .   .   .   .   .   .
+     *        |      x0 |  .   0   .   .   .   .   .   .
+     *   ld.s |         |  .   0   0   .   .   .   .   .
+     *        |         |  .   0   0   1   .   .   .   .
+     *        |         |  .   0   0   1   1   .   .   .
+     *        |         |  .   0   0   1   1   2   .   .
+     *        |      x1 |  .   0   0   1   1   2   2   .
+     *        v         v  .   .   .   .   .   .   .   .
+     */
+    const uintptr_t x0 = A % (ld * s);
+    const uintptr_t y0 = A / (ld * s);
+    const size_t K = MIN(n, (size_t) XKRT_ACCESS_TRIANGLE_STEPS);
+
+    for (size_t k = 0 ; k < K ; ++k)
+    {
+        const size_t c0 = (k + 0) * n / K;
+        const size_t c1 = (k + 1) * n / K;
+        const size_t r0 = (uplo == MATRIX_UPLO_LOWER) ? c0 : 0;
+        const size_t r1 = (uplo == MATRIX_UPLO_LOWER) ? m  : MIN(c1, m);
+        if (r0 >= r1)
+            continue ;
+
+        Interval list[2];
+        list[ACCESS_BLAS_ROW_DIM] = Interval(x0 + r0 * s, x0 + r1 * s);
+        list[ACCESS_BLAS_COL_DIM] = Interval(y0 + c0,     y0 + c1);
+        rects[k].set_list(list);
+        assert(!rects[k].is_empty());
+    }
+}
+
+static inline bool
+matrix_halo_is_empty(const matrix_halo_t & halo)
+{
+    return halo.m0 == 0 && halo.m1 == 0 && halo.n0 == 0 && halo.n1 == 0;
+}
+
+/**
+ *  'mat' is the tile with its halo: set the rects of the tile and of its 4
+ *  borders, leaving out the corners.
+ *  rects must have at least a capacity of XKRT_ACCESS_MATRIX_RECTS x Rect
+ */
+static inline void
+matrix_to_halo_rects(
+    const matrix_tile_t & mat,
+    const matrix_halo_t & halo,
+    Rect (& rects) [XKRT_ACCESS_MATRIX_RECTS]
+) {
+    const size_t  A = mat.begin_addr();
+    const size_t ld = mat.ld;
+    const size_t  m = mat.m;
+    const size_t  n = mat.n;
+    const size_t  s = mat.sizeof_type;
+    assert(halo.m0 + halo.m1 < m);
+    assert(halo.n0 + halo.n1 < n);
+
+    for (int k = 0 ; k < XKRT_ACCESS_MATRIX_RECTS ; ++k)
+        new (rects + k) Rect();
+
+    // the tile wraps around 'ld', fallback to the whole tile and halo
+    if ((A % (ld * s)) + m * s > ld * s)
+    {
+        matrix_to_rects(mat, (Rect (&) [2]) rects);
+        return ;
+    }
+
+    //   rows: [x0, x1[ is the tile, [x0 - m0, x1 + m1[ the tile and its halo
+    //   cols: [y0, y1[ is the tile, [y0 - n0, y1 + n1[ the tile and its halo
+    const uintptr_t x0 = (A % (ld * s)) + halo.m0 * s;
+    const uintptr_t x1 = (A % (ld * s)) + (m - halo.m1) * s;
+    const uintptr_t y0 = (A / (ld * s)) + halo.n0;
+    const uintptr_t y1 = (A / (ld * s)) + (n - halo.n1);
+
+    const struct {
+        Interval rows;
+        Interval cols;
+    } parts[XKRT_ACCESS_HALO_RECTS] = {
+        { Interval(x0,                x1),                Interval(y0,           y1)           },
+        { Interval(x0 - halo.m0 * s,  x0),                Interval(y0,           y1)           },
+        { Interval(x1,                x1 + halo.m1 * s),  Interval(y0,           y1)           },
+        { Interval(x0,                x1),                Interval(y0 - halo.n0, y0)           },
+        { Interval(x0,                x1),                Interval(y1,           y1 + halo.n1) },
+    };
+
+    for (int k = 0 ; k < XKRT_ACCESS_HALO_RECTS ; ++k)
+    {
+        if (parts[k].rows.is_empty() || parts[k].cols.is_empty())
+            continue ;
+
+        Interval list[2];
+        list[ACCESS_BLAS_ROW_DIM] = parts[k].rows;
+        list[ACCESS_BLAS_COL_DIM] = parts[k].cols;
+        rects[k].set_list(list);
+        assert(!rects[k].is_empty());
+    }
+}
+
 /* access state */
 typedef enum    access_state_t : uint8_t
 {
@@ -297,10 +443,10 @@ typedef enum    access_state_t : uint8_t
 /* split mode */
 typedef enum    access_split_mode_t
 {
-    ACCESS_SPLIT_MODE_NO_SPLIT,
-    ACCESS_SPLIT_MODE_HALVES,
-    ACCESS_SPLIT_MODE_HALVES_HORIZONTAL,
-    ACCESS_SPLIT_MODE_HALVES_VERTICAL,
+    ACCESS_SPLIT_MODE_NO_SPLIT,             /* the access is duplicated as it is (read-only accesses) */
+    ACCESS_SPLIT_MODE_HALVES,               /* two halves, along the largest dimension of matrices */
+    ACCESS_SPLIT_MODE_HALVES_HORIZONTAL,    /* two halves of the rows of matrices */
+    ACCESS_SPLIT_MODE_HALVES_VERTICAL,      /* two halves of the columns of matrices */
     ACCESS_SPLIT_MODE_QUADRANT,
     ACCESS_SPLIT_MODE_CUSTOM
 }               access_split_mode_t;
@@ -332,6 +478,15 @@ class access_t
         /* access type */
         access_type_t type;
 
+        /* how the access is split if its task is moldable */
+        access_split_mode_t split_mode;
+
+        /* if the mode is ACCESS_MODE_REDUCE: the operator combining the
+         * private copies, to be set by the user, and the reduction it
+         * contributes to, set when resolving its dependencies */
+        access_reduce_op_t reduce_op;
+        access_reduction_t * reduction;
+
         /////////////////////////////////////////////////
         // region -         depends on the access type //
         /////////////////////////////////////////////////
@@ -365,8 +520,19 @@ class access_t
             ///////////////////
 
             struct {
-                /** BLAS matrices have 2 rects in their frame of reference (ld, s) */
+
+                /* the part of the matrix accessed */
+                matrix_uplo_t uplo;
+
+                /* the border of the tile, if the access has a halo */
+                matrix_halo_t halo;
+
+                /** BLAS matrices have 2 rects in their frame of reference (ld, s).
+                 * The staircase of rects of triangular accesses, and the tile
+                 * and its borders of accesses with a halo, are not stored but
+                 * computed from the host view, so they do not grow all accesses */
                 Rect rects[2];
+
             } matrix;
 
             region_t() {}
@@ -374,32 +540,40 @@ class access_t
 
         } region;
 
-        std::span<Rect>
-        rects()
+        /**
+         *  The rects of the access: the ones stored in the access for
+         *  segments and general matrices, else the ones of triangular
+         *  accesses and accesses with a halo, computed into 'buffer'
+         */
+        std::span<const Rect>
+        rects(Rect (& buffer) [XKRT_ACCESS_MATRIX_RECTS]) const
         {
             switch (this->type)
             {
                 case ACCESS_TYPE_SEGMENT:
                     return { this->region.interval.rects, 3 };
                 case ACCESS_TYPE_BLAS_MATRIX:
+                    if (this->region.matrix.uplo != MATRIX_UPLO_GENERAL)
+                    {
+                        matrix_to_triangle_rects(this->host_view, this->region.matrix.uplo, buffer);
+                        return { buffer, XKRT_ACCESS_MATRIX_RECTS };
+                    }
+                    if (!matrix_halo_is_empty(this->region.matrix.halo))
+                    {
+                        matrix_to_halo_rects(this->host_view, this->region.matrix.halo, buffer);
+                        return { buffer, XKRT_ACCESS_MATRIX_RECTS };
+                    }
                     return { this->region.matrix.rects, 2 };
                 default:
                     return {};
             }
         }
 
-        std::span<const Rect>
-        rects() const
+        std::span<Rect>
+        rects(Rect (& buffer) [XKRT_ACCESS_MATRIX_RECTS])
         {
-            switch (this->type)
-            {
-                case ACCESS_TYPE_SEGMENT:
-                    return { this->region.interval.rects, 3 };
-                case ACCESS_TYPE_BLAS_MATRIX:
-                    return { this->region.matrix.rects, 2 };
-                default:
-                    return {};
-            }
+            std::span<const Rect> rects = static_cast<const access_t *>(this)->rects(buffer);
+            return { const_cast<Rect *>(rects.data()), rects.size() };
         }
 
         //////////
@@ -424,6 +598,13 @@ class access_t
         /* device view of the access - set after fetching the data */
         memory_replica_view_t device_view;
 
+        /* device memory chunk of the device view, pinned until the task completes */
+        area_chunk_t * device_chunk;
+
+        /* device on which the access got prefetched (or UNSPECIFIED_DEVICE_GLOBAL_ID),
+         * its size is accounted in the device prefetched bytes until the task completes */
+        device_global_id_t prefetch_device_global_id;
+
     public:
         /////////////
         // methods //
@@ -461,11 +642,19 @@ class access_t
             concurrency(concurrency),
             scope(scope),
             type(ACCESS_TYPE_HANDLE),
+            split_mode(ACCESS_SPLIT_MODE_HALVES),
+            reduce_op(NULL),
+            reduction(NULL),
             successors(),
             task(task),
             host_view(MATRIX_COLMAJOR, addr, 1, 0, 0, 1, 1, 1),
-            device_view()
+            device_view(),
+            device_chunk(nullptr),
+            prefetch_device_global_id(UNSPECIFIED_DEVICE_GLOBAL_ID)
         {
+            /* reductions are only supported on segments and matrices */
+            assert(!(mode & ACCESS_MODE_P));
+
             this->region.point.handle = addr;
 
             /* clear preallocated empty successors */
@@ -489,11 +678,16 @@ class access_t
             concurrency(concurrency),
             scope(scope),
             type(ACCESS_TYPE_SEGMENT),
+            split_mode(ACCESS_SPLIT_MODE_HALVES),
+            reduce_op(NULL),
+            reduction(NULL),
             successors(),
             task(task),
             //         storage        addr      ld    offset_m  offset_n          m         n  s
             host_view(MATRIX_COLMAJOR, a,    SIZE_MAX,    0,     0,     (size_t) (b - a), 1, 1),
-            device_view()
+            device_view(),
+            device_chunk(nullptr),
+            prefetch_device_global_id(UNSPECIFIED_DEVICE_GLOBAL_ID)
         {
             successors.reserve(8);
 
@@ -539,6 +733,7 @@ class access_t
         access_t(
             task_t * task,
             const matrix_storage_t & storage,
+            const matrix_uplo_t & uplo,
             const void * addr,
             const size_t ld,
             const size_t offset_m,
@@ -555,10 +750,15 @@ class access_t
             concurrency(concurrency),
             scope(scope),
             type(ACCESS_TYPE_BLAS_MATRIX),
+            split_mode(ACCESS_SPLIT_MODE_HALVES),
+            reduce_op(NULL),
+            reduction(NULL),
             successors(),
             task(task),
             host_view(storage, addr, ld, offset_m, offset_n, m, n, s),
-            device_view()
+            device_view(),
+            device_chunk(nullptr),
+            prefetch_device_global_id(UNSPECIFIED_DEVICE_GLOBAL_ID)
         {
             successors.reserve(8);
 
@@ -569,8 +769,67 @@ class access_t
             // not sure about what to do if other storageing
             assert(host_view.storage == MATRIX_COLMAJOR);
 
-            // creates the two rects of that memory view
-            matrix_to_rects(host_view, this->region.matrix.rects);
+            // creates the rects of that memory view
+            this->region.matrix.uplo = uplo;
+            this->region.matrix.halo = {0, 0, 0, 0};
+            if (uplo == MATRIX_UPLO_GENERAL)
+                matrix_to_rects(host_view, this->region.matrix.rects);
+            else
+            {
+                new (this->region.matrix.rects + 0) Rect();
+                new (this->region.matrix.rects + 1) Rect();
+            }
+        }
+
+        access_t(
+            task_t * task,
+            const matrix_storage_t & storage,
+            const void * addr,
+            const size_t ld,
+            const size_t offset_m,
+            const size_t offset_n,
+            const size_t m,
+            const size_t n,
+            const size_t s, // sizeof_type,
+            access_mode_t mode,
+            access_concurrency_t concurrency = ACCESS_CONCURRENCY_SEQUENTIAL,
+            access_scope_t scope = ACCESS_SCOPE_NONUNIFIED
+        ) : access_t(task, storage, MATRIX_UPLO_GENERAL, addr, ld, offset_m, offset_n, m, n, s, mode, concurrency, scope) {}
+
+        /**
+         *  The (m x n) tile at (offset_m, offset_n) and its halo: the halo is
+         *  read-only, so is the tile.  The memory views of the access are
+         *  the tile with its halo, at (offset_m - halo.m0, offset_n - halo.n0)
+         */
+        access_t(
+            task_t * task,
+            const matrix_storage_t & storage,
+            const matrix_halo_t & halo,
+            const void * addr,
+            const size_t ld,
+            const size_t offset_m,
+            const size_t offset_n,
+            const size_t m,
+            const size_t n,
+            const size_t s, // sizeof_type,
+            access_mode_t mode,
+            access_concurrency_t concurrency = ACCESS_CONCURRENCY_SEQUENTIAL,
+            access_scope_t scope = ACCESS_SCOPE_NONUNIFIED
+        ) :
+            access_t(
+                task, storage, MATRIX_UPLO_GENERAL, addr, ld,
+                offset_m - halo.m0, offset_n - halo.n0,
+                m + halo.m0 + halo.m1, n + halo.n0 + halo.n1,
+                s, mode, concurrency, scope
+            )
+        {
+            /* the halo is read-only */
+            assert(mode == ACCESS_MODE_R);
+            assert(offset_m >= halo.m0);
+            assert(offset_n >= halo.n0);
+
+            /* its rects are computed on demand */
+            this->region.matrix.halo = halo;
         }
 
          access_t(
@@ -601,10 +860,15 @@ class access_t
             concurrency(concurrency),
             scope(scope),
             type(ACCESS_TYPE_BLAS_MATRIX),
+            split_mode(ACCESS_SPLIT_MODE_HALVES),
+            reduce_op(NULL),
+            reduction(NULL),
             successors(),
             task(task),
             host_view(storage, 0, ld, 0, 0, 0, 0, s),
-            device_view()
+            device_view(),
+            device_chunk(nullptr),
+            prefetch_device_global_id(UNSPECIFIED_DEVICE_GLOBAL_ID)
         {
             successors.reserve(8);
 
@@ -613,6 +877,8 @@ class access_t
             assert(!h.is_empty());
 
             matrix_from_rect(this->host_view, h, ld, s);
+            this->region.matrix.uplo = MATRIX_UPLO_GENERAL;
+            this->region.matrix.halo = {0, 0, 0, 0};
             new (this->region.matrix.rects + 0) Rect(h);
             new (this->region.matrix.rects + 1) Rect();
         }
@@ -627,8 +893,10 @@ class access_t
             access_t(
                 task,
                 other->host_view.storage,
+                other->region.matrix.uplo,
                 (void *) other->host_view.addr,
                 other->host_view.ld,
+                0, 0,
                 other->host_view.m,
                 other->host_view.n,
                 other->host_view.sizeof_type,
@@ -636,7 +904,10 @@ class access_t
                 concurrency,
                 scope
             )
-        {}
+        {
+            // same tile and halo
+            this->region.matrix.halo = other->region.matrix.halo;
+        }
 
         //////////////////////////////////////////////////////////////////////
         // NULL ACCESS                                                      //
@@ -653,10 +924,15 @@ class access_t
             concurrency(concurrency),
             scope(scope),
             type(ACCESS_TYPE_NULL),
+            split_mode(ACCESS_SPLIT_MODE_HALVES),
+            reduce_op(NULL),
+            reduction(NULL),
             successors(),
             task(task),
             host_view(MATRIX_COLMAJOR, 0, 0, 0, 0, 0, 0, 0),
-            device_view()
+            device_view(),
+            device_chunk(nullptr),
+            prefetch_device_global_id(UNSPECIFIED_DEVICE_GLOBAL_ID)
         {
             successors.reserve(8);
 
@@ -37,6 +37,7 @@
 #ifndef __DEPENDENCY_TREE_HPP__
 # define __DEPENDENCY_TREE_HPP__
 
+# include <xkrt/memory/access/common/dependency-node.hpp>
 # include <xkrt/memory/access/common/khp-tree.hpp>
 # include <xkrt/memory/access/dependency-domain.hpp>
 # include <xkrt/task/task.hpp>
@@ -62,6 +63,9 @@ class KBLASDependencyTreeSearch
         // USED IF TYPE == SEARCH_TYPE_RESOLVE or type == SEARCH_TYPE_CONFLICTING
         access_t * access;
 
+        // USED IF TYPE == SEARCH_TYPE_RESOLVE - the rects of the access being inserted
+        std::span<const Rect> rects;
+
         // USED IF TYPE == SEARCH_TYPE_CONFLICTING
         std::vector<void *> * conflicts;
 
@@ -72,10 +76,11 @@ class KBLASDependencyTreeSearch
     public:
 
         void
-        prepare_resolve(access_t * access)
+        prepare_resolve(access_t * access, std::span<const Rect> rects)
         {
             this->type = SEARCH_TYPE_RESOLVE;
             this->access = access;
+            this->rects = rects;
         }
 
         void
@@ -106,7 +111,15 @@ class KBLASDependencyTreeNode : public KHPTree<K, KBLASDependencyTreeSearch<K>>:
         /* last task that performed a write access */
         access_t * last_write;
 
-        /* number of writes in all subtrees */
+        /* last accesses that reduce, concurrently between each others */
+        std::vector<access_t *> last_reduces;
+
+        /* true while 'last_reduces' may still grow: the reduces are then
+         * preceded by 'last_reads', or 'last_write' if there is none.
+         * Else, the reduces are complete and precede 'last_reads' */
+        bool reducing;
+
+        /* number of writes (or reduces) in all subtrees */
         int nwrites;
 
     public:
@@ -119,6 +132,8 @@ class KBLASDependencyTreeNode : public KHPTree<K, KBLASDependencyTreeSearch<K>>:
             Base(h, k, color),
             last_reads(),
             last_write(),
+            last_reduces(),
+            reducing(false),
             nwrites(0)
         {
         }
@@ -133,6 +148,8 @@ class KBLASDependencyTreeNode : public KHPTree<K, KBLASDependencyTreeSearch<K>>:
             Base(h, k, color),
             last_reads(),
             last_write(),
+            last_reduces(),
+            reducing(false),
             nwrites(0)
         {
             this->last_write = inherit->last_write;
@@ -141,6 +158,12 @@ class KBLASDependencyTreeNode : public KHPTree<K, KBLASDependencyTreeSearch<K>>:
                 inherit->last_reads.begin(),
                 inherit->last_reads.end()
             );
+            this->last_reduces.insert(
+                this->last_reduces.end(),
+                inherit->last_reduces.begin(),
+                inherit->last_reduces.end()
+            );
+            this->reducing = inherit->reducing;
         }
 
         ////////////
@@ -149,7 +172,7 @@ class KBLASDependencyTreeNode : public KHPTree<K, KBLASDependencyTreeSearch<K>>:
         inline void
         update_includes_nwrites(void)
         {
-            this->nwrites = this->last_write ? 1 : 0;
+            this->nwrites = (this->last_write || this->last_reduces.size()) ? 1 : 0;
             FOREACH_CHILD_BEGIN(this, child, k, dir)
             {
                 this->nwrites += child->nwrites;
@@ -217,7 +240,8 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
 
             Search search;
             search.prepare_conflicting(conflicts, access);
-            for (const Rect & rect : access->rects())
+            Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+            for (const Rect & rect : access->rects(buffer))
                 Base::intersect(search, rect);
         }
 
@@ -239,17 +263,11 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
             // must check if it intersects, because this node insertion may
             // have been triggered by a splitting a node that do not intersects
             // with the originally inserted rectangle
-            for (const Rect & rect : search.access->rects())
+            for (const Rect & rect : search.rects)
             {
                 if (rect.intersects(node->hyperrect))
                 {
-                    if (search.access->mode & ACCESS_MODE_W)
-                    {
-                        node->last_reads.clear();
-                        node->last_write = search.access;
-                    }
-                    else if (search.access->mode == ACCESS_MODE_R)
-                        node->last_reads.push_back(search.access);
+                    dependency_node_put(node, search.access);
                     break ;
                 }
             }
@@ -324,20 +342,13 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
             {
                 case (Search::Type::SEARCH_TYPE_RESOLVE):
                 {
-                    if ((search.access->mode & ACCESS_MODE_W) && node->last_reads.size())
-                    {
-                        for (access_t * pred : node->last_reads)
-                            __access_precedes(pred, search.access);
-                    }
-                    else if (node->last_write)
-                        __access_precedes(node->last_write, search.access);
-
+                    dependency_node_link(node, search.access);
                     break ;
                 }
 
                 case (Search::Type::SEARCH_TYPE_CONFLICTING):
                 {
-                    if (node->last_write)
+                    if (node->last_write || node->last_reduces.size())
                     {
                         assert(search.conflicts);
                         search.conflicts->push_back(node);
@@ -354,6 +365,35 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
             }
         }
 
+        ////////
+        // GC //
+        ////////
+
+        /* forget completed accesses of the subtree - completed writers are
+         * replaced rather than removed, to keep track of written regions
+         * (see 'memory_coherent_async') */
+        inline void
+        gc(Node * node)
+        {
+            FOREACH_CHILD_BEGIN(node, child, k, dir)
+            {
+                this->gc(child);
+            }
+            FOREACH_CHILD_END(node, child, k, dir);
+
+            std::erase_if(node->last_reads, __access_completed);
+            std::erase_if(node->last_reduces, __access_completed);
+            if (node->last_write && __access_completed(node->last_write))
+                node->last_write = task_reclaimed_access();
+        }
+
+        void
+        gc(void)
+        {
+            if (this->root)
+                this->gc(reinterpret_cast<Node *>(this->root));
+        }
+
         inline void
         prepare_interval_access_rects(access_t * access, Rect (& rects) [3])
         {
@@ -369,7 +409,7 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
             assert(access->type == ACCESS_TYPE_SEGMENT || access->type == ACCESS_TYPE_BLAS_MATRIX);
 
             Search search;
-            search.prepare_resolve(access);
+            search.prepare_resolve(access, rects);
             for (Rect & rect : rects)
                 Base::intersect(search, rect);
         }
@@ -378,7 +418,8 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
         link(access_t * access)
         {
             assert(access->type == ACCESS_TYPE_BLAS_MATRIX);
-            std::span<Rect> rects = access->rects();
+            Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+            std::span<Rect> rects = access->rects(buffer);
             this->link(access, rects);
         }
 
@@ -400,7 +441,7 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
             assert(access->type == ACCESS_TYPE_BLAS_MATRIX || access->type == ACCESS_TYPE_SEGMENT);
 
             Search search;
-            search.prepare_resolve(access);
+            search.prepare_resolve(access, rects);
             for (Rect & rect : rects)
                 Base::insert(search, rect);
         }
@@ -409,7 +450,8 @@ class KBLASDependencyTree : public KHPTree<K, KBLASDependencyTreeSearch<K>>, pub
         put(access_t * access)
         {
             assert(access->type == ACCESS_TYPE_BLAS_MATRIX);
-            std::span<Rect> rects_span = access->rects();
+            Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+            std::span<Rect> rects_span = access->rects(buffer);
             this->put(access, rects_span);
         }
 
@@ -0,0 +1,68 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+#ifndef __MATRIX_HALO_H__
+# define __MATRIX_HALO_H__
+
+# include <stddef.h>
+
+/**
+ *  Border read around a tile, as by stencils: 'm0' rows before and 'm1' rows
+ *  after the tile, 'n0' columns before and 'n1' columns after it.
+ *
+ *             n0     n     n1
+ *           +----+--------+----+
+ *        m0 |    |  m0xn  |    |
+ *           +----+--------+----+
+ *         m |m.n0|  tile  |m.n1|
+ *           +----+--------+----+
+ *        m1 |    |  m1xn  |    |
+ *           +----+--------+----+
+ *
+ *  Corners are not part of the halo.
+ */
+typedef struct  xkrt_matrix_halo_t
+{
+    size_t m0;
+    size_t m1;
+    size_t n0;
+    size_t n1;
+
+}               xkrt_matrix_halo_t;
+
+#endif /* __MATRIX_HALO_H__ */
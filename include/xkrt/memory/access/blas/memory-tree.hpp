@@ -46,12 +46,11 @@
 //  callbacks that can be parametrized, raised with global device ids
 
 # include <xkrt/logger/logger.h>
+# include <xkrt/logger/metric.h>
 # include <xkrt/logger/todo.h>
 # include <xkrt/memory/access/coherency-controller.hpp>
 # include <xkrt/sync/bits.h>
-# include <xkrt/sync/lockable.hpp>
-
-# pragma message(TODO "Replace the lock with a rwlock + atomic operations on block states. The global lock on the entire structure may be limiting scalability on multiple gpus")
+# include <xkrt/sync/rwlockable.hpp>
 
 # include <xkrt/runtime.h>              // this should gtfo
 # include <xkrt/memory/area.h>          // this should gtfo
@@ -60,9 +59,12 @@
 # include <xkrt/memory/access/mode.h>
 
 # include <algorithm>  // std::sort
+# include <atomic>
 # include <cstdint>
 # include <functional>
 # include <numeric> // std::iota
+# include <unordered_map>
+# include <unordered_set>
 
 XKRT_NAMESPACE_BEGIN
 
@@ -84,8 +86,6 @@ XKRT_NAMESPACE_BEGIN
  */
 # define USE_D2D_FORWARDING 1
 
-# pragma message(TODO "Memory allocation is currently performed within a critical section... If memory eviction must be performed, this creates double-locking + a lot of time spent in the critical section. Reason is : we need a partition (in the memory tree) of the access to write the allocation information on each block of the partition")
-
 # pragma message(TODO "'fetch' implementation should be optimize by reducing critical sections to the minimum number of commands. We could also consider making the structure lock-free but im concerned of actual performances (will lead to a lot of false-sharing...)")
 
 # define MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX   (8)
@@ -97,6 +97,40 @@ static_assert(MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX <= (1 << (sizeof(memory_allo
 typedef uint8_t memory_allocation_view_id_bitfield_t;
 static_assert(MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX <= sizeof(memory_allocation_view_id_bitfield_t) * 8);
 
+/* a part of a copy split across several sources */
+typedef struct  memory_fetch_split_t
+{
+    /* the source device of that part */
+    device_global_id_t src_device_global_id;
+
+    /* the source view of the whole copy on that device */
+    memory_replica_view_t src_view;
+
+    /* the source chunk, pinned until that part completes */
+    area_chunk_t * src_chunk;
+
+    /* offset and length of that part, in columns or rows depending on the split dimension */
+    size_t offset;
+    size_t length;
+
+}               memory_fetch_split_t;
+
+/* a copy split across several sources, see Router::get_sources */
+typedef struct  memory_fetch_splits_t
+{
+    /* number of parts, the first one being the copy own source - 0 if not split */
+    uint8_t n;
+
+    /* the dimension split (ACCESS_BLAS_ROW_DIM or ACCESS_BLAS_COL_DIM) */
+    int dim;
+
+    /* the parts */
+    memory_fetch_split_t parts[XKRT_ROUTER_SPLIT_MAX];
+
+    memory_fetch_splits_t() : n(0), dim(ACCESS_BLAS_COL_DIM) {}
+
+}               memory_fetch_splits_t;
+
 /* a forward request */
 template <int K>
 class KMemoryForward {
@@ -121,6 +155,9 @@ class KMemoryForward {
         /* the dst view */
         memory_replica_view_t device_view;
 
+        /* number of forward requests merged into that one */
+        task_wait_counter_type_t n;
+
     public:
 
         KMemoryForward(
@@ -134,7 +171,8 @@ class KMemoryForward {
             chunk(chunk),
             dst_hyperrect(dst_hyperrect),
             device_global_id(device_global_id),
-            device_view(device_view)
+            device_view(device_view),
+            n(1)
         {}
 
         ~KMemoryForward() {}
@@ -226,11 +264,11 @@ class KMemoryReplica
         MemoryReplicaAllocationView * allocations[MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX];
         volatile memory_allocation_view_id_t nallocations;
 
-        /* coherent allocations */
-        volatile memory_allocation_view_id_bitfield_t coherency;
+        /* coherent allocations (updated within the exclusive lock, read within a shared lock) */
+        std::atomic<memory_allocation_view_id_bitfield_t> coherency;
 
-        /* fetching allocations */
-        volatile memory_allocation_view_id_bitfield_t fetching;
+        /* fetching allocations (updated within the exclusive lock) */
+        std::atomic<memory_allocation_view_id_bitfield_t> fetching;
 
         static_assert(sizeof(memory_allocation_view_id_bitfield_t) * 8 >= MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX);
 
@@ -243,6 +281,28 @@ class KMemoryReplica
         }
         ~KMemoryReplica() {}
 
+        /* remove the i-th allocation view, shifting next views and their
+         * coherency/fetching bits, and return it */
+        inline MemoryReplicaAllocationView *
+        remove_allocation(memory_allocation_view_id_t i)
+        {
+            assert(i < this->nallocations);
+            MemoryReplicaAllocationView * allocation = this->allocations[i];
+
+            for (memory_allocation_view_id_t j = i ; j + 1 < this->nallocations ; ++j)
+                this->allocations[j] = this->allocations[j + 1];
+            this->nallocations = (memory_allocation_view_id_t) (this->nallocations - 1);
+            this->allocations[this->nallocations] = nullptr;
+
+            const memory_allocation_view_id_bitfield_t low = (memory_allocation_view_id_bitfield_t) ((1 << i) - 1);
+            const memory_allocation_view_id_bitfield_t c = this->coherency.load();
+            const memory_allocation_view_id_bitfield_t f = this->fetching.load();
+            this->coherency = (memory_allocation_view_id_bitfield_t) ((c & low) | ((c >> (i + 1)) << i));
+            this->fetching  = (memory_allocation_view_id_bitfield_t) ((f & low) | ((f >> (i + 1)) << i));
+
+            return allocation;
+        }
+
 }; /* MemoryReplica */
 
 /* a memory block, one per tree node */
@@ -259,10 +319,13 @@ class KMemoryBlock {
         MemoryReplica replicas[XKRT_DEVICES_MAX];
 
         /* coherent devices (i.e. devices with at least one coherent allocation) */
-        volatile device_global_id_bitfield_t coherency;
+        std::atomic<device_global_id_bitfield_t> coherency;
 
         /* fetching devices (i.e. devices with at least one fetching allocation) */
-        volatile device_global_id_bitfield_t fetching;
+        std::atomic<device_global_id_bitfield_t> fetching;
+
+        /* value of the tree epoch on the last write of that block */
+        uint64_t version;
 
         # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
         /* true/false whether the block is registered */
@@ -275,7 +338,8 @@ class KMemoryBlock {
         KMemoryBlock() :
             replicas(),
             coherency(0),
-            fetching(0)
+            fetching(0),
+            version(0)
             # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
             , registered(false)
             # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
@@ -322,16 +386,17 @@ class KMemoryBlock {
                 }
 
                 // dupplicate fetching / coherency infos
-                replica->fetching  = inheriting_replica->fetching;
-                replica->coherency = inheriting_replica->coherency;
+                replica->fetching  = inheriting_replica->fetching.load();
+                replica->coherency = inheriting_replica->coherency.load();
             }
 
             //////////////////////////////
             //  VALID BITS ARE STILL OK //
             //////////////////////////////
 
-            this->coherency = inheriting_block.coherency;
-            this->fetching = inheriting_block.fetching;
+            this->coherency = inheriting_block.coherency.load();
+            this->fetching = inheriting_block.fetching.load();
+            this->version = inheriting_block.version;
 
             # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
             this->registered = inheriting_block.registered;
@@ -395,6 +460,9 @@ class KBLASMemoryTreeNodeSearch {
                 /* true if this block is already being fetched by a concurrent read access */
                 bool must_fetch;
 
+                /* if the copy is split across several sources */
+                memory_fetch_splits_t splits;
+
             public:
 
                 Partite(MemoryBlock * b, const Rect & h) :
@@ -406,7 +474,9 @@ class KBLASMemoryTreeNodeSearch {
                     src_device_global_id(HOST_DEVICE_GLOBAL_ID),
                     src_allocation_view_id(MEMORY_REPLICATE_ALLOCATION_VIEW_NONE),
                     src_view(),
-                    must_fetch(true)
+                    src_chunk(nullptr),
+                    must_fetch(true),
+                    splits()
                 {}
 
                 virtual ~Partite() {}
@@ -452,8 +522,14 @@ class KBLASMemoryTreeNodeSearch {
                 /* the dst chunk onto the device, where all partites should write disjointly */
                 area_chunk_t * chunk;
 
+                /* true if a partite awaits a transfer already in-flight */
+                bool joined;
+
+                /* the tree epoch when the copies of that partition were set up */
+                uint64_t epoch;
+
             public:
-                Partition() : partites(), chunk(nullptr) {}
+                Partition() : partites(), chunk(nullptr), joined(false), epoch(UINT64_MAX) {}
                 ~Partition() {}
 
                 /* return the left-most and upper-most block of the partition */
@@ -484,9 +560,10 @@ class KBLASMemoryTreeNodeSearch {
             SEARCH_FOR_PARTITION = 1,    // search for a partition
             SEARCH_FETCHED       = 2,    // search tasks awaiting on blocks (to be transfered onto a gpu, typically)
             SEARCH_OWNERS        = 3,    // search how many bytes owns each device
+            SEARCH_COHERENT      = 4,    // search for a partition, only if already represented and coherent on a device
             # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
-            REGISTER             = 4,    // mark memory block as registered
-            UNREGISTER           = 5,    // mark memory block as unregistered
+            REGISTER             = 5,    // mark memory block as registered
+            UNREGISTER           = 6,    // mark memory block as unregistered
             # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
        };
 
@@ -528,11 +605,22 @@ class KBLASMemoryTreeNodeSearch {
             std::vector<MemoryForward> forwards;
         } awaiting;
 
+        /* blocks written after that tree epoch are not set coherent */
+        uint64_t epoch;
+
         ///////////////////////////////////
         // used if type == SEARCH_OWNERS //
         ///////////////////////////////////
         size_t bytes_owned[XKRT_DEVICES_MAX];
 
+        /////////////////////////////////////
+        // used if type == SEARCH_COHERENT //
+        /////////////////////////////////////
+
+        /* set to false if a block intersecting is not included in the
+         * access, or not coherent on the device */
+        bool coherent;
+
    public:
        KBLASMemoryTreeNodeSearch() : KBLASMemoryTreeNodeSearch(HOST_DEVICE_GLOBAL_ID) {}
 
@@ -544,7 +632,9 @@ class KBLASMemoryTreeNodeSearch {
            access(nullptr),
            partition(),
            chunk(nullptr),
-           awaiting()
+           awaiting(),
+           epoch(UINT64_MAX),
+           coherent(true)
        {}
 
        virtual ~KBLASMemoryTreeNodeSearch() {}
@@ -565,12 +655,21 @@ class KBLASMemoryTreeNodeSearch {
        }
 
        void
-       prepare_search_fetched(area_chunk_t * chunk)
+       prepare_search_fetched(area_chunk_t * chunk, uint64_t epoch = UINT64_MAX)
        {
            this->chunk = chunk;
+           this->epoch = epoch;
            this->type = SEARCH_FETCHED;
        }
 
+       void
+       prepare_search_coherent(void)
+       {
+           assert(this->partition.partites.size() == 0);
+           this->coherent = true;
+           this->type = SEARCH_COHERENT;
+       }
+
        void
        prepare_search_owners(void)
        {
@@ -666,8 +765,17 @@ class KBLASMemoryTreeNode : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>::Nod
 
 }; /* KBLASMemoryTreeNode */
 
+/**
+ *  Concurrency: the tree is protected by a reader-writer lock.
+ *      - structural changes (inserting or splitting blocks), allocations of
+ *        replicas, the coherency protocol and fetch completions (which update
+ *        the block states and the 'awaiting' lists of views) run exclusively
+ *      - lookups (owners, accesses already coherent on a device) run with a
+ *        shared lock, they only read block states, and touch or pin the chunks
+ *        they use atomically ('last_use' and 'pin_counter')
+ */
 template <int K>
-class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public Lockable, public MemoryCoherencyController {
+class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public RWLockable, public MemoryCoherencyController {
 
     public:
         using Base = KHPTree<K, KBLASMemoryTreeNodeSearch<K>>;
@@ -695,7 +803,10 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
             ld(ld),
             sizeof_type(sizeof_type),
             merge_transfers(merge_transfers),
-            pagesize(getpagesize())
+            pagesize(getpagesize()),
+            writeback_bytes(),
+            relocating(),
+            epoch(0)
         {}
 
         ~KBLASMemoryTree() {}
@@ -718,6 +829,15 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
         /* pagesize, to avoid repetitively calling `getpagesize()` */
         const size_t pagesize;
 
+        /* bytes of device memory being written back to the host before eviction, per device */
+        std::atomic<size_t> writeback_bytes[XKRT_DEVICES_MAX];
+
+        /* number of chunks being relocated by defragmentations, per device */
+        std::atomic<size_t> relocating[XKRT_DEVICES_MAX];
+
+        /* number of writes set up so far - see 'MemoryBlock::version' */
+        uint64_t epoch;
+
     public:
 
         typedef struct  fetch_t
@@ -734,6 +854,9 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
             /* src view */
             memory_replica_view_t src_view;
 
+            /* src chunk, pinned until the copy completes (NULL if the host) */
+            area_chunk_t * src_chunk;
+
             /* mark 'fetched' all the tasks awaiting on that allocation */
             area_chunk_t * dst_chunk;
 
@@ -746,6 +869,16 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
             /* whether this fetch had been merged, and can therefore be skipped */
             bool merged;
 
+            /* number of fetches of the access completed by that fetch (several forwards may be merged) */
+            task_wait_counter_type_t n;
+
+            /* if the copy is split across several sources, and the number of parts not completed yet */
+            memory_fetch_splits_t splits;
+            std::atomic<uint8_t> splits_pending;
+
+            /* the tree epoch when that copy was set up */
+            uint64_t epoch;
+
         }               fetch_t;
 
         typedef struct  fetch_list_t
@@ -772,6 +905,8 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
             prepare_next_fetch(void)
             {
                 fetch_t * fetch = this->fetches + this->n;
+                fetch->n = 1;
+                fetch->splits.n = 0;
                 ++this->n;
                 assert(this->n <= this->capacity);
                 return fetch;
@@ -860,6 +995,14 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
                 if (fj->merged)
                     continue ;
 
+                /* fetches split across several sources are launched part by
+                 * part, so they cannot be merged in either direction */
+                if (fi->splits.n > 1 || fj->splits.n > 1)
+                {
+                    fi = fj;
+                    continue ;
+                }
+
                 /* fetches must occur between the same devices */
                 if (    fi->src_device_global_id == fj->src_device_global_id    &&
                         fi->dst_device_global_id == fj->dst_device_global_id    &&
@@ -931,7 +1074,8 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
         fetch_callback_access(
             runtime_t * runtime,
             fetch_t * fetch,
-            access_t * access
+            access_t * access,
+            task_wait_counter_type_t n = 1
         ) {
             assert(access->task);
             LOGGER_DEBUG("task `%s` fetched `%p` on device `%u`",
@@ -940,7 +1084,70 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
 
             device_t * device = runtime->device_get(fetch->dst_device_global_id);
             assert(device);
-            __task_fetched(1, access->task, task_execute, runtime, device);
+            __task_fetched(n, access->task, task_execute, runtime, device);
+        }
+
+        /**
+         *  Merge forwards of the same access to the same allocation, whose dst
+         *  rects are adjacent and form a single rect, so they are performed
+         *  with a single 2D copy.
+         *  Returns the number of transfers saved.
+         */
+        static inline size_t
+        forwards_merge(
+            std::vector<MemoryForward> & forwards,
+            const size_t sizeof_type
+        ) {
+            size_t saved = 0;
+
+            /* merge along rows first, then along columns */
+            for (const int dim : {ACCESS_BLAS_ROW_DIM, ACCESS_BLAS_COL_DIM})
+            {
+                if (forwards.size() <= 1)
+                    break ;
+
+                const int other = (dim == ACCESS_BLAS_ROW_DIM) ? ACCESS_BLAS_COL_DIM : ACCESS_BLAS_ROW_DIM;
+                std::sort(forwards.begin(), forwards.end(),
+                    [dim, other] (const MemoryForward & x, const MemoryForward & y) {
+                        if (x.access != y.access)
+                            return x.access < y.access;
+                        if (x.chunk != y.chunk)
+                            return x.chunk < y.chunk;
+                        if (x.dst_hyperrect[other].a != y.dst_hyperrect[other].a)
+                            return x.dst_hyperrect[other].a < y.dst_hyperrect[other].a;
+                        return x.dst_hyperrect[dim].a < y.dst_hyperrect[dim].a;
+                    }
+                );
+
+                size_t i = 0;
+                for (size_t j = 1 ; j < forwards.size() ; ++j)
+                {
+                    MemoryForward & fi = forwards[i];
+                    const MemoryForward & fj = forwards[j];
+
+                    /* rows are in bytes, columns are 'ld' elements appart */
+                    const size_t length = (size_t) fi.dst_hyperrect[dim].length();
+                    const size_t offset = (dim == ACCESS_BLAS_ROW_DIM) ? length : length * fi.device_view.ld * sizeof_type;
+
+                    if (fi.access           == fj.access            &&
+                        fi.chunk            == fj.chunk             &&
+                        fi.device_global_id == fj.device_global_id  &&
+                        fi.device_view.ld   == fj.device_view.ld    &&
+                        fi.dst_hyperrect[other] == fj.dst_hyperrect[other]  &&
+                        fi.dst_hyperrect[dim].b == fj.dst_hyperrect[dim].a  &&
+                        fi.device_view.addr + offset == fj.device_view.addr)
+                    {
+                        fi.dst_hyperrect[dim].b = fj.dst_hyperrect[dim].b;
+                        fi.n = (task_wait_counter_type_t) (fi.n + fj.n);
+                        ++saved;
+                    }
+                    else
+                        forwards[++i] = fj;
+                }
+                forwards.erase(forwards.begin() + (ptrdiff_t) (i + 1), forwards.end());
+            }
+
+            return saved;
         }
 
         static inline fetch_list_t *
@@ -977,15 +1184,25 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
             if (fetch->dst_chunk)
                 LOGGER_DEBUG("Fetch completed for allocation `%p`", (void *) fetch->dst_chunk->ptr);
 
+            /* the link is free again */
+            runtime->router->transfer_end(fetch->src_device_global_id, fetch->dst_device_global_id);
+
+            /* the source may be evicted again */
+            if (fetch->src_chunk)
+                area_chunk_unpin(fetch->src_chunk);
+
             // avoid early deletion if a 'reset' is called before returning from this
             tree->ref();
             {
-                fetch_callback_access(runtime, fetch, access);
+                fetch_callback_access(runtime, fetch, access, fetch->n);
 
                 /* `fetch->dst_chunk` is the allocated memory chunk on which the data had been fetched. */
                 assert(fetch->dst_chunk || fetch->dst_device_global_id == HOST_DEVICE_GLOBAL_ID);
 
-                /* Search in the tree to unmark the block 'fetching' bit, and forward data to awaiting tasks using D2D */
+                /* Search in the tree to unmark the block 'fetching' bit, and
+                 * forward data to awaiting tasks using D2D. The search moves
+                 * the awaiting lists and clears fetching bits that concurrent
+                 * fetches may set again: it must be exclusive */
                 Search search(fetch->dst_device_global_id);
                 search.prepare_search_fetched(fetch->dst_chunk);
                 tree->lock();
@@ -1000,13 +1217,23 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
                     for (access_t * & access_awaiting : search.awaiting.accesses)
                         fetch_callback_access(runtime, fetch, access_awaiting);
 
-                    /* callback to forward the data to other devices */
+                    /* callback to forward the data to other devices, merging
+                     * forwards that can be performed with a single copy */
+                    if (search.awaiting.forwards.size() > 1)
+                    {
+                        const size_t saved = forwards_merge(search.awaiting.forwards, tree->sizeof_type);
+                        XKRT_STATS_INCR(runtime->stats.memory.forwards.merged, saved);
+
+                        /* the chunk was pinned once per forward */
+                        for (size_t i = 0 ; i < saved ; ++i)
+                            area_chunk_unpin(fetch->dst_chunk);
+                    }
+
                     task_wait_counter_type_t nforwards = (task_wait_counter_type_t) search.awaiting.forwards.size();
                     if (nforwards)
                     {
                         fetch_list_t * forward_list = fetch_list_new(tree, nforwards);
 
-                        # pragma message(TODO "Forwards consecutive in memory should be merged")
                         for (size_t i = 0 ; i < nforwards ; ++i)
                         {
                             MemoryForward & forward = search.awaiting.forwards[i];
@@ -1025,6 +1252,9 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
                             // the chunk to use
                             forward_fetch->dst_chunk = forward.chunk;
 
+                            // number of forwards merged into that fetch
+                            forward_fetch->n = forward.n;
+
                             // the dst device to forward to
                             forward_fetch->dst_device_global_id = forward.device_global_id;
 
@@ -1034,8 +1264,9 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
                             // only 1 rect representing the forward view
                             forward_fetch->rect = forward.dst_hyperrect;
 
-                            // the just-fetched 'dst' is the new 'src'
+                            // the just-fetched 'dst' is the new 'src' (pinned in the search)
                             forward_fetch->src_device_global_id = fetch->dst_device_global_id;
+                            forward_fetch->src_chunk = fetch->dst_chunk;
 
                             // this fetch maybe got a larger region than the one to forward, for instance
                             //      fetch->dst = [                                                      ]
@@ -1098,9 +1329,12 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
                 fetch->host_view            = host_view;
                 fetch->src_device_global_id = partite.src_device_global_id;
                 fetch->src_view             = src_view;
+                fetch->src_chunk            = (partite.src_allocation_view_id == MEMORY_REPLICATE_ALLOCATION_VIEW_NONE) ? nullptr : partite.src_chunk;
                 fetch->dst_chunk            = partition.chunk;
                 fetch->dst_device_global_id = partite.dst_device_global_id;
                 fetch->dst_view             = dst_view;
+                fetch->splits               = partite.splits;
+                fetch->epoch                = partition.epoch;
             }
             list->fetching(list->n.load());
 
@@ -1173,6 +1407,7 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
                 partite.src_device_global_id    = src;
                 partite.src_view                = src_allocation_view->view;
                 partite.src_chunk               = src_allocation_view->chunk;
+                area_chunk_pin(partite.src_chunk);
 
                 partite.dst_allocation_view_id  = MEMORY_REPLICATE_ALLOCATION_VIEW_NONE;
                 partite.dst_device_global_id    = HOST_DEVICE_GLOBAL_ID;
@@ -1189,19 +1424,24 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
 
             /* optim: if there had been no devices accesses previously, nothing to do */
             if (this->root == NULL)
+            {
+                XKRT_STATS_INCR(this->runtime->device_get(HOST_DEVICE_GLOBAL_ID)->stats.memory.coherence.hits, 1);
                 return NULL;
+            }
 
             Search search(HOST_DEVICE_GLOBAL_ID);
             this->lock();
             {
                 /* step (1) ensure the access is represented in the tree as blocks */
                 search.prepare_insert(access);
-                for (Rect & rect : access->rects())
+                Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+                std::span<Rect> rects = access->rects(buffer);
+                for (Rect & rect : rects)
                     this->insert(search, rect);
 
                 /* step (2) find all blocks representing the access */
                 search.prepare_search_partition();
-                for (const Rect & rect : access->rects())
+                for (const Rect & rect : rects)
                     this->intersect(search, rect);
                 assert(search.partition.partites.size() >= 1);
 
@@ -1211,251 +1451,1072 @@ class KBLASMemoryTree : public KHPTree<K, KBLASMemoryTreeNodeSearch<K>>, public
             this->unlock();
 
             /* generate the fetch list */
-            return this->fetch_list_from_partition(search.partition);
+            fetch_list_t * list = this->fetch_list_from_partition(search.partition);
+            # if XKRT_SUPPORT_STATS
+            device_t * device = this->runtime->device_get(HOST_DEVICE_GLOBAL_ID);
+            if (list)
+                XKRT_STATS_INCR(device->stats.memory.coherence.misses, 1);
+            else
+                XKRT_STATS_INCR(device->stats.memory.coherence.hits, 1);
+            # endif /* XKRT_SUPPORT_STATS */
+            return list;
         }
 
         ////////////////////////
         //  FETCH ON A DEVICE //
         ////////////////////////
 
+        /* an eviction candidate: a device chunk and the views relying on it */
+        typedef struct  eviction_candidate_t
+        {
+            area_chunk_t * chunk;   /* the device chunk */
+            int nviews;             /* number of views on that chunk found in the tree */
+            bool evictable;         /* false if any view is being fetched or awaited */
+            bool writeback;         /* true if a view is the sole valid copy, that must be written back to the host first */
+            int cost;               /* 0 if stale, 1 if also valid on the host or in another view, 2 if only valid on other devices, 3 if must be written back */
+        }               eviction_candidate_t;
+
+        using eviction_candidates_t = std::unordered_map<area_chunk_t *, eviction_candidate_t>;
+        using eviction_victims_t    = std::unordered_set<area_chunk_t *>;
+
+        /* collect all chunks of the device referenced in the tree - must be called within the critical section */
         inline void
-        fetch_access_allocate_eviction(
+        fetch_access_eviction_collect(
             device_global_id_t device_global_id,
-            size_t size
+            eviction_candidates_t & candidates
         ) {
+            assert(this->is_locked());
 
-            /* adapted from 'memory_cache_evict_fromlist' */
-            LOGGER_DEBUG("Evicting memory...");
-
-            // TODO : currently deallocating as much as possible, maybe stop when there is a chunk big-enough of 'size'
+            const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+            const device_global_id_bitfield_t hostbit = (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID);
 
-            size_t freed = 0;
-            auto f = [this, size, device_global_id, &freed](NodeBase * nodebase, void * args, bool & stop) {
+            auto f = [&candidates, devbit, hostbit, device_global_id](NodeBase * nodebase, void * args, bool & stop) {
                 (void) args;
+                (void) stop;
 
                 Node * node = reinterpret_cast<Node *>(nodebase);
                 assert(node);
 
                 MemoryBlock & block = node->block;
+                MemoryReplica & replica = block.replicas[device_global_id];
 
-                const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+                const memory_allocation_view_id_bitfield_t coherency = replica.coherency.load();
+                const memory_allocation_view_id_bitfield_t fetching  = replica.fetching.load();
+                const device_global_id_bitfield_t block_coherency = block.coherency.load();
 
-                const bool coherent_on_any_device        = block.coherency != 0;
-                const bool coherent_on_device            = block.coherency &  devbit;
-                const bool coherent_on_any_other_devices = block.coherency & ~devbit;
+                for (memory_allocation_view_id_t i = 0 ; i < replica.nallocations ; ++i)
+                {
+                    MemoryReplicaAllocationView * allocation = replica.allocations[i];
+                    assert(allocation);
 
-                MemoryReplica & replica = block.replicas[device_global_id];
-                if (replica.fetching)
-                    return ;
+                    eviction_candidate_t & candidate = candidates.try_emplace(allocation->chunk, eviction_candidate_t{allocation->chunk, 0, true, false, 0}).first->second;
+                    ++candidate.nviews;
 
-                if (!coherent_on_any_device || coherent_on_any_other_devices)
-                {
-                    /* evict all allocations */
-                    for (int i = 0 ; i < replica.nallocations ; ++i)
+                    const memory_allocation_view_id_bitfield_t bit = (memory_allocation_view_id_bitfield_t) (1 << i);
+                    if ((fetching & bit) || !allocation->awaiting.accesses.empty() || !allocation->awaiting.forwards.empty())
+                        candidate.evictable = false;
+                    else if (coherency & bit)
                     {
-                        MemoryReplicaAllocationView * allocation = replica.allocations[i];
-                        assert(allocation);
-
-                        /* if only this block uses the allocation */
-                        if (allocation->chunk->use_counter == 1)
-                        {
-                            LOGGER_DEBUG("Evicted a block of size %zu MB", allocation->chunk->size/1024/1024);
-                            this->runtime->memory_device_deallocate(device_global_id, allocation->chunk);
-                            freed += allocation->chunk->size;
-                        }
-                        /* else: what to do ? */
+                        /* another coherent allocation on that device, or the host is coherent */
+                        if ((coherency & ~bit) || (block_coherency & hostbit))
+                            candidate.cost = std::max(candidate.cost, 1);
+                        /* another device is coherent */
+                        else if (block_coherency & ~devbit)
+                            candidate.cost = std::max(candidate.cost, 2);
+                        /* sole valid copy */
                         else
                         {
-                            // LOGGER_FATAL("Couldn't evict a chunk that is used in several allocation view - coherent_on_any_device=%d, coherent_on_any_other_devices=%d", coherent_on_any_device, coherent_on_any_other_devices);
+                            candidate.writeback = true;
+                            candidate.cost = 3;
                         }
-
-                        // delete allocation;
                     }
-                    replica.nallocations  = 0;
-                    replica.coherency     = 0;
-                    assert(replica.fetching == 0);
-
-                    block.coherency &= (device_global_id_bitfield_t) ~devbit;
-
-                    stop = freed >= 16*size;
-                    // stop = false;
-                }
-                else if (coherent_on_device && replica.nallocations > 1)
-                {
-                    // TODO : only keep 1 coherent allocation
-                    LOGGER_FATAL("coherent_on_device=%d, nallocations=%d", coherent_on_device, replica.nallocations);
                 }
             };
-
             this->foreach_node_until(f, NULL);
         }
 
-        inline area_chunk_t *
-        fetch_access_allocate(
-            access_t * access,
-            device_global_id_t device_global_id
+        /* remove all views on the victims chunks - must be called within the critical section */
+        inline void
+        fetch_access_eviction_remove(
+            device_global_id_t device_global_id,
+            const eviction_victims_t & victims
         ) {
-            //////////////////////////
-            // Allocate a new chunk //
-            //////////////////////////
-
-            const size_t size = access->host_view.m * access->host_view.n * access->host_view.sizeof_type;
-            area_chunk_t * chunk = nullptr;
-            int retry_cnt = 0;
+            assert(this->is_locked());
 
-            do {
+            const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
 
-                chunk = this->runtime->memory_device_allocate(device_global_id, size);
-                if (chunk)
-                    return chunk;
+            auto f = [&victims, devbit, device_global_id](NodeBase * nodebase, void * args, bool & stop) {
+                (void) args;
+                (void) stop;
 
-                // TODO : polling is risky here, because it may take a lock on the
-                // memory tree, and 'memory_allocate' is called within a
-                // memory-tree lock => double-lock deadlock
+                Node * node = reinterpret_cast<Node *>(nodebase);
+                assert(node);
 
-                // device_poll(device);
-                fetch_access_allocate_eviction(device_global_id, size);
+                MemoryBlock & block = node->block;
+                MemoryReplica & replica = block.replicas[device_global_id];
+                const bool was_coherent = (replica.coherency != 0);
 
-            } while (++retry_cnt < 32);
+                for (memory_allocation_view_id_t i = 0 ; i < replica.nallocations ; )
+                {
+                    if (victims.find(replica.allocations[i]->chunk) == victims.end())
+                    {
+                        ++i;
+                        continue ;
+                    }
 
-            LOGGER_FATAL("!! GPU IS OUT OF MEMORY !!");
+                    MemoryReplicaAllocationView * allocation = replica.remove_allocation(i);
+                    --(allocation->chunk->use_counter);
+                    delete allocation;
+                }
 
-            return nullptr;
+                if (was_coherent && replica.coherency == 0)
+                    block.coherency &= (device_global_id_bitfield_t) ~devbit;
+            };
+            this->foreach_node_until(f, NULL);
         }
 
-        /* Create a view for each partite of the partition, for the newly allocated chunk */
+        /* release the victims chunks - must be called outside the critical section */
         inline void
-        fetch_access_create_allocation_views(
-            access_t * access,
+        fetch_access_eviction_release(
             device_global_id_t device_global_id,
-            Partition & partition,
-            area_chunk_t * chunk
+            const eviction_victims_t & victims
         ) {
-            assert(chunk);
-
-            /* allocate continuous memory for that access */
-            # pragma message(TODO "Can we manage row/col major in a better way ? hardcoded col major here for cuda")
-            const size_t          ld = access->host_view.m;            // cuda is col major
-            const size_t sizeof_type = access->host_view.sizeof_type;
-
-            /* retrieve upper left corner */
-            const Partite & corner = partition.get_leftmost_uppermost_block();
-
-            /* add a view */
-            for (Partite & partite : partition.partites)
+            for (area_chunk_t * chunk : victims)
             {
-                /* compute distance from corner */
-                INTERVAL_DIFF_TYPE_T d[K];
-                Rect::distance_manhattan(corner.hyperrect, partite.hyperrect, d);
-                if (d[ACCESS_BLAS_ROW_DIM] < 0)
-                {
-                    d[ACCESS_BLAS_ROW_DIM] += this->ld * this->sizeof_type;
-                    d[ACCESS_BLAS_COL_DIM] -= 1;
-                }
-                assert(d[ACCESS_BLAS_ROW_DIM] >= 0);
-                assert(d[ACCESS_BLAS_COL_DIM] >= 0);
-
-                const uintptr_t offset = d[ACCESS_BLAS_ROW_DIM] + d[ACCESS_BLAS_COL_DIM]*ld*sizeof_type;
-                const uintptr_t begin_addr = chunk->ptr + offset;
-
-                MemoryReplica & replica = partite.block->replicas[device_global_id];
-                const memory_allocation_view_id_t allocation_view_id = replica.nallocations;
-                replica.nallocations += 1;
-                if (allocation_view_id >= MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX)
-                    LOGGER_FATAL("Too many allocations of the same data on the same device... Increase `MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX` and recompile");
-
-                /* allocate the view of that block in the allocation */
-                MemoryReplicaAllocationView * r = new MemoryReplicaAllocationView(chunk, begin_addr, ld);
-                replica.allocations[allocation_view_id] = r;
-                partite.dst_allocation_view_id = allocation_view_id;
+                assert(chunk->use_counter == 0);
+                LOGGER_DEBUG("Evicted a chunk of size %zu MB", chunk->size/1024/1024);
+                XKRT_STATS_INCR(this->runtime->device_get(device_global_id)->stats.memory.coherence.evictions, 1);
+                XKRT_STATS_INCR(this->runtime->device_get(device_global_id)->stats.memory.coherence.evicted, chunk->size);
+                this->runtime->memory_device_deallocate(device_global_id, chunk);
             }
         }
 
-        /* look for a continuous allocation that can store 'access' for the given partition */
-        inline area_chunk_t *
-        fetch_access_find_allocation_continuous(
+        /**
+         *  Setup the partition to write back to the host each block whose sole
+         *  valid copy is in one of the given chunk.
+         *  Chunks are pinned and the host is marked fetching until the copy
+         *  completes - must be called within the critical section
+         */
+        inline void
+        fetch_access_eviction_writeback_setup_partition(
             device_global_id_t device_global_id,
+            const eviction_victims_t & writebacks,
             Partition & partition
         ) {
             assert(this->is_locked());
 
-            memory_allocation_view_id_t j = 0;
-            int nallocations = partition.partites[0].block->replicas[device_global_id].nallocations;
-            size_t nblocks = partition.partites.size();
-
-            /* for each allocation of the block 0 */
-            while (j < nallocations)
-            {
-                MemoryReplicaAllocationView * rj = partition.partites[0].block->replicas[device_global_id].allocations[j];
+            const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+            const device_global_id_bitfield_t hostbit = (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID);
 
-                /* for each other blocks */
-                size_t i = 1;
-                while (i < nblocks)
-                {
-                    /* for each allocation of other blocks */
-                    int nallocations = partition.partites[i].block->replicas[device_global_id].nallocations;
-                    for (memory_allocation_view_id_t k = 0 ; k < nallocations ; ++k)
-                    {
-                        /* this block has a view with the same allocation, check next block */
-                        MemoryReplicaAllocationView * rk = partition.partites[i].block->replicas[device_global_id].allocations[k];
-                        if (rj->chunk == rk->chunk)
-                        {
-                            partition.partites[i].dst_allocation_view_id = k;
-                            goto next_block;
-                        }
-                    }
+            /* blocks written after that are not set coherent on the host once copied */
+            partition.epoch = this->epoch;
 
-                    /* this block has no view view the same allocation, restart from the next view of block 0 */
-                    goto next_view;
+            auto f = [&writebacks, &partition, devbit, hostbit, device_global_id](NodeBase * nodebase, void * args, bool & stop) {
+                (void) args;
+                (void) stop;
 
-next_block:
-                    ++i;
-                    continue ;
-                }
+                Node * node = reinterpret_cast<Node *>(nodebase);
+                assert(node);
 
-                /* every blocks have a view with the allocation 'allocation' */
-                partition.partites[0].dst_allocation_view_id = j;
-                return rj->chunk;
+                MemoryBlock & block = node->block;
+                MemoryReplica & replica = block.replicas[device_global_id];
 
-next_view:
-                ++j;
-                continue ;
-            }
-            return nullptr;
-        }
+                /* the block must only be valid on that device */
+                if ((block.coherency & ~devbit) || (block.fetching & hostbit))
+                    return ;
 
-        /* set 'partition.chunk' to a memory chunk and all 'partites.dst_allocation_view_id' to a view on that chunk */
-        inline void
-        fetch_access_find_allocation(
-            access_t * access,
-            device_global_id_t device_global_id,
-            Partition & partition
-        ) {
-            assert(this->is_locked());
+                for (memory_allocation_view_id_t i = 0 ; i < replica.nallocations ; ++i)
+                {
+                    MemoryReplicaAllocationView * allocation = replica.allocations[i];
+                    const memory_allocation_view_id_bitfield_t bit = (memory_allocation_view_id_bitfield_t) (1 << i);
+                    if (replica.coherency != bit || writebacks.find(allocation->chunk) == writebacks.end())
+                        continue ;
 
-            /* lookfor a continuous allocation already existing for that access block partitioning */
-            area_chunk_t * chunk = this->fetch_access_find_allocation_continuous(device_global_id, partition);
-            if (chunk == nullptr)
-            {
-                /* no continuous allocation found, make a new one */
-                LOGGER_DEBUG("No continuous allocation found, reallocating and creating a new view");
-                chunk = this->fetch_access_allocate(access, device_global_id);
-                assert(chunk);
+                    Partite partite(&block, node->hyperrect);
+                    partite.src_allocation_view_id  = i;
+                    partite.src_device_global_id    = device_global_id;
+                    partite.src_view                = allocation->view;
+                    partite.src_chunk               = allocation->chunk;
+                    area_chunk_pin(partite.src_chunk);
 
-                /* create new views */
-                this->fetch_access_create_allocation_views(access, device_global_id, partition, chunk);
-            }
+                    partite.dst_allocation_view_id  = MEMORY_REPLICATE_ALLOCATION_VIEW_NONE;
+                    partite.dst_device_global_id    = HOST_DEVICE_GLOBAL_ID;
+                    partition.partites.push_back(partite);
 
-            partition.chunk = chunk;
+                    block.fetching |= hostbit;
+                    break ;
+                }
+            };
+            this->foreach_node_until(f, NULL);
         }
 
-        inline void
-        fetch_access_setup_replicas(
-            access_t * access,
-            device_global_id_t device_global_id,
-            Search & search
-        ) {
-            assert(this->is_locked());
+        /* called once a write-back completed */
+        static void
+        fetch_access_eviction_writeback_callback(void * args[XKRT_CALLBACK_ARGS_MAX])
+        {
+            assert(XKRT_CALLBACK_ARGS_MAX >= 3);
+
+            fetch_list_t * list = (fetch_list_t *) args[1];
+            assert(list);
+
+            KBLASMemoryTree * tree = list->tree;
+            assert(tree);
+
+            size_t fetch_idx = (size_t) args[2];
+            assert(fetch_idx >= 0 && fetch_idx < list->n);
+
+            fetch_t * fetch = list->fetches + fetch_idx;
+            assert(fetch->src_chunk);
+            assert(fetch->dst_device_global_id == HOST_DEVICE_GLOBAL_ID);
+
+            /* the link is free again */
+            runtime_t * runtime = (runtime_t *) args[0];
+            assert(runtime);
+            runtime->router->transfer_end(fetch->src_device_global_id, fetch->dst_device_global_id);
+
+            // avoid early deletion if a 'reset' is called before returning from this
+            tree->ref();
+            {
+                /* the host is now coherent, unless a block was written
+                 * since the write-back was set up */
+                Search search(HOST_DEVICE_GLOBAL_ID);
+                search.prepare_search_fetched(nullptr, fetch->epoch);
+                tree->lock();
+                {
+                    tree->intersect(search, fetch->rect);
+                }
+                tree->unlock();
+
+                area_chunk_unpin(fetch->src_chunk);
+
+                /* last write-back of the list, evict the written-back chunks */
+                if (list->fetched() == 1)
+                {
+                    tree->fetch_access_eviction_writeback_release(list);
+                    free(list);
+                }
+            }
+            tree->unref();
+        }
+
+        /* evict chunks that got written-back, if they were not used meanwhile */
+        inline void
+        fetch_access_eviction_writeback_release(fetch_list_t * list)
+        {
+            assert(list->n > 0);
+            const device_global_id_t device_global_id = list->fetches[0].src_device_global_id;
+
+            eviction_victims_t chunks;
+            size_t bytes = 0;
+            for (size_t i = 0 ; i < list->n ; ++i)
+                if (chunks.insert(list->fetches[i].src_chunk).second)
+                    bytes += list->fetches[i].src_chunk->size;
+
+            eviction_candidates_t candidates;
+            eviction_victims_t victims;
+            this->lock();
+            {
+                this->fetch_access_eviction_collect(device_global_id, candidates);
+                for (area_chunk_t * chunk : chunks)
+                {
+                    auto it = candidates.find(chunk);
+                    if (it == candidates.end())
+                        continue ;
+                    const eviction_candidate_t & candidate = it->second;
+                    if (candidate.evictable && !candidate.writeback && candidate.nviews == chunk->use_counter && chunk->pin_counter == 0)
+                        victims.insert(chunk);
+                }
+                this->fetch_access_eviction_remove(device_global_id, victims);
+            }
+            this->unlock();
+
+            this->fetch_access_eviction_release(device_global_id, victims);
+            this->writeback_bytes[device_global_id].fetch_sub(bytes, std::memory_order_release);
+            this->writeback_bytes[device_global_id].notify_all();
+        }
+
+        /* launch write-backs of the given partition to the host */
+        inline void
+        fetch_access_eviction_writeback_launch(
+            device_global_id_t device_global_id,
+            Partition & partition
+        ) {
+            fetch_list_t * list = this->fetch_list_from_partition(partition);
+            if (list == NULL)
+                return ;
+
+            eviction_victims_t chunks;
+            size_t bytes = 0;
+            for (size_t i = 0 ; i < list->n ; ++i)
+                if (chunks.insert(list->fetches[i].src_chunk).second)
+                    bytes += list->fetches[i].src_chunk->size;
+            this->writeback_bytes[device_global_id].fetch_add(bytes, std::memory_order_relaxed);
+
+            /* the list is deleted by the last completion, hold it until all copies are launched */
+            list->fetching();
+            for (size_t i = 0 ; i < list->n ; ++i)
+            {
+                fetch_t * fetch = list->fetches + i;
+
+                callback_t callback;
+                callback.func = fetch_access_eviction_writeback_callback;
+                callback.args[0] = this->runtime;
+                callback.args[1] = list;
+                callback.args[2] = (void *) i;
+
+                LOGGER_DEBUG("Writing back a block of size %zu to the host before eviction", fetch->host_view.m * fetch->host_view.n * fetch->host_view.sizeof_type);
+                this->runtime->router->transfer_begin(fetch->src_device_global_id, fetch->dst_device_global_id);
+                this->runtime->copy(
+                    device_global_id,
+                    fetch->host_view,
+                    fetch->dst_device_global_id,
+                    fetch->dst_view,
+                    fetch->src_device_global_id,
+                    fetch->src_view,
+                    callback
+                );
+            }
+
+            if (list->fetched() == 1)
+            {
+                this->fetch_access_eviction_writeback_release(list);
+                free(list);
+            }
+        }
+
+        /* wait for pending write-backs of the device: threads of the device
+         * progress their queues meanwhile, as they may hold the copies, others
+         * sleep until the write-backs completed */
+        inline void
+        fetch_access_eviction_writeback_wait(device_global_id_t device_global_id)
+        {
+            thread_t * thread = thread_t::get_tls();
+            device_t * device = this->runtime->device_get(device_global_id);
+            assert(device);
+
+            size_t bytes;
+            while ((bytes = this->writeback_bytes[device_global_id].load(std::memory_order_acquire)) > 0)
+            {
+                if (thread && thread->device_global_id == device_global_id)
+                {
+                    device->offloader_launch(thread->tid);
+                    device->offloader_progress(thread->tid);
+                }
+                else
+                    this->writeback_bytes[device_global_id].wait(bytes, std::memory_order_acquire);
+            }
+        }
+
+        /**
+         *  Evict chunks of the device until at least 'size' bytes were freed.
+         *  A chunk may be evicted if
+         *      - it is not pinned (no running task and no copy uses it)
+         *      - none of its views is being fetched
+         *  Victims are elected by the configured policy (least recently used
+         *  first, or the cheapest to refetch first).
+         *  Victims holding the sole valid copy of some data are asynchronously
+         *  written back to the host, and only freed once the write-back
+         *  completed (see 'fetch_access_eviction_writeback_wait').
+         *  Returns the number of bytes freed or being freed.
+         */
+        inline size_t
+        fetch_access_allocate_eviction(
+            device_global_id_t device_global_id,
+            size_t size
+        ) {
+            LOGGER_DEBUG("Evicting memory...");
+
+            eviction_candidates_t candidates;
+            eviction_victims_t victims;
+            eviction_victims_t writebacks;
+            Partition partition;
+            size_t freed = 0;
+
+            /* allocations are performed outside the critical section, so the
+             * eviction must lock the tree */
+            this->lock();
+            {
+                if (this->root == NULL)
+                {
+                    this->unlock();
+                    return 0;
+                }
+
+                /* collect evictable chunks */
+                this->fetch_access_eviction_collect(device_global_id, candidates);
+
+                std::vector<eviction_candidate_t> sorted;
+                sorted.reserve(candidates.size());
+                for (auto & [chunk, candidate] : candidates)
+                    if (candidate.evictable && candidate.nviews == chunk->use_counter && chunk->pin_counter == 0)
+                        sorted.push_back(candidate);
+
+                /* elect victims */
+                const bool clean_first = (this->runtime->conf.device.eviction_policy == XKRT_MEMORY_EVICTION_POLICY_CLEAN_FIRST);
+                std::sort(sorted.begin(), sorted.end(),
+                    [clean_first] (const eviction_candidate_t & a, const eviction_candidate_t & b) {
+                        if (clean_first && a.cost != b.cost)
+                            return a.cost < b.cost;
+                        return a.chunk->last_use.load(std::memory_order_relaxed) < b.chunk->last_use.load(std::memory_order_relaxed);
+                    }
+                );
+
+                for (const eviction_candidate_t & candidate : sorted)
+                {
+                    if (freed >= size)
+                        break ;
+                    if (candidate.writeback)
+                        writebacks.insert(candidate.chunk);
+                    else
+                        victims.insert(candidate.chunk);
+                    freed += candidate.chunk->size;
+                }
+
+                /* remove views on clean victims, and prepare write-backs of dirty ones */
+                if (!victims.empty())
+                    this->fetch_access_eviction_remove(device_global_id, victims);
+                if (!writebacks.empty())
+                    this->fetch_access_eviction_writeback_setup_partition(device_global_id, writebacks, partition);
+            }
+            this->unlock();
+
+            /* release the chunks and launch write-backs */
+            this->fetch_access_eviction_release(device_global_id, victims);
+            this->fetch_access_eviction_writeback_launch(device_global_id, partition);
+
+            return freed;
+        }
+
+        /////////////////////////
+        //  DEFRAGMENTATION    //
+        /////////////////////////
+
+        /* a chunk of the device memory, as seen when searching room to defragment */
+        typedef struct  defrag_slot_t
+        {
+            uintptr_t ptr;
+            size_t size;
+            area_chunk_t * movable;     /* the chunk if it may be relocated, NULL if free */
+            bool eligible;              /* free, or may be relocated */
+            bool first;                 /* first chunk of a segment */
+        }               defrag_slot_t;
+
+        /* a chunk being relocated */
+        typedef struct  relocation_t
+        {
+            area_chunk_t * src;         /* the chunk, pinned until the relocation completes */
+            area_chunk_t * dst;         /* its new location */
+            uint64_t last_use;          /* 'src->last_use' when the relocation started, any use meanwhile aborts it */
+        }               relocation_t;
+
+        /* return true if the chunk of the relocation may still be relocated,
+         * and was not used since the relocation started */
+        static inline bool
+        fetch_access_defragment_unchanged(
+            const eviction_candidates_t & candidates,
+            const relocation_t & relocation
+        ) {
+            area_chunk_t * src = relocation.src;
+            auto it = candidates.find(src);
+            return it != candidates.end() && it->second.evictable && it->second.nviews == src->use_counter &&
+                src->pin_counter == 1 && src->last_use.load(std::memory_order_relaxed) == relocation.last_use;
+        }
+
+        /* called once a relocation copy completed */
+        static void
+        fetch_access_defragment_callback(void * args[XKRT_CALLBACK_ARGS_MAX])
+        {
+            std::atomic<size_t> * relocating = (std::atomic<size_t> *) args[0];
+            assert(relocating);
+            relocating->fetch_sub(1, std::memory_order_release);
+            relocating->notify_all();
+        }
+
+        /**
+         *  Find the range of continuous memory of at least 'size' bytes, made
+         *  of free chunks and of chunks that may be relocated, which requires
+         *  to relocate the least bytes.  Returns false if there is none.
+         */
+        static inline bool
+        fetch_access_defragment_window(
+            const std::vector<defrag_slot_t> & slots,
+            const size_t size,
+            size_t & begin,
+            size_t & end
+        ) {
+            size_t best = SIZE_MAX;
+            size_t i = 0, span = 0, moved = 0;
+            for (size_t j = 0 ; j < slots.size() ; ++j)
+            {
+                /* a window cannot span two segments, nor chunks that cannot move */
+                if (!slots[j].eligible || slots[j].first)
+                {
+                    i = slots[j].eligible ? j : j + 1;
+                    span = moved = 0;
+                    if (!slots[j].eligible)
+                        continue ;
+                }
+
+                span += slots[j].size;
+                if (slots[j].movable)
+                    moved += slots[j].size;
+
+                /* shrink from the left while the window is still large enough */
+                while (i < j && span - slots[i].size >= size)
+                {
+                    span -= slots[i].size;
+                    if (slots[i].movable)
+                        moved -= slots[i].size;
+                    ++i;
+                }
+
+                if (span >= size && moved < best)
+                {
+                    best  = moved;
+                    begin = i;
+                    end   = j + 1;
+                }
+            }
+            return best != SIZE_MAX && best > 0;
+        }
+
+        /**
+         *  Defragment a memory area of the device to make room for an
+         *  allocation of 'size' bytes, if its free memory is large enough but
+         *  too fragmented (see 'conf.device.defrag_threshold').
+         *  The chunks of the range of memory that requires to relocate the
+         *  least bytes are copied elsewhere on the device, and views on them
+         *  are rewritten once the copies completed.  A chunk may be relocated
+         *  if it may be evicted (see 'fetch_access_allocate_eviction'), and a
+         *  relocation is aborted if the chunk got used meanwhile.
+         *  The destinations are allocated out of the tree lock, as growing the
+         *  pool or evicting may call the driver, and the window is checked
+         *  again once they are allocated.
+         *  Returns true if any chunk got relocated.
+         */
+        inline bool
+        fetch_access_allocate_defragment_on(
+            device_global_id_t device_global_id,
+            size_t size,
+            int area_idx
+        ) {
+            device_t * device = this->runtime->device_get(device_global_id);
+            assert(device);
+
+            /* is the free memory fragmented enough */
+            size_t free_bytes = 0, largest = 0;
+            device->memory_foreach_chunk_on(area_idx, [&free_bytes, &largest] (area_chunk_t * chunk) {
+                if (chunk->state == XKRT_ALLOC_CHUNK_STATE_FREE)
+                {
+                    free_bytes += chunk->size;
+                    largest = std::max(largest, chunk->size);
+                }
+            });
+            if (free_bytes < size || largest >= size)
+                return false;
+            const double fragmentation = 1.0 - (double) largest / (double) free_bytes;
+            if (fragmentation < (double) this->runtime->conf.device.defrag_threshold)
+                return false;
+
+            LOGGER_DEBUG("Defragmenting memory (%zu free bytes, %.2f fragmented)...", free_bytes, fragmentation);
+
+            std::vector<relocation_t> relocations;
+            std::vector<area_chunk_t *> placeholders;
+            uintptr_t window_begin, window_end;
+
+            this->lock();
+            {
+                if (this->root == NULL)
+                {
+                    this->unlock();
+                    return false;
+                }
+
+                /* chunks that may be relocated */
+                eviction_candidates_t candidates;
+                this->fetch_access_eviction_collect(device_global_id, candidates);
+
+                std::vector<defrag_slot_t> slots;
+                device->memory_foreach_chunk_on(area_idx, [&slots, &candidates] (area_chunk_t * chunk) {
+                    defrag_slot_t slot = { chunk->ptr, chunk->size, nullptr, true, chunk->prev == NULL };
+                    if (chunk->state != XKRT_ALLOC_CHUNK_STATE_FREE)
+                    {
+                        auto it = candidates.find(chunk);
+                        if (it != candidates.end() && it->second.evictable && it->second.nviews == chunk->use_counter && chunk->pin_counter == 0)
+                            slot.movable = chunk;
+                        else
+                            slot.eligible = false;
+                    }
+                    slots.push_back(slot);
+                });
+
+                size_t begin, end;
+                if (!this->fetch_access_defragment_window(slots, size, begin, end))
+                {
+                    this->unlock();
+                    return false;
+                }
+                window_begin = slots[begin].ptr;
+                window_end   = slots[end - 1].ptr + slots[end - 1].size;
+
+                /* pin the chunks of the window, so they are not released
+                 * while their destinations are being allocated */
+                for (size_t i = begin ; i < end ; ++i)
+                {
+                    area_chunk_t * src = slots[i].movable;
+                    if (src == nullptr)
+                        continue ;
+
+                    area_chunk_pin(src);
+                    relocations.push_back(relocation_t{src, nullptr, src->last_use.load(std::memory_order_relaxed)});
+                }
+            }
+            this->unlock();
+
+            /* allocate destinations out of the window - allocations within the
+             * window are kept until the relocations completed, so they are not
+             * returned again */
+            bool failed = false;
+            for (relocation_t & relocation : relocations)
+            {
+                area_chunk_t * dst;
+                while ((dst = this->runtime->memory_device_allocate_on(device_global_id, relocation.src->size, area_idx)) &&
+                        dst->ptr < window_end && window_begin < dst->ptr + dst->size)
+                    placeholders.push_back(dst);
+
+                if (dst == nullptr)
+                {
+                    LOGGER_DEBUG("Not enough free memory out of the window to defragment");
+                    failed = true;
+                    break ;
+                }
+                relocation.dst = dst;
+            }
+
+            /* the chunks of the window may have been used meanwhile */
+            if (!failed)
+            {
+                this->lock();
+                {
+                    eviction_candidates_t candidates;
+                    this->fetch_access_eviction_collect(device_global_id, candidates);
+
+                    for (const relocation_t & relocation : relocations)
+                    {
+                        if (!fetch_access_defragment_unchanged(candidates, relocation))
+                        {
+                            LOGGER_DEBUG("The window got used while allocating, not defragmenting");
+                            failed = true;
+                            break ;
+                        }
+                    }
+                }
+                this->unlock();
+            }
+
+            if (failed)
+            {
+                for (relocation_t & relocation : relocations)
+                {
+                    area_chunk_unpin(relocation.src);
+                    if (relocation.dst)
+                        this->runtime->memory_device_deallocate(device_global_id, relocation.dst);
+                }
+                for (area_chunk_t * placeholder : placeholders)
+                    this->runtime->memory_device_deallocate(device_global_id, placeholder);
+                return false;
+            }
+
+            /* copy the chunks to their new location, and wait for completion */
+            std::atomic<size_t> & relocating = this->relocating[device_global_id];
+            relocating.fetch_add(relocations.size(), std::memory_order_relaxed);
+            for (relocation_t & relocation : relocations)
+            {
+                callback_t callback;
+                callback.func = fetch_access_defragment_callback;
+                callback.args[0] = &relocating;
+
+                this->runtime->copy(
+                    device_global_id,
+                    relocation.src->size,
+                    device_global_id,
+                    relocation.dst->ptr,
+                    device_global_id,
+                    relocation.src->ptr,
+                    callback
+                );
+            }
+
+            /* device threads progress the copies, other threads sleep until
+             * the relocations of that device (possibly of concurrent
+             * defragmentations too) completed */
+            thread_t * thread = thread_t::get_tls();
+            size_t n;
+            while ((n = relocating.load(std::memory_order_acquire)) > 0)
+            {
+                if (thread && thread->team && thread->team == device->team)
+                {
+                    device->offloader_launch(thread->tid);
+                    device->offloader_progress(thread->tid);
+                }
+                else
+                    relocating.wait(n, std::memory_order_acquire);
+            }
+
+            /* rewrite views of the chunks that were not used meanwhile */
+            std::unordered_map<area_chunk_t *, area_chunk_t *> moved;
+            this->lock();
+            {
+                eviction_candidates_t candidates;
+                this->fetch_access_eviction_collect(device_global_id, candidates);
+
+                for (relocation_t & relocation : relocations)
+                {
+                    if (fetch_access_defragment_unchanged(candidates, relocation))
+                    {
+                        relocation.dst->last_use.store(relocation.last_use, std::memory_order_relaxed);
+                        moved.emplace(relocation.src, relocation.dst);
+                    }
+                }
+
+                auto f = [&moved, device_global_id](NodeBase * nodebase, void * args, bool & stop) {
+                    (void) args;
+                    (void) stop;
+
+                    Node * node = reinterpret_cast<Node *>(nodebase);
+                    assert(node);
+
+                    MemoryReplica & replica = node->block.replicas[device_global_id];
+                    for (memory_allocation_view_id_t i = 0 ; i < replica.nallocations ; ++i)
+                    {
+                        MemoryReplicaAllocationView * allocation = replica.allocations[i];
+                        auto it = moved.find(allocation->chunk);
+                        if (it == moved.end())
+                            continue ;
+
+                        area_chunk_t * src = it->first;
+                        area_chunk_t * dst = it->second;
+                        allocation->view.addr = allocation->view.addr - src->ptr + dst->ptr;
+                        allocation->chunk = dst;
+                        --(src->use_counter);
+                        ++(dst->use_counter);
+                    }
+                };
+                if (!moved.empty())
+                    this->foreach_node_until(f, NULL);
+
+                for (relocation_t & relocation : relocations)
+                    area_chunk_unpin(relocation.src);
+            }
+            this->unlock();
+
+            /* release the old locations, or the new ones if aborted */
+            for (relocation_t & relocation : relocations)
+            {
+                if (moved.find(relocation.src) != moved.end())
+                {
+                    assert(relocation.src->use_counter == 0);
+                    XKRT_STATS_INCR(device->stats.memory.coherence.relocations, 1);
+                    XKRT_STATS_INCR(device->stats.memory.coherence.relocated, relocation.src->size);
+                    this->runtime->memory_device_deallocate(device_global_id, relocation.src);
+                }
+                else
+                    this->runtime->memory_device_deallocate(device_global_id, relocation.dst);
+            }
+            for (area_chunk_t * placeholder : placeholders)
+                this->runtime->memory_device_deallocate(device_global_id, placeholder);
+
+            LOGGER_DEBUG("Relocated %zu/%zu chunks", moved.size(), relocations.size());
+            return !moved.empty();
+        }
+
+        /* defragment the memory areas of the device, until one has room for
+         * an allocation of 'size' bytes - returns the index of that area, or
+         * -1 if none got defragmented */
+        inline int
+        fetch_access_allocate_defragment(
+            device_global_id_t device_global_id,
+            size_t size
+        ) {
+            device_t * device = this->runtime->device_get(device_global_id);
+            assert(device);
+            for (int area_idx = 0 ; area_idx < device->nmemories ; ++area_idx)
+                if (this->fetch_access_allocate_defragment_on(device_global_id, size, area_idx))
+                    return area_idx;
+            return -1;
+        }
+
+        /* allocate a chunk of 'size' bytes, defragmenting or evicting memory
+         * until it succeeds - must be called outside the critical section */
+        inline area_chunk_t *
+        fetch_access_allocate_reclaim(
+            device_global_id_t device_global_id,
+            const size_t size
+        ) {
+            area_chunk_t * chunk = nullptr;
+            int retry_cnt = 0;
+
+            do {
+
+                /* enough free memory, but too fragmented: relocate rather than evict */
+                const int area_idx = this->fetch_access_allocate_defragment(device_global_id, size);
+                if (area_idx >= 0)
+                {
+                    chunk = this->runtime->memory_device_allocate_on(device_global_id, size, area_idx);
+                    if (chunk)
+                        return chunk;
+                }
+
+                // TODO : polling could help releasing memory here, now that
+                // allocations are performed outside the memory-tree lock
+
+                // device_poll(device);
+                if (fetch_access_allocate_eviction(device_global_id, size) == 0 &&
+                        this->writeback_bytes[device_global_id].load(std::memory_order_relaxed) == 0)
+                {
+                    /* nothing could be evicted, last attempt */
+                    chunk = this->runtime->memory_device_allocate(device_global_id, size);
+                    if (chunk)
+                        return chunk;
+                    break ;
+                }
+
+                /* victims written back are only freed on completion */
+                chunk = this->runtime->memory_device_allocate(device_global_id, size);
+                if (chunk)
+                    return chunk;
+                this->fetch_access_eviction_writeback_wait(device_global_id);
+
+                chunk = this->runtime->memory_device_allocate(device_global_id, size);
+                if (chunk)
+                    return chunk;
+
+            } while (++retry_cnt < 32);
+
+            LOGGER_FATAL("!! GPU IS OUT OF MEMORY !!");
+
+            return nullptr;
+        }
+
+        /* allocate a chunk for the access - must be called outside the critical section */
+        inline area_chunk_t *
+        fetch_access_allocate(
+            access_t * access,
+            device_global_id_t device_global_id
+        ) {
+            //////////////////////////
+            // Allocate a new chunk //
+            //////////////////////////
+
+            const size_t size = access->host_view.m * access->host_view.n * access->host_view.sizeof_type;
+            area_chunk_t * chunk = this->runtime->memory_device_allocate(device_global_id, size);
+            if (chunk)
+                return chunk;
+
+            # if XKRT_SUPPORT_STATS
+            const uint64_t t0 = get_nanotime();
+            # endif /* XKRT_SUPPORT_STATS */
+
+            chunk = this->fetch_access_allocate_reclaim(device_global_id, size);
+
+            # if XKRT_SUPPORT_STATS
+            area_t * area = &(this->runtime->device_get(device_global_id)->memories[chunk->area_idx].area);
+            XKRT_STATS_INCR(area->stats.reclaims, 1);
+            XKRT_STATS_INCR(area->stats.reclaim_latency[area_latency_bucket(get_nanotime() - t0)], 1);
+            # endif /* XKRT_SUPPORT_STATS */
+
+            return chunk;
+        }
+
+        /* Create a view for each partite of the partition, for the newly allocated chunk */
+        inline void
+        fetch_access_create_allocation_views(
+            access_t * access,
+            device_global_id_t device_global_id,
+            Partition & partition,
+            area_chunk_t * chunk
+        ) {
+            assert(chunk);
+
+            /* allocate continuous memory for that access */
+            # pragma message(TODO "Can we manage row/col major in a better way ? hardcoded col major here for cuda")
+            // the allocation ld is expressed in the tree unit, which may
+            // differ from the access type (the tree is keyed by ld * sizeof(type))
+            const size_t     m_bytes = access->host_view.m * access->host_view.sizeof_type;
+            assert(m_bytes % this->sizeof_type == 0);
+            const size_t          ld = m_bytes / this->sizeof_type;  // cuda is col major
+            const size_t sizeof_type = this->sizeof_type;
+
+            /* retrieve upper left corner */
+            const Partite & corner = partition.get_leftmost_uppermost_block();
+
+            /* add a view */
+            for (Partite & partite : partition.partites)
+            {
+                /* compute distance from corner */
+                INTERVAL_DIFF_TYPE_T d[K];
+                Rect::distance_manhattan(corner.hyperrect, partite.hyperrect, d);
+                if (d[ACCESS_BLAS_ROW_DIM] < 0)
+                {
+                    d[ACCESS_BLAS_ROW_DIM] += this->ld * this->sizeof_type;
+                    d[ACCESS_BLAS_COL_DIM] -= 1;
+                }
+                assert(d[ACCESS_BLAS_ROW_DIM] >= 0);
+                assert(d[ACCESS_BLAS_COL_DIM] >= 0);
+
+                const uintptr_t offset = d[ACCESS_BLAS_ROW_DIM] + d[ACCESS_BLAS_COL_DIM]*ld*sizeof_type;
+                const uintptr_t begin_addr = chunk->ptr + offset;
+
+                MemoryReplica & replica = partite.block->replicas[device_global_id];
+                const memory_allocation_view_id_t allocation_view_id = replica.nallocations;
+                replica.nallocations += 1;
+                if (allocation_view_id >= MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX)
+                    LOGGER_FATAL("Too many allocations of the same data on the same device... Increase `MEMORY_REPLICATE_ALLOCATION_VIEWS_MAX` and recompile");
+
+                /* allocate the view of that block in the allocation */
+                MemoryReplicaAllocationView * r = new MemoryReplicaAllocationView(chunk, begin_addr, ld);
+                replica.allocations[allocation_view_id] = r;
+                partite.dst_allocation_view_id = allocation_view_id;
+            }
+        }
+
+        /* look for a continuous allocation that can store 'access' for the given partition */
+        inline area_chunk_t *
+        fetch_access_find_allocation_continuous(
+            device_global_id_t device_global_id,
+            Partition & partition
+        ) {
+            assert(this->is_locked_shared());
+
+            memory_allocation_view_id_t j = 0;
+            int nallocations = partition.partites[0].block->replicas[device_global_id].nallocations;
+            size_t nblocks = partition.partites.size();
+
+            /* for each allocation of the block 0 */
+            while (j < nallocations)
+            {
+                MemoryReplicaAllocationView * rj = partition.partites[0].block->replicas[device_global_id].allocations[j];
+
+                /* for each other blocks */
+                size_t i = 1;
+                while (i < nblocks)
+                {
+                    /* for each allocation of other blocks */
+                    int nallocations = partition.partites[i].block->replicas[device_global_id].nallocations;
+                    for (memory_allocation_view_id_t k = 0 ; k < nallocations ; ++k)
+                    {
+                        /* this block has a view with the same allocation, check next block */
+                        MemoryReplicaAllocationView * rk = partition.partites[i].block->replicas[device_global_id].allocations[k];
+                        if (rj->chunk == rk->chunk)
+                        {
+                            partition.partites[i].dst_allocation_view_id = k;
+                            goto next_block;
+                        }
+                    }
+
+                    /* this block has no view view the same allocation, restart from the next view of block 0 */
+                    goto next_view;
+
+next_block:
+                    ++i;
+                    continue ;
+                }
+
+                /* every blocks have a view with the allocation 'allocation' */
+                partition.partites[0].dst_allocation_view_id = j;
+                return rj->chunk;
+
+next_view:
+                ++j;
+                continue ;
+            }
+            return nullptr;
+        }
+
+        /* step (1) and (2) of the coherency protocol: ensure the access is represented in the tree, and retrieve its partition */
+        inline void
+        fetch_access_partition(
+            access_t * access,
+            Search & search
+        ) {
+            assert(this->is_locked());
+
+            /* step (1) ensure the access is represented in the tree as a partition of rects */
+            search.prepare_insert(access);
+            Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+            std::span<Rect> rects = access->rects(buffer);
+            for (Rect & rect : rects)
+                this->insert(search, rect);
+
+            /* step (2) find all rects representing the access */
+            search.partition.partites.clear();
+            search.prepare_search_partition();
+            for (const Rect & rect : rects)
+                this->intersect(search, rect);
+            assert(search.partition.partites.size() >= 1);
+        }
+
+        /**
+         *  Set 'partition.chunk' to a memory chunk and all
+         *  'partites.dst_allocation_view_id' to a view on that chunk.
+         *
+         *  If a new allocation is required, the lock is released while
+         *  allocating (which may scan free-lists and evict memory), and the
+         *  partition is searched again once the lock is re-acquired, as the
+         *  tree may have been modified concurrently.  If a concurrent fetch
+         *  published a continuous allocation for the same blocks meanwhile,
+         *  it is used instead, and the chunk allocated here is returned so
+         *  the caller releases it out of the critical section.  That
+         *  concurrent fetch marked the blocks as 'fetching', so the copies are
+         *  then deduplicated by awaiting on it.
+         */
+        inline area_chunk_t *
+        fetch_access_find_allocation(
+            access_t * access,
+            device_global_id_t device_global_id,
+            Search & search
+        ) {
+            assert(this->is_locked());
+
+            /* lookfor a continuous allocation already existing for that access block partitioning */
+            area_chunk_t * chunk = this->fetch_access_find_allocation_continuous(device_global_id, search.partition);
+            area_chunk_t * unused = nullptr;
+            if (chunk == nullptr)
+            {
+                /* no continuous allocation found, make a new one out of the critical section */
+                LOGGER_DEBUG("No continuous allocation found, reallocating and creating a new view");
+                this->unlock();
+                area_chunk_t * allocated = this->fetch_access_allocate(access, device_global_id);
+                assert(allocated);
+                this->lock();
+
+                /* publish: the partition may have changed meanwhile */
+                this->fetch_access_partition(access, search);
+                chunk = this->fetch_access_find_allocation_continuous(device_global_id, search.partition);
+                if (chunk)
+                {
+                    LOGGER_DEBUG("A concurrent fetch published an allocation meanwhile, releasing ours");
+                    unused = allocated;
+                }
+                else
+                {
+                    /* create new views */
+                    chunk = allocated;
+                    this->fetch_access_create_allocation_views(access, device_global_id, search.partition, chunk);
+                }
+            }
+
+            search.partition.chunk = chunk;
+            return unused;
+        }
+
+        inline void
+        fetch_access_setup_replicas(
+            access_t * access,
+            device_global_id_t device_global_id,
+            Search & search
+        ) {
+            assert(this->is_locked_shared());
 
             // we currently set the access view as the 'left-most' and 'upper-most' tile
             // (i.e with the smallest address - corresponding to the begining of this allocation)
@@ -1465,7 +2526,41 @@ next_view:
             const MemoryReplicaAllocationView * r = partite.block->replicas[device_global_id].allocations[partite.dst_allocation_view_id];
             assert(r);
 
-            access->device_view = r->view;
+            /* the replica ld is in the tree unit, convert it to the access type */
+            const size_t ld_bytes = r->view.ld * this->sizeof_type;
+            assert(ld_bytes % access->host_view.sizeof_type == 0);
+
+            access->device_view.addr = r->view.addr;
+            access->device_view.ld   = ld_bytes / access->host_view.sizeof_type;
+
+            /* mark the chunk as recently used, and pin it until the task completes */
+            device_t * device = this->runtime->device_get(device_global_id);
+            area_chunk_touch(&device->memories[r->chunk->area_idx].area, r->chunk);
+            if (access->task)
+            {
+                if (access->device_chunk)
+                    area_chunk_unpin(access->device_chunk);
+                area_chunk_pin(r->chunk);
+                access->device_chunk = r->chunk;
+            }
+        }
+
+        /* return true if all blocks of the partition are coherent in their allocation on the device */
+        inline bool
+        fetch_access_partition_coherent(
+            device_global_id_t device_global_id,
+            const Partition & partition
+        ) const {
+            assert(this->is_locked_shared());
+
+            for (const Partite & partite : partition.partites)
+            {
+                assert(partite.dst_allocation_view_id != MEMORY_REPLICATE_ALLOCATION_VIEW_NONE);
+                const memory_allocation_view_id_bitfield_t allocbit = (memory_allocation_view_id_bitfield_t) (1 << partite.dst_allocation_view_id);
+                if ((partite.block->replicas[device_global_id].coherency & allocbit) == 0)
+                    return false;
+            }
+            return true;
         }
 
         inline void
@@ -1522,6 +2617,7 @@ next_view:
                         /* register a task awaiting on the fetch completion */
                         __task_fetching(1, access->task);
                         dst_allocation_view->awaiting.accesses.push_back(access);
+                        partition.joined = true;
 
                         continue ;
                     }
@@ -1543,8 +2639,15 @@ next_view:
                         partite.dst_device_global_id = device_global_id;
                         partite.dst_view = dst_allocation_view->view;
 
-                        /* get a coherent source */
-                        device_global_id_t src = this->runtime->router.get_source(device_global_id, partite.block->coherency);
+                        /* get coherent sources - the router may split large copies across several of them */
+                        memory_view_t host_view;
+                        matrix_from_rect(host_view, partite.hyperrect, this->ld, this->sizeof_type);
+                        device_global_id_t srcs[XKRT_ROUTER_SPLIT_MAX];
+                        double shares[XKRT_ROUTER_SPLIT_MAX];
+                        const int nsrcs = this->runtime->router->get_sources(device_global_id, partite.block->coherency & ~(1 << HOST_DEVICE_GLOBAL_ID), host_view.size(), srcs, shares);
+                        assert(nsrcs >= 1 && nsrcs <= XKRT_ROUTER_SPLIT_MAX);
+
+                        device_global_id_t src = srcs[0];
                         assert(partite.block->coherency & (1 << src));
 
                         /* Get the first coherent allocation on that device */
@@ -1563,6 +2666,10 @@ next_view:
                         partite.src_allocation_view_id  = src_allocation_view_id;
                         partite.src_view                = src_allocation_view->view;
                         partite.src_chunk               = src_allocation_view->chunk;
+                        area_chunk_pin(partite.src_chunk);
+
+                        if (nsrcs > 1)
+                            this->fetch_splits_setup(partite, host_view, srcs, shares, nsrcs);
                     }
                     # if USE_D2D_FORWARDING
                     /* heuristic: if another device is already fetching from the host, register a forward callback instead to reduce PCI contention */
@@ -1575,7 +2682,7 @@ next_view:
                         partite.must_fetch = false;
 
                         /* one device is already fetching, add a D2D forward callback */
-                        device_global_id_t fetching_device_global_id = this->runtime->router.get_source(device_global_id, partite.block->fetching);
+                        device_global_id_t fetching_device_global_id = this->runtime->router->get_source(device_global_id, partite.block->fetching & ~(1 << HOST_DEVICE_GLOBAL_ID));
                         assert(0 <= fetching_device_global_id && fetching_device_global_id < XKRT_DEVICES_MAX);
                         assert(partite.block->fetching & (1 << fetching_device_global_id));
 
@@ -1596,6 +2703,7 @@ next_view:
                         const MemoryForward forward(access, partition.chunk, partite.hyperrect, device_global_id, dst_allocation_view->view);
                         fetching_allocation_view->awaiting.forwards.push_back(forward);
                         __task_fetching(1, access->task);
+                        partition.joined = true;
                     }
                     # endif /* USE_D2D_FORWARDING */
                     else
@@ -1630,6 +2738,76 @@ next_view:
             }
         }
 
+        /**
+         *  Split the copy of the partite across the given sources, along its
+         *  columns if possible, else along its rows, proportionally to 'shares'.
+         *  Each part has at least one column/row.  The first part uses the
+         *  partite own source, and the chunks of other sources are pinned.
+         */
+        inline void
+        fetch_splits_setup(
+            Partite & partite,
+            const memory_view_t & host_view,
+            const device_global_id_t srcs[XKRT_ROUTER_SPLIT_MAX],
+            const double shares[XKRT_ROUTER_SPLIT_MAX],
+            const int nsrcs
+        ) {
+            assert(nsrcs > 1 && nsrcs <= XKRT_ROUTER_SPLIT_MAX);
+            assert(srcs[0] == partite.src_device_global_id);
+
+            memory_fetch_splits_t & splits = partite.splits;
+            size_t extent;
+            if (host_view.n >= (size_t) nsrcs)
+            {
+                splits.dim = ACCESS_BLAS_COL_DIM;
+                extent = host_view.n;
+            }
+            else if (host_view.m >= (size_t) nsrcs)
+            {
+                splits.dim = ACCESS_BLAS_ROW_DIM;
+                extent = host_view.m;
+            }
+            else
+                return ;
+
+            double cumulated = 0.0;
+            size_t offset = 0;
+            for (int i = 0 ; i < nsrcs ; ++i)
+            {
+                /* leave at least one column/row to each remaining part */
+                cumulated += shares[i];
+                size_t end = (i == nsrcs - 1) ? extent : (size_t) (cumulated * (double) extent + 0.5);
+                end = std::max(end, offset + 1);
+                end = std::min(end, extent - (size_t) (nsrcs - 1 - i));
+
+                memory_fetch_split_t & part = splits.parts[i];
+                part.offset = offset;
+                part.length = end - offset;
+                part.src_device_global_id = srcs[i];
+                if (i == 0)
+                {
+                    part.src_view  = partite.src_view;
+                    part.src_chunk = partite.src_chunk;
+                }
+                else
+                {
+                    assert(partite.block->coherency & (1 << srcs[i]));
+                    MemoryReplica & replica = partite.block->replicas[srcs[i]];
+                    assert(replica.nallocations > 0);
+                    assert(replica.coherency);
+
+                    memory_allocation_view_id_t view_id = (memory_allocation_view_id_t) (__builtin_ffs(replica.coherency) - 1);
+                    MemoryReplicaAllocationView * view = replica.allocations[view_id];
+                    part.src_view  = view->view;
+                    part.src_chunk = view->chunk;
+                    area_chunk_pin(part.src_chunk);
+                }
+                offset = end;
+            }
+            assert(offset == extent);
+            splits.n = (uint8_t) nsrcs;
+        }
+
         inline void
         fetch_access_set_coherent(
             access_t * access,
@@ -1642,8 +2820,11 @@ next_view:
             if (access->mode & ACCESS_MODE_W)
             {
                 const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+                const uint64_t version = ++this->epoch;
                 for (Partite & partite : partition.partites)
                 {
+                    partite.block->version = version;
+
                     const memory_allocation_view_id_bitfield_t allocbit = (memory_allocation_view_id_bitfield_t) (1 << partite.dst_allocation_view_id);
 
                     /* make all replicas incoherent */
@@ -1666,6 +2847,69 @@ next_view:
             }
         }
 
+        /**
+         *  Fast path of 'fetch_list_to_device' that only takes a shared lock.
+         *  It succeeds if the access is read-only, already represented in the
+         *  tree, and coherent on the device within a single allocation: in
+         *  such case, there is no structural change nor block state to update.
+         *  Return true on success, false if the exclusive path must be taken.
+         */
+        inline bool
+        fetch_access_coherent_shared(
+            access_t * access,
+            device_global_id_t device_global_id
+        ) {
+            if (access->mode != ACCESS_MODE_R)
+                return false;
+
+            Search search(device_global_id);
+            bool coherent = false;
+
+            this->lock_shared();
+            {
+                search.prepare_search_coherent();
+                Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+                std::span<const Rect> rects = access->rects(buffer);
+                for (const Rect & rect : rects)
+                    this->intersect(search, rect);
+
+                if (search.coherent && search.partition.partites.size())
+                {
+                    /* blocks must exactly cover the access, else some of it
+                     * was never inserted */
+                    size_t access_size = 0;
+                    for (const Rect & rect : rects)
+                        if (!rect.is_empty())
+                            access_size += rect.size();
+
+                    size_t blocks_size = 0;
+                    for (const Partite & partite : search.partition.partites)
+                        blocks_size += partite.hyperrect.size();
+
+                    /* look for a continuous allocation coherent on all blocks */
+                    if (blocks_size == access_size && this->fetch_access_find_allocation_continuous(device_global_id, search.partition))
+                    {
+                        coherent = true;
+                        for (const Partite & partite : search.partition.partites)
+                        {
+                            const memory_allocation_view_id_bitfield_t allocbit = (memory_allocation_view_id_bitfield_t) (1 << partite.dst_allocation_view_id);
+                            if ((partite.block->replicas[device_global_id].coherency & allocbit) == 0)
+                            {
+                                coherent = false;
+                                break ;
+                            }
+                        }
+
+                        if (coherent)
+                            this->fetch_access_setup_replicas(access, device_global_id, search);
+                    }
+                }
+            }
+            this->unlock_shared();
+
+            return coherent;
+        }
+
         /* launch a single fetch */
         inline void
         fetch_list_launch_ith(
@@ -1697,6 +2941,16 @@ next_view:
             assert(fetch->src_device_global_id != HOST_DEVICE_GLOBAL_ID || fetch->dst_device_global_id != HOST_DEVICE_GLOBAL_ID);
             device_global_id_t device_global_id = (fetch->dst_device_global_id != HOST_DEVICE_GLOBAL_ID) ? fetch->dst_device_global_id : fetch->src_device_global_id;
 
+            /* the copy is split across several sources */
+            if (fetch->splits.n > 1)
+            {
+                this->fetch_splits_launch(access, fetch, device_global_id, callback);
+                return ;
+            }
+
+            /* the link is busy until the callback */
+            this->runtime->router->transfer_begin(fetch->src_device_global_id, fetch->dst_device_global_id);
+
             /* launch asynchronous copy */
             if (access->type == ACCESS_TYPE_SEGMENT)
             {
@@ -1726,6 +2980,100 @@ next_view:
             }
         }
 
+        /* called once a part of a split copy completed, the last part completes the fetch */
+        static void
+        fetch_splits_callback(void * args[XKRT_CALLBACK_ARGS_MAX])
+        {
+            assert(XKRT_CALLBACK_ARGS_MAX >= 5);
+
+            runtime_t * runtime = (runtime_t *) args[0];
+            fetch_list_t * list = (fetch_list_t *) args[2];
+            fetch_t * fetch = list->fetches + (size_t) args[3];
+            const size_t i = (size_t) args[4];
+            assert(i < fetch->splits.n);
+
+            /* the first part is released with the fetch itself */
+            if (i > 0)
+            {
+                const memory_fetch_split_t & part = fetch->splits.parts[i];
+                runtime->router->transfer_end(part.src_device_global_id, fetch->dst_device_global_id);
+                area_chunk_unpin(part.src_chunk);
+            }
+
+            if (fetch->splits_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                fetch_callback(args);
+        }
+
+        /* launch each part of a split copy */
+        inline void
+        fetch_splits_launch(
+            access_t * access,
+            fetch_t * fetch,
+            device_global_id_t device_global_id,
+            const callback_t & fetched
+        ) {
+            const memory_fetch_splits_t & splits = fetch->splits;
+            assert(splits.n > 1);
+            fetch->splits_pending.store(splits.n, std::memory_order_relaxed);
+
+            const size_t sizeof_type = fetch->host_view.sizeof_type;
+            for (size_t i = 0 ; i < splits.n ; ++i)
+            {
+                const memory_fetch_split_t & part = splits.parts[i];
+
+                /* columns are 'ld' elements appart, rows are continuous */
+                memory_view_t host_view = fetch->host_view;
+                memory_replica_view_t dst_view = fetch->dst_view;
+                memory_replica_view_t src_view = part.src_view;
+                if (splits.dim == ACCESS_BLAS_COL_DIM)
+                {
+                    host_view.addr  = fetch->host_view.offset_addr(0, part.offset);
+                    host_view.n     = part.length;
+                    dst_view.addr  += part.offset * dst_view.ld * sizeof_type;
+                    src_view.addr  += part.offset * src_view.ld * sizeof_type;
+                }
+                else
+                {
+                    host_view.addr  = fetch->host_view.offset_addr(part.offset, 0);
+                    host_view.m     = part.length;
+                    dst_view.addr  += part.offset * sizeof_type;
+                    src_view.addr  += part.offset * sizeof_type;
+                }
+
+                callback_t callback = fetched;
+                callback.func = fetch_splits_callback;
+                callback.args[4] = (void *) i;
+
+                this->runtime->router->transfer_begin(part.src_device_global_id, fetch->dst_device_global_id);
+                if (access->type == ACCESS_TYPE_SEGMENT)
+                {
+                    assert(host_view.n == 1);
+                    assert(host_view.sizeof_type == 1);
+                    this->runtime->copy(
+                        device_global_id,
+                        (size_t) host_view.m,
+                        fetch->dst_device_global_id,
+                        (uintptr_t) dst_view.addr,
+                        part.src_device_global_id,
+                        (uintptr_t) src_view.addr,
+                        callback
+                    );
+                }
+                else
+                {
+                    this->runtime->copy(
+                        device_global_id,
+                        host_view,
+                        fetch->dst_device_global_id,
+                        dst_view,
+                        part.src_device_global_id,
+                        src_view,
+                        callback
+                    );
+                }
+            }
+        }
+
         inline void
         fetch_list_launch(
             access_t * access,
@@ -1744,9 +3092,20 @@ next_view:
             assert(access->type == ACCESS_TYPE_SEGMENT ||
                     access->type == ACCESS_TYPE_BLAS_MATRIX);
 
+            /* fast path: access already coherent on the device */
+            if (!only_allocates && this->fetch_access_coherent_shared(access, device_global_id))
+            {
+                XKRT_STATS_INCR(this->runtime->device_get(device_global_id)->stats.memory.coherence.hits, 1);
+                return NULL;
+            }
+
             // run the coherency protocol
             Search search(device_global_id);
             fetch_list_t * list = NULL;
+            area_chunk_t * unused;
+            # if XKRT_SUPPORT_STATS
+            bool overwrite = false;
+            # endif /* XKRT_SUPPORT_STATS */
 
             this->lock();
             {
@@ -1764,19 +3123,12 @@ next_view:
                 );
                 # endif
 
-                /* step (1) ensure the access is represented in the tree as a partition of rects */
-                search.prepare_insert(access);
-                for (Rect & rect : access->rects())
-                    this->insert(search, rect);
-
-                /* step (2) find all rects representing the access */
-                search.prepare_search_partition();
-                for (const Rect & rect : access->rects())
-                    this->intersect(search, rect);
-                assert(search.partition.partites.size() >= 1);
+                /* step (1) and (2) retrieve the partition of the access */
+                this->fetch_access_partition(access, search);
 
-                /* step (3) find or allocate a contiguous memory view for that access on that device */
-                this->fetch_access_find_allocation(access, device_global_id, search.partition);
+                /* step (3) find or allocate a contiguous memory view for that
+                 * access on that device - this may temporarily release the lock */
+                unused = this->fetch_access_find_allocation(access, device_global_id, search);
 
                 /* step (4) set the access view on the device (that will be used by the kernel) */
                 this->fetch_access_setup_replicas(access, device_global_id, search);
@@ -1786,6 +3138,12 @@ next_view:
                     /* step (5) if read access, find src/dst, and setup views to transfer on step (7) */
                     this->fetch_access_setup_copies(access, device_global_id, search.partition);
 
+                    # if XKRT_SUPPORT_STATS
+                    /* accesses only written need no transfer, but are no hits unless already coherent */
+                    if (!(access->mode & ACCESS_MODE_R))
+                        overwrite = !this->fetch_access_partition_coherent(device_global_id, search.partition);
+                    # endif /* XKRT_SUPPORT_STATS */
+
                     /* step (6) if write access, make all other replicas incoherent */
                     this->fetch_access_set_coherent(access, device_global_id, search.partition);
                 }
@@ -1793,22 +3151,40 @@ next_view:
             } /* this->lock(); */
             this->unlock();
 
+            /* release the allocation that lost against a concurrent fetch */
+            if (unused)
+                this->runtime->memory_device_deallocate(device_global_id, unused);
+
             /* step (7) - convert a partition to the minimum number of fetches to run */
             if (!only_allocates)
+            {
                 if (access->mode & ACCESS_MODE_R)
                     list = this->fetch_list_from_partition(search.partition);
 
+                # if XKRT_SUPPORT_STATS
+                device_t * device = this->runtime->device_get(device_global_id);
+                if (list)
+                    XKRT_STATS_INCR(device->stats.memory.coherence.misses, 1);
+                else if (search.partition.joined)
+                    XKRT_STATS_INCR(device->stats.memory.coherence.joined, 1);
+                else if (overwrite)
+                    XKRT_STATS_INCR(device->stats.memory.coherence.overwrites, 1);
+                else
+                    XKRT_STATS_INCR(device->stats.memory.coherence.hits, 1);
+                # endif /* XKRT_SUPPORT_STATS */
+            }
+
             return list;
         }
 
         /** Fetch the access on the given device */
-        void
+        bool
         fetch(
             access_t * access,
             device_global_id_t device_global_id
         ) {
             if (access->state == ACCESS_STATE_FETCHING || access->state == ACCESS_STATE_FETCHED)
-                return ;
+                return false;
 
             assert(access->state == ACCESS_STATE_INIT);
             access->state = ACCESS_STATE_FETCHING;
@@ -1841,7 +3217,7 @@ next_view:
                 access->device_view.addr = access->host_view.begin_addr();
                 access->device_view.ld   = access->host_view.ld;
                 access->state            = ACCESS_STATE_FETCHED;
-                return ;
+                return true;
             }
 
             fetch_list_t * list;
@@ -1871,6 +3247,8 @@ next_view:
                 __task_fetching(list->pending, access->task);
                 this->fetch_list_launch(access, list);
             }
+
+            return true;
         }
 
         ////////////////////////
@@ -1906,13 +3284,14 @@ next_view:
             // find how much bytes are owned per device
             Search search;
             search.prepare_search_owners();
-            this->lock();
+            this->lock_shared();
             {
-                for (const Rect & rect : access->rects())
+                Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+                for (const Rect & rect : access->rects(buffer))
                     if (!rect.is_empty())
                         this->intersect(search, rect);
             }
-            this->unlock();
+            this->unlock_shared();
 
             // find devices which owns the most bytes
             device_global_id_bitfield_t owners = 0;
@@ -2033,6 +3412,10 @@ next_view:
 
             // TODO : can we fasten intersection by keeping track of an included 'coherency' bitmask ?
 
+            /* already know the access is not coherent */
+            if (search.type == Search::Type::SEARCH_COHERENT && !search.coherent)
+                return true;
+
             return false;
         }
 
@@ -2066,6 +3449,8 @@ next_view:
                  * allocation */
                 case (Search::Type::SEARCH_FETCHED):
                 {
+                    assert(this->is_locked());
+
                     const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << search.device_global_id);
                     MemoryReplica & replica = node->block.replicas[search.device_global_id];
 
@@ -2093,7 +3478,10 @@ next_view:
                                 );
                                 allocation_view->awaiting.accesses.clear();
 
-                                /* move awaiting forwards */
+                                /* move awaiting forwards - the fetched chunk is their
+                                 * source, pin it until they complete */
+                                for (size_t i = 0 ; i < allocation_view->awaiting.forwards.size() ; ++i)
+                                    area_chunk_pin(search.chunk);
                                 search.awaiting.forwards.insert(
                                     search.awaiting.forwards.end(),
                                     allocation_view->awaiting.forwards.begin(),
@@ -2118,14 +3506,31 @@ next_view:
                         assert(replica.coherency);
                     }
 
-                    /* set device bits */
-                    node->block.coherency |= devbit;
+                    /* set device bits - a block written meanwhile is no longer
+                     * coherent with the copy that just completed */
+                    if (node->block.version <= search.epoch)
+                        node->block.coherency |= devbit;
                     if (replica.fetching == 0)
                         node->block.fetching &= ~devbit;
 
                     break ;
                 }
 
+                /* search for blocks of an access that must be coherent on the device */
+                case (Search::Type::SEARCH_COHERENT):
+                {
+                    const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << search.device_global_id);
+                    if (!search.coherent)
+                        break ;
+                    if (!h.includes(node->hyperrect) || (node->block.coherency & devbit) == 0)
+                    {
+                        search.coherent = false;
+                        break ;
+                    }
+                    search.partition.partites.push_back(Partite(&(node->block), node->hyperrect));
+                    break ;
+                }
+
                 /* search for owners of the access */
                 case (Search::Type::SEARCH_OWNERS):
                 {
@@ -76,8 +76,12 @@ class MemoryCoherencyController {
         /** all replicates must be invalidated */
         virtual void invalidate(void) = 0;
 
-        /* fetch the given access on the given device */
-        virtual void fetch(access_t * access, device_global_id_t device_global_id) = 0;
+        /* fetch the given access on the given device, returns false if the
+         * access was already fetching or fetched */
+        virtual bool fetch(access_t * access, device_global_id_t device_global_id) = 0;
+
+        /* allocate the given access on the given device, without fetching it */
+        virtual void allocate_to_device(access_t * access, device_global_id_t device_global_id) = 0;
 
 };
 
@@ -0,0 +1,131 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+#ifndef __DEPENDENCY_NODE_HPP__
+# define __DEPENDENCY_NODE_HPP__
+
+# include <xkrt/namespace.h>
+# include <xkrt/memory/access/access.hpp>
+# include <xkrt/task/task.hpp>
+
+# include <vector>
+
+XKRT_NAMESPACE_BEGIN
+
+/**
+ *  Dependencies of the accesses to a node of a dependency tree, that holds
+ *  'last_write', 'last_reads', 'last_reduces' and 'reducing'.
+ *
+ *  Reduces of the same reduction are concurrent between each others: they
+ *  are preceded as writes are, and precede any other access, as a write.
+ *  For instance, with the accesses W0 R1 R2 D3 D4 R5 R6 W7 where D3 and D4
+ *  reduce the same data: R1 and R2 depend on W0, D3 and D4 on R1 and R2,
+ *  R5 and R6 on D3 and D4, and W7 on R5 and R6.
+ */
+
+/* set edges from the accesses of the node that precede 'access' */
+template <typename Node>
+static inline void
+dependency_node_link(Node * node, access_t * access)
+{
+    const bool same_reduction = (access->mode & ACCESS_MODE_P) &&
+        (node->last_reduces.empty() || node->last_reduces[0]->reduction == access->reduction);
+
+    // reduces in progress precede any other access
+    if (node->reducing && !same_reduction && node->last_reduces.size())
+    {
+        for (access_t * pred : node->last_reduces)
+            __access_precedes(pred, access);
+    }
+    // reads since the last write precede writes and reduces
+    else if ((access->mode & ACCESS_MODE_W) && node->last_reads.size())
+    {
+        for (access_t * pred : node->last_reads)
+            __access_precedes(pred, access);
+    }
+    // complete reduces precede reads, as the last write would
+    else if (!node->reducing && node->last_reduces.size())
+    {
+        for (access_t * pred : node->last_reduces)
+            __access_precedes(pred, access);
+    }
+    else if (node->last_write)
+        __access_precedes(node->last_write, access);
+}
+
+/* insert 'access' in the node, for future accesses to depend on it */
+template <typename Node>
+static inline void
+dependency_node_put(Node * node, access_t * access)
+{
+    if (access->mode & ACCESS_MODE_P)
+    {
+        // the first reduce, its predecessors are kept for the next ones
+        if (!node->reducing)
+        {
+            node->last_reduces.clear();
+            node->reducing = true;
+        }
+        // a reduce of another reduction: the current ones precede it and the next ones
+        else if (node->last_reduces.size() && node->last_reduces[0]->reduction != access->reduction)
+        {
+            node->last_reads.swap(node->last_reduces);
+            node->last_reduces.clear();
+        }
+        node->last_reduces.push_back(access);
+    }
+    else if (access->mode & ACCESS_MODE_W)
+    {
+        node->last_reads.clear();
+        node->last_reduces.clear();
+        node->reducing = false;
+        node->last_write = access;
+    }
+    else if (access->mode == ACCESS_MODE_R)
+    {
+        // the first read after reduces, they are complete
+        if (node->reducing)
+        {
+            node->last_reads.clear();
+            node->reducing = false;
+        }
+        node->last_reads.push_back(access);
+    }
+}
+
+XKRT_NAMESPACE_END
+
+#endif /* __DEPENDENCY_NODE_HPP__ */
@@ -59,6 +59,9 @@ class DependencyDomain
         // insert access so future accesses intersection
         virtual void put(access_t * access) = 0;
 
+        // forget accesses of completed tasks, so they may be reclaimed
+        virtual void gc(void) = 0;
+
     public:
 
         template<task_access_counter_t AC>
@@ -129,6 +129,9 @@ class DependencyMap : public DependencyDomain
             if (dep->wc.fetch_sub(1, std::memory_order_seq_cst) == 1)
             {
                 // all predecessors completed already, we can skip that empty node
+                (accesses + 0)->~access_t();
+                extra->state.value = TASK_STATE_DEALLOCATED;
+                thread_t::deallocate_task(extra);
             }
             else
             {
@@ -281,6 +284,25 @@ class DependencyMap : public DependencyDomain
             }
         }
 
+        void
+        gc(void)
+        {
+            for (auto it = map.begin() ; it != map.end() ; )
+            {
+                Node & node = it->second;
+                std::erase_if(node.last_conc_writes, __access_completed);
+                std::erase_if(node.last_seq_reads,   __access_completed);
+                if (node.last_seq_write && __access_completed(node.last_seq_write))
+                    node.last_seq_write = NULL;
+
+                // no more accesses on that handle
+                if (node.last_conc_writes.empty() && node.last_seq_reads.empty() && node.last_seq_write == NULL)
+                    it = map.erase(it);
+                else
+                    ++it;
+            }
+        }
+
         inline void
         put(access_t * access)
         {
@@ -37,6 +37,7 @@
 #ifndef __INTERVAL_DEPENDENCY_TREE_HPP__
 # define __INTERVAL_DEPENDENCY_TREE_HPP__
 
+# include <xkrt/memory/access/common/dependency-node.hpp>
 # include <xkrt/memory/access/common/khp-tree.hpp>
 # include <xkrt/memory/access/dependency-domain.hpp>
 # include <xkrt/task/task.hpp>
@@ -63,6 +64,9 @@ class IntervalDependencyTreeSearch
         // USED IF TYPE == SEARCH_TYPE_RESOLVE or type == SEARCH_TYPE_CONFLICTING
         access_t * access;
 
+        // the access segment, widened to the tree granularity
+        Segment segment;
+
         // USED IF TYPE == SEARCH_TYPE_CONFLICTING
         std::vector<void *> * conflicts;
 
@@ -73,20 +77,25 @@ class IntervalDependencyTreeSearch
     public:
 
         void
-        prepare_resolve(access_t * access)
-        {
+        prepare_resolve(
+            access_t * access,
+            const Segment & segment
+        ) {
             this->type = SEARCH_TYPE_RESOLVE;
             this->access = access;
+            this->segment.copy(segment);
         }
 
         void
         prepare_conflicting(
             std::vector<void *> * conflicts,
-            access_t * access
+            access_t * access,
+            const Segment & segment
         ) {
             this->type = SEARCH_TYPE_CONFLICTING;
             this->conflicts = conflicts;
             this->access = access;
+            this->segment.copy(segment);
         }
 
 } /* class IntervalDependencyTreeSearch */;
@@ -106,7 +115,15 @@ class IntervalDependencyTreeNode : public KHPTree<K, IntervalDependencyTreeSearc
         /* last access that wrote */
         access_t * last_write;
 
-        /* number of writes in all subtrees */
+        /* last accesses that reduce, concurrently between each others */
+        std::vector<access_t *> last_reduces;
+
+        /* true while 'last_reduces' may still grow: the reduces are then
+         * preceded by 'last_reads', or 'last_write' if there is none.
+         * Else, the reduces are complete and precede 'last_reads' */
+        bool reducing;
+
+        /* number of writes (or reduces) in all subtrees */
         int nwrites;
 
     public:
@@ -119,6 +136,8 @@ class IntervalDependencyTreeNode : public KHPTree<K, IntervalDependencyTreeSearc
             Base(h, k, color),
             last_reads(),
             last_write(),
+            last_reduces(),
+            reducing(false),
             nwrites(0)
         {}
 
@@ -132,6 +151,8 @@ class IntervalDependencyTreeNode : public KHPTree<K, IntervalDependencyTreeSearc
             Base(h, k, color),
             last_reads(),
             last_write(),
+            last_reduces(),
+            reducing(false),
             nwrites(0)
         {
             this->last_write = inherit->last_write;
@@ -140,6 +161,12 @@ class IntervalDependencyTreeNode : public KHPTree<K, IntervalDependencyTreeSearc
                 inherit->last_reads.begin(),
                 inherit->last_reads.end()
             );
+            this->last_reduces.insert(
+                this->last_reduces.end(),
+                inherit->last_reduces.begin(),
+                inherit->last_reduces.end()
+            );
+            this->reducing = inherit->reducing;
         }
 
         ////////////
@@ -148,7 +175,7 @@ class IntervalDependencyTreeNode : public KHPTree<K, IntervalDependencyTreeSearc
         inline void
         update_includes_nwrites(void)
         {
-            this->nwrites = this->last_write ? 1 : 0;
+            this->nwrites = (this->last_write || this->last_reduces.size()) ? 1 : 0;
             FOREACH_CHILD_BEGIN(this, child, k, dir)
             {
                 this->nwrites += child->nwrites;
@@ -198,14 +225,35 @@ class IntervalDependencyTree : public KHPTree<K, IntervalDependencyTreeSearch>,
         /* accesses submitted to the interval tree */
         std::list<access_t *> accesses;
 
+        /* accesses are widened to multiples of that many bytes (a power of
+         * 2), so accesses sharing a coherency page depend on each others */
+        const uintptr_t granularity;
+
     public:
 
         /* alignment is ld.sizeof_type */
-        IntervalDependencyTree() : Base(), accesses() {}
+        IntervalDependencyTree(const uintptr_t granularity = 1) :
+            Base(),
+            accesses(),
+            granularity(granularity)
+        {
+            assert(granularity && (granularity & (granularity - 1)) == 0);
+        }
+
         ~IntervalDependencyTree() {}
 
     public:
 
+        /* the segment used to resolve dependencies of the access */
+        inline Segment
+        region(const access_t * access) const
+        {
+            Segment segment(access->region.interval.segment);
+            segment[0].a = segment[0].a & ~(this->granularity - 1);
+            segment[0].b = (segment[0].b + this->granularity - 1) & ~(this->granularity - 1);
+            return segment;
+        }
+
         inline void
         conflicting(
             std::vector<void *> * conflicts,
@@ -215,9 +263,9 @@ class IntervalDependencyTree : public KHPTree<K, IntervalDependencyTreeSearch>,
             assert((access->mode & ACCESS_MODE_R) && !(access->mode & ACCESS_MODE_W));
 
             Search search;
-            search.prepare_conflicting(conflicts, access);
+            search.prepare_conflicting(conflicts, access, this->region(access));
 
-            Base::intersect(search, access->region.interval.segment);
+            Base::intersect(search, search.segment);
         }
 
         //////////////
@@ -234,16 +282,8 @@ class IntervalDependencyTree : public KHPTree<K, IntervalDependencyTreeSearch>,
             Node * node = reinterpret_cast<Node *>(nodebase);
             assert(node);
 
-            if (search.access->region.interval.segment.intersects(node->hyperrect))
-            {
-                if (search.access->mode & ACCESS_MODE_W)
-                {
-                    node->last_reads.clear();
-                    node->last_write = search.access;
-                }
-                else if (search.access->mode == ACCESS_MODE_R)
-                    node->last_reads.push_back(search.access);
-            }
+            if (search.segment.intersects(node->hyperrect))
+                dependency_node_put(node, search.access);
         }
 
         inline void
@@ -314,18 +354,13 @@ class IntervalDependencyTree : public KHPTree<K, IntervalDependencyTreeSearch>,
             {
                 case (Search::Type::SEARCH_TYPE_RESOLVE):
                 {
-                    if ((search.access->mode & ACCESS_MODE_W) && node->last_reads.size())
-                        for (access_t * pred : node->last_reads)
-                            __access_precedes(pred, search.access);
-                    else if (node->last_write)
-                        __access_precedes(node->last_write, search.access);
-
+                    dependency_node_link(node, search.access);
                     break ;
                 }
 
                 case (Search::Type::SEARCH_TYPE_CONFLICTING):
                 {
-                    if (node->last_write)
+                    if (node->last_write || node->last_reduces.size())
                     {
                         assert(search.conflicts);
                         search.conflicts->push_back(node);
@@ -342,20 +377,49 @@ class IntervalDependencyTree : public KHPTree<K, IntervalDependencyTreeSearch>,
             }
         }
 
+        ////////
+        // GC //
+        ////////
+
+        /* forget completed accesses of the subtree - completed writers are
+         * replaced rather than removed, to keep track of written regions */
+        inline void
+        gc(Node * node)
+        {
+            FOREACH_CHILD_BEGIN(node, child, k, dir)
+            {
+                this->gc(child);
+            }
+            FOREACH_CHILD_END(node, child, k, dir);
+
+            std::erase_if(node->last_reads, __access_completed);
+            std::erase_if(node->last_reduces, __access_completed);
+            if (node->last_write && __access_completed(node->last_write))
+                node->last_write = task_reclaimed_access();
+        }
+
+        void
+        gc(void)
+        {
+            if (this->root)
+                this->gc(reinterpret_cast<Node *>(this->root));
+            this->accesses.remove_if(__access_completed);
+        }
+
         void
         link(access_t * access)
         {
             Search search;
-            search.prepare_resolve(access);
-            Base::intersect(search, access->region.interval.segment);
+            search.prepare_resolve(access, this->region(access));
+            Base::intersect(search, search.segment);
         }
 
         void
         put(access_t * access)
         {
             Search search;
-            search.prepare_resolve(access);
-            Base::insert(search, access->region.interval.segment);
+            search.prepare_resolve(access, this->region(access));
+            Base::insert(search, search.segment);
 
             this->accesses.push_front(access);
         }
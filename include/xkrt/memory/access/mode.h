@@ -46,6 +46,7 @@
 //  out|inout     = (ACCESS_MODE_W, ACCESS_CONCURRENCY_SEQUENTIAL)
 //  mutexinoutset = (ACCESS_MODE_W, ACCESS_CONCURRENCY_COMMUTATIVE)
 //       inoutset = (ACCESS_MODE_W, ACCESS_CONCURRENCY_CONCURRENT)
+//   in_reduction = (ACCESS_MODE_REDUCE, ACCESS_CONCURRENCY_SEQUENTIAL)
 //
 // scope is sort of always 'ACCESS_SCOPE_UNIFIED' as we cannot specify
 // dependency domains in 6.0
@@ -63,6 +64,11 @@ typedef enum    xkrt_access_mode_t
                                         // dependencies on task completion: the
                                         // task is responsible of fulfillment
                                         // the access itself
+    ACCESS_MODE_P       = 0b00010000,   // private access = the task accesses a
+                                        // zero-initialized copy private to its
+                                        // thread, that is combined into the
+                                        // data before any other access
+    ACCESS_MODE_REDUCE  = ACCESS_MODE_RW | ACCESS_MODE_P,   // reduction
 }               xkrt_access_mode_t;
 
 static inline const char *
@@ -74,6 +80,7 @@ xkrt_access_mode_to_str(xkrt_access_mode_t mode)
         case (ACCESS_MODE_R):     return "ACCESS_MODE_R";
         case (ACCESS_MODE_W):     return "ACCESS_MODE_W";
         case (ACCESS_MODE_RW):    return "ACCESS_MODE_RW";
+        case (ACCESS_MODE_REDUCE):return "ACCESS_MODE_REDUCE";
         default:                  return "ACCESS_MODE_UNKN";
     }
 }
@@ -0,0 +1,1003 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+#ifndef __PAGED_MEMORY_MAP_HPP__
+# define __PAGED_MEMORY_MAP_HPP__
+
+# include <xkrt/support.h>
+# include <xkrt/internals.h>
+# include <xkrt/logger/logger.h>
+# include <xkrt/memory/access/coherency-controller.hpp>
+# include <xkrt/memory/area.h>
+# include <xkrt/runtime.h>
+# include <xkrt/sync/lockable.hpp>
+# include <xkrt/task/task.hpp>
+
+# include <algorithm>
+# include <atomic>
+# include <unordered_map>
+# include <utility>
+# include <vector>
+
+XKRT_NAMESPACE_BEGIN
+
+/* the replica of a page on a device */
+typedef struct  memory_page_replica_t
+{
+    uintptr_t addr;         /* address of the page on the device */
+    area_chunk_t * chunk;   /* allocation holding the page, NULL on the host */
+    bool fetching;          /* a copy to that replica is in-flight */
+
+}               memory_page_replica_t;
+
+/* an access awaiting for a page being fetched to a replica */
+typedef struct  memory_page_awaiting_t
+{
+    access_t * access;
+    device_global_id_t device_global_id;
+    area_chunk_t * chunk;   /* allocation of the replica being fetched */
+
+}               memory_page_awaiting_t;
+
+/* coherency state of a page */
+typedef struct  memory_page_t
+{
+    device_global_id_bitfield_t valid;              /* devices holding a valid replica */
+    std::vector<memory_page_awaiting_t> awaiting;   /* accesses awaiting for a replica */
+    uint64_t version;                               /* map epoch of the last write access */
+
+}               memory_page_t;
+
+/**
+ *  A memory coherency controller for 'point' accesses, that tracks validity
+ *  and allocations per fixed-size page rather than per interval.
+ *      - pages are keyed by their number (address / page size) in hash
+ *        tables: one for the coherency state, and one per device for the
+ *        replicas, so looking up a page is O(1)
+ *      - accesses are fetched by whole pages, allocated contiguously on the
+ *        device, and consecutive pages fetched from the same source are
+ *        coalesced into a single copy
+ *
+ *  Pages are the unit of coherency: bytes of a page outside of any access
+ *  move with it, so host memory sharing a page with an access must not be
+ *  written concurrently.  The runtime resolves dependencies of segment
+ *  accesses at the page granularity (see 'task_dependency_granularity'), so
+ *  tasks accessing disjoint bytes of a same page are serialized.
+ *
+ *  When the device is out of memory, replicas are evicted by allocation,
+ *  least recently used first.  Pages whose sole valid replica is being
+ *  evicted are written back to the host first.
+ *
+ *  Concurrency: the map is protected by a spinlock, released while
+ *  allocating device memory and launching copies.
+ */
+class PagedMemoryMap : public Lockable, public MemoryCoherencyController {
+
+    public:
+
+        /* a copy of consecutive pages from a single source */
+        typedef struct  copy_t
+        {
+            PagedMemoryMap * map;
+            access_t * access;
+            uintptr_t page;                             /* first page */
+            size_t npages;                              /* number of pages */
+            device_global_id_t src_device_global_id;
+            uintptr_t src_addr;
+            area_chunk_t * src_chunk;
+            device_global_id_t dst_device_global_id;
+            uintptr_t dst_addr;
+            area_chunk_t * dst_chunk;
+            uint64_t epoch;                             /* map epoch when a write-back was launched */
+
+        }               copy_t;
+
+        using replicas_t = std::unordered_map<uintptr_t, memory_page_replica_t>;
+        using released_t = std::vector<std::pair<device_global_id_t, area_chunk_t *>>;
+
+    public:
+
+        PagedMemoryMap(
+            runtime_t * runtime,
+            const size_t page_size
+        ) :
+            Lockable(),
+            MemoryCoherencyController(),
+            runtime(runtime),
+            page_size(page_size),
+            page_shift(__builtin_ctzll(page_size)),
+            pages(),
+            replicas(),
+            released(),
+            epoch(0),
+            writeback_pages()
+        {
+            assert(page_size && (page_size & (page_size - 1)) == 0);
+        }
+
+        ~PagedMemoryMap() {}
+
+        /* the runtime so the map can allocate memory and launch data movements */
+        runtime_t * runtime;
+
+        /* size of a page in bytes, a power of 2 */
+        const size_t page_size;
+        const int page_shift;
+
+        /* coherency state of each page accessed */
+        std::unordered_map<uintptr_t, memory_page_t> pages;
+
+        /* replicas of each page, per device */
+        replicas_t replicas[XKRT_DEVICES_MAX];
+
+        /* allocations that hold no pages anymore, deallocated once unpinned */
+        released_t released;
+
+        /* incremented on each write access, to detect pages written after a
+         * write-back was launched */
+        uint64_t epoch;
+
+        /* number of pages being written back to the host, per device */
+        std::atomic<size_t> writeback_pages[XKRT_DEVICES_MAX];
+
+    public:
+
+        inline uintptr_t
+        page_of(const uintptr_t addr) const
+        {
+            return addr >> this->page_shift;
+        }
+
+        inline uintptr_t
+        page_addr(const uintptr_t page) const
+        {
+            return page << this->page_shift;
+        }
+
+        /* number of pages accessed so far */
+        inline size_t
+        npages(void) const
+        {
+            return this->pages.size();
+        }
+
+    private:
+
+        /* the coherency state of a page, valid on the host if never accessed */
+        inline memory_page_t &
+        page_get(const uintptr_t page)
+        {
+            auto [it, inserted] = this->pages.try_emplace(page);
+            if (inserted)
+                it->second.valid = (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID);
+            return it->second;
+        }
+
+        /* host replicas are the pages themselves */
+        inline void
+        replicas_map_host(
+            const uintptr_t first,
+            const size_t n
+        ) {
+            replicas_t & replicas = this->replicas[HOST_DEVICE_GLOBAL_ID];
+            for (size_t i = 0 ; i < n ; ++i)
+            {
+                auto [it, inserted] = replicas.try_emplace(first + i);
+                if (inserted)
+                {
+                    it->second.addr     = this->page_addr(first + i);
+                    it->second.chunk    = NULL;
+                    it->second.fetching = false;
+                }
+            }
+        }
+
+        /* return true if the 'n' pages from 'first' are allocated contiguously
+         * on the device, and retrieve the replica of the first page */
+        inline bool
+        replicas_contiguous(
+            const device_global_id_t device_global_id,
+            const uintptr_t first,
+            const size_t n,
+            memory_page_replica_t * replica
+        ) const {
+            const replicas_t & replicas = this->replicas[device_global_id];
+
+            auto it = replicas.find(first);
+            if (it == replicas.end())
+                return false;
+
+            const memory_page_replica_t & r0 = it->second;
+            for (size_t i = 1 ; i < n ; ++i)
+            {
+                auto jt = replicas.find(first + i);
+                if (jt == replicas.end()                    ||
+                    jt->second.chunk != r0.chunk            ||
+                    jt->second.addr  != r0.addr + i * this->page_size)
+                    return false;
+            }
+
+            *replica = r0;
+            return true;
+        }
+
+        /* map the 'n' pages from 'first' to the given allocation.  Previous
+         * replicas that were valid are saved in 'remapped', so the pages are
+         * copied from there */
+        inline void
+        replicas_map(
+            const device_global_id_t device_global_id,
+            const uintptr_t first,
+            const size_t n,
+            area_chunk_t * chunk,
+            replicas_t & remapped
+        ) {
+            const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+            replicas_t & replicas = this->replicas[device_global_id];
+
+            for (size_t i = 0 ; i < n ; ++i)
+            {
+                const uintptr_t page = first + i;
+                memory_page_replica_t & r = replicas[page];
+                if (r.chunk)
+                {
+                    memory_page_t & p = this->page_get(page);
+                    if (p.valid & devbit)
+                    {
+                        remapped[page] = r;
+                        p.valid &= (device_global_id_bitfield_t) ~devbit;
+                    }
+                    if (--(r.chunk->use_counter) == 0)
+                        this->released.push_back(std::make_pair(device_global_id, r.chunk));
+                }
+                r.addr      = chunk->ptr + i * this->page_size;
+                r.chunk     = chunk;
+                r.fetching  = false;
+                ++(chunk->use_counter);
+            }
+        }
+
+        /* move the released allocations that are not pinned anymore to
+         * 'victims' - must be called within the critical section */
+        inline void
+        released_pop(released_t & victims)
+        {
+            for (size_t i = 0 ; i < this->released.size() ; )
+            {
+                area_chunk_t * chunk = this->released[i].second;
+                if (chunk->use_counter == 0 && chunk->pin_counter == 0)
+                {
+                    victims.push_back(this->released[i]);
+                    this->released[i] = this->released.back();
+                    this->released.pop_back();
+                }
+                else
+                    ++i;
+            }
+        }
+
+        /* deallocate the victims - must be called outside the critical section */
+        inline void
+        released_deallocate(released_t & victims)
+        {
+            for (auto & [device_global_id, chunk] : victims)
+                this->runtime->memory_device_deallocate(device_global_id, chunk);
+            victims.clear();
+        }
+
+        /* called once a write-back of evicted pages to the host completed */
+        static void
+        writeback_callback(void * args[XKRT_CALLBACK_ARGS_MAX])
+        {
+            assert(XKRT_CALLBACK_ARGS_MAX >= 2);
+
+            runtime_t * runtime = (runtime_t *) args[0];
+            assert(runtime);
+
+            copy_t * copy = (copy_t *) args[1];
+            assert(copy);
+            assert(copy->access == NULL);
+
+            PagedMemoryMap * map = copy->map;
+            const device_global_id_t device_global_id = copy->src_device_global_id;
+
+            runtime->router->transfer_end(device_global_id, HOST_DEVICE_GLOBAL_ID);
+
+            /* the host is valid, unless the page got written meanwhile */
+            map->lock();
+            {
+                for (size_t i = 0 ; i < copy->npages ; ++i)
+                {
+                    auto it = map->pages.find(copy->page + i);
+                    if (it != map->pages.end() && it->second.version <= copy->epoch)
+                        it->second.valid |= (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID);
+                }
+            }
+            map->unlock();
+
+            area_chunk_unpin(copy->src_chunk);
+
+            map->writeback_pages[device_global_id].fetch_sub(copy->npages, std::memory_order_release);
+            map->writeback_pages[device_global_id].notify_all();
+
+            map->unref();
+            delete copy;
+        }
+
+        /**
+         *  Evict replicas of the device, by allocation, least recently used
+         *  first, until at least 'size' bytes were freed.  An allocation may
+         *  be evicted if it is not pinned (no running task and no copy uses
+         *  it).  Allocations holding the sole valid replica of some pages are
+         *  not freed, but these pages are asynchronously written back to the
+         *  host, so the allocation can be evicted once the write-back
+         *  completed (see 'writeback_wait').
+         *  Returns the number of bytes freed or being freed.
+         */
+        inline size_t
+        evict(
+            const device_global_id_t device_global_id,
+            const size_t size
+        ) {
+            assert(device_global_id != HOST_DEVICE_GLOBAL_ID);
+            const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+
+            std::unordered_map<area_chunk_t *, bool> candidates;    /* allocation -> dirty */
+            std::unordered_map<area_chunk_t *, bool> elected;       /* allocation -> dirty */
+            std::vector<std::pair<uintptr_t, memory_page_replica_t>> dirty;
+            std::vector<copy_t> writebacks;
+            released_t victims;
+            size_t freed = 0;
+
+            this->lock();
+            {
+                replicas_t & replicas = this->replicas[device_global_id];
+
+                /* collect unpinned allocations, dirty if they hold the sole
+                 * valid replica of a page */
+                for (auto & [page, r] : replicas)
+                {
+                    if (r.chunk == NULL || r.chunk->pin_counter)
+                        continue ;
+                    bool & d = candidates[r.chunk];
+                    auto it = this->pages.find(page);
+                    if (it != this->pages.end() && it->second.valid == devbit)
+                        d = true;
+                }
+
+                /* elect victims, least recently used first */
+                std::vector<area_chunk_t *> sorted;
+                sorted.reserve(candidates.size());
+                for (auto & [chunk, d] : candidates)
+                    sorted.push_back(chunk);
+                std::sort(sorted.begin(), sorted.end(),
+                    [] (const area_chunk_t * a, const area_chunk_t * b) {
+                        return a->last_use.load(std::memory_order_relaxed) < b->last_use.load(std::memory_order_relaxed);
+                    }
+                );
+                for (area_chunk_t * chunk : sorted)
+                {
+                    if (freed >= size)
+                        break ;
+                    elected[chunk] = candidates[chunk];
+                    freed += chunk->size;
+                }
+
+                /* unmap clean victims, and collect pages to write back of dirty ones */
+                for (auto it = replicas.begin() ; it != replicas.end() ; )
+                {
+                    auto jt = (it->second.chunk) ? elected.find(it->second.chunk) : elected.end();
+                    if (jt == elected.end())
+                    {
+                        ++it;
+                        continue ;
+                    }
+
+                    auto pt = this->pages.find(it->first);
+                    if (jt->second)
+                    {
+                        if (pt != this->pages.end() && pt->second.valid == devbit)
+                            dirty.push_back(*it);
+                        ++it;
+                        continue ;
+                    }
+
+                    if (pt != this->pages.end())
+                        pt->second.valid &= (device_global_id_bitfield_t) ~devbit;
+                    if (--(it->second.chunk->use_counter) == 0)
+                        victims.push_back(std::make_pair(device_global_id, it->second.chunk));
+                    it = replicas.erase(it);
+                }
+
+                /* coalesce consecutive dirty pages of a same allocation - chunks are pinned until the copy completes */
+                std::sort(dirty.begin(), dirty.end(),
+                    [] (const auto & a, const auto & b) { return a.first < b.first; }
+                );
+                for (auto & [page, r] : dirty)
+                {
+                    if (writebacks.size())
+                    {
+                        copy_t & copy = writebacks.back();
+                        if (copy.src_chunk == r.chunk                               &&
+                            copy.page + copy.npages == page                         &&
+                            copy.src_addr + copy.npages * this->page_size == r.addr)
+                        {
+                            ++copy.npages;
+                            continue ;
+                        }
+                    }
+
+                    area_chunk_pin(r.chunk);
+                    writebacks.push_back({
+                        this, NULL, page, 1,
+                        device_global_id, r.addr, r.chunk,
+                        HOST_DEVICE_GLOBAL_ID, this->page_addr(page), NULL,
+                        this->epoch
+                    });
+                }
+
+                /* allocations that lost all their pages meanwhile */
+                this->released_pop(victims);
+            }
+            this->unlock();
+
+            /* release the clean victims */
+            for (auto & [victim_device_global_id, chunk] : victims)
+            {
+                if (elected.find(chunk) != elected.end())
+                {
+                    LOGGER_DEBUG("Evicted %zu bytes of paged replicas", chunk->size);
+                    XKRT_STATS_INCR(this->runtime->device_get(victim_device_global_id)->stats.memory.coherence.evictions, 1);
+                    XKRT_STATS_INCR(this->runtime->device_get(victim_device_global_id)->stats.memory.coherence.evicted, chunk->size);
+                }
+            }
+            this->released_deallocate(victims);
+
+            /* launch write-backs of the dirty ones */
+            for (const copy_t & copy : writebacks)
+            {
+                this->writeback_pages[device_global_id].fetch_add(copy.npages, std::memory_order_relaxed);
+                this->copy_launch(copy, writeback_callback);
+            }
+
+            return freed;
+        }
+
+        /* wait for pending write-backs of the device: threads of the device
+         * progress their queues meanwhile, as they may hold the copies, others
+         * sleep until the write-backs completed */
+        inline void
+        writeback_wait(const device_global_id_t device_global_id)
+        {
+            thread_t * thread = thread_t::get_tls();
+            device_t * device = this->runtime->device_get(device_global_id);
+            assert(device);
+
+            size_t npages;
+            while ((npages = this->writeback_pages[device_global_id].load(std::memory_order_acquire)) > 0)
+            {
+                if (thread && thread->device_global_id == device_global_id)
+                {
+                    device->offloader_launch(thread->tid);
+                    device->offloader_progress(thread->tid);
+                }
+                else
+                    this->writeback_pages[device_global_id].wait(npages, std::memory_order_acquire);
+            }
+        }
+
+        /* allocate 'size' bytes on the device, evicting replicas until it
+         * succeeds - must be called outside the critical section */
+        inline area_chunk_t *
+        allocate(
+            const device_global_id_t device_global_id,
+            const size_t size
+        ) {
+            area_chunk_t * chunk = this->runtime->memory_device_allocate(device_global_id, size);
+            if (chunk)
+                return chunk;
+
+            for (int retry = 0 ; retry < 32 ; ++retry)
+            {
+                const size_t freed = this->evict(device_global_id, size);
+
+                chunk = this->runtime->memory_device_allocate(device_global_id, size);
+                if (chunk)
+                    return chunk;
+
+                /* nothing could be evicted, and nothing is being written back */
+                if (freed == 0 && this->writeback_pages[device_global_id].load(std::memory_order_relaxed) == 0)
+                    break ;
+
+                /* dirty victims are only evictable once written back */
+                this->writeback_wait(device_global_id);
+            }
+
+            LOGGER_FATAL("Out of device memory while allocating %zu bytes, and all paged replicas are in use", size);
+            return NULL;
+        }
+
+        /**
+         *  (1) find or allocate a contiguous replica of the access pages on
+         *  the device, (2) set the access view, and (3) find a source for each
+         *  invalid page, coalescing consecutive pages of a same source into
+         *  'copies'.  Returns how many copies or fetches in-flight the access
+         *  task awaits for.  'overwrite' is set if some pages were not valid
+         *  on the device, but need no copy as they are entirely overwritten.
+         */
+        inline task_wait_counter_type_t
+        fetch_setup(
+            access_t * access,
+            const device_global_id_t device_global_id,
+            std::vector<copy_t> & copies,
+            const bool only_allocates,
+            bool & overwrite
+        ) {
+            assert(access->type == ACCESS_TYPE_SEGMENT);
+            assert(access->host_view.m > 0);
+
+            const uintptr_t a       = access->host_view.addr;
+            const uintptr_t b       = a + access->host_view.m;
+            const uintptr_t first   = this->page_of(a);
+            const size_t n          = this->page_of(b - 1) - first + 1;
+            const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+
+            memory_page_replica_t replica;
+            replicas_t remapped;
+            released_t victims;
+            area_chunk_t * unused = NULL;
+            task_wait_counter_type_t nawaiting = 0;
+
+            this->lock();
+            {
+                /* step (1) find or allocate a contiguous replica of the pages -
+                 * this may temporarily release the lock */
+                if (device_global_id == HOST_DEVICE_GLOBAL_ID)
+                    this->replicas_map_host(first, n);
+
+                while (!this->replicas_contiguous(device_global_id, first, n, &replica))
+                {
+                    if (unused)
+                    {
+                        this->replicas_map(device_global_id, first, n, unused, remapped);
+                        unused = NULL;
+                        continue ;
+                    }
+
+                    this->released_pop(victims);
+                    this->unlock();
+                    {
+                        this->released_deallocate(victims);
+
+                        unused = this->allocate(device_global_id, n * this->page_size);
+                    }
+                    this->lock();
+                }
+
+                /* step (2) set the access view on the device (that will be used by the kernel) */
+                access->device_view.addr = replica.addr + (a - this->page_addr(first));
+                access->device_view.ld   = access->host_view.ld;
+
+                /* mark the chunk as recently used, and pin it until the task completes */
+                if (replica.chunk)
+                {
+                    device_t * device = this->runtime->device_get(device_global_id);
+                    area_chunk_touch(&device->memories[replica.chunk->area_idx].area, replica.chunk);
+                    if (access->task)
+                    {
+                        if (access->device_chunk)
+                            area_chunk_unpin(access->device_chunk);
+                        area_chunk_pin(replica.chunk);
+                        access->device_chunk = replica.chunk;
+                    }
+                }
+
+                /* step (3) find a source for each invalid page */
+                if (!only_allocates)
+                {
+                    replicas_t & replicas = this->replicas[device_global_id];
+                    size_t run = SIZE_MAX;
+
+                    for (size_t i = 0 ; i < n ; ++i)
+                    {
+                        const uintptr_t page = first + i;
+                        memory_page_t & p = this->page_get(page);
+                        memory_page_replica_t & r = replicas[page];
+
+                        if (p.valid & devbit)
+                        {
+                            run = SIZE_MAX;
+                            continue ;
+                        }
+
+                        /* another access is fetching that page to that replica */
+                        if (r.fetching)
+                        {
+                            assert(access->task);
+                            __task_fetching(1, access->task);
+                            p.awaiting.push_back({access, device_global_id, r.chunk});
+                            ++nawaiting;
+                            run = SIZE_MAX;
+                            continue ;
+                        }
+
+                        /* pages entirely overwritten do not need to be fetched */
+                        if (!(access->mode & ACCESS_MODE_R) && a <= this->page_addr(page) && this->page_addr(page + 1) <= b)
+                        {
+                            overwrite = true;
+                            run = SIZE_MAX;
+                            continue ;
+                        }
+
+                        /* the source, favoring the previous allocation on the
+                         * device, then the source of the previous page */
+                        memory_page_replica_t src;
+                        device_global_id_t src_device_global_id;
+
+                        auto it = remapped.find(page);
+                        if (it != remapped.end())
+                        {
+                            src_device_global_id = device_global_id;
+                            src = it->second;
+                        }
+                        else
+                        {
+                            const device_global_id_bitfield_t valid = p.valid & (device_global_id_bitfield_t) ~devbit;
+                            if (valid == 0)
+                                LOGGER_FATAL("No valid replica of page `%p`", (void *) this->page_addr(page));
+
+                            if (run != SIZE_MAX && (valid & (1 << copies[run].src_device_global_id)))
+                                src_device_global_id = copies[run].src_device_global_id;
+                            else
+                                src_device_global_id = this->runtime->router->get_source(device_global_id, valid);
+
+                            if (src_device_global_id == HOST_DEVICE_GLOBAL_ID)
+                                this->replicas_map_host(page, 1);
+                            src = this->replicas[src_device_global_id][page];
+                        }
+
+                        r.fetching = true;
+
+                        /* coalesce with the previous page if both replicas are continuous */
+                        if (run != SIZE_MAX)
+                        {
+                            copy_t & copy = copies[run];
+                            if (copy.src_device_global_id == src_device_global_id   &&
+                                copy.src_chunk == src.chunk                         &&
+                                copy.src_addr + copy.npages * this->page_size == src.addr)
+                            {
+                                ++copy.npages;
+                                continue ;
+                            }
+                        }
+
+                        /* else, start a new copy - chunks are pinned until it completes */
+                        if (src.chunk)
+                            area_chunk_pin(src.chunk);
+                        if (r.chunk)
+                            area_chunk_pin(r.chunk);
+
+                        run = copies.size();
+                        copies.push_back({
+                            this, access, page, 1,
+                            src_device_global_id, src.addr, src.chunk,
+                            device_global_id, r.addr, r.chunk,
+                            0
+                        });
+                    }
+
+                    /* write accesses invalidate all other replicas */
+                    if (access->mode & ACCESS_MODE_W)
+                    {
+                        ++this->epoch;
+                        for (size_t i = 0 ; i < n ; ++i)
+                        {
+                            memory_page_t & p = this->page_get(first + i);
+                            p.valid   = devbit;
+                            p.version = this->epoch;
+                        }
+                    }
+                }
+            }
+            this->unlock();
+
+            /* release the allocation that lost against a concurrent fetch */
+            if (unused)
+                this->runtime->memory_device_deallocate(device_global_id, unused);
+
+            return (task_wait_counter_type_t) (nawaiting + copies.size());
+        }
+
+        static inline void
+        fetched(
+            runtime_t * runtime,
+            access_t * access,
+            device_global_id_t device_global_id
+        ) {
+            assert(access->task);
+            access->state = ACCESS_STATE_FETCHED;
+
+            device_t * device = runtime->device_get(device_global_id);
+            assert(device);
+            __task_fetched(1, access->task, task_execute, runtime, device);
+        }
+
+        static void
+        copy_callback(void * args[XKRT_CALLBACK_ARGS_MAX])
+        {
+            assert(XKRT_CALLBACK_ARGS_MAX >= 2);
+
+            runtime_t * runtime = (runtime_t *) args[0];
+            assert(runtime);
+
+            copy_t * copy = (copy_t *) args[1];
+            assert(copy);
+
+            PagedMemoryMap * map = copy->map;
+            const device_global_id_t device_global_id = copy->dst_device_global_id;
+            const device_global_id_bitfield_t devbit = (device_global_id_bitfield_t) (1 << device_global_id);
+
+            /* the link is free again */
+            runtime->router->transfer_end(copy->src_device_global_id, device_global_id);
+
+            /* mark pages valid, unless they got remapped or invalidated
+             * meanwhile - but always release the accesses awaiting on that
+             * copy: their view is on the destination chunk, that they pinned */
+            std::vector<access_t *> awaiting;
+            map->lock();
+            {
+                replicas_t & replicas = map->replicas[device_global_id];
+                for (size_t i = 0 ; i < copy->npages ; ++i)
+                {
+                    const uintptr_t page = copy->page + i;
+
+                    auto it = replicas.find(page);
+                    const bool mapped = (it != replicas.end() && it->second.chunk == copy->dst_chunk);
+                    if (mapped)
+                        it->second.fetching = false;
+
+                    auto pt = map->pages.find(page);
+                    if (pt == map->pages.end())
+                        continue ;
+
+                    memory_page_t & p = pt->second;
+                    if (mapped)
+                        p.valid |= devbit;
+
+                    for (size_t j = 0 ; j < p.awaiting.size() ; )
+                    {
+                        const memory_page_awaiting_t & w = p.awaiting[j];
+                        if (w.device_global_id == device_global_id && w.chunk == copy->dst_chunk)
+                        {
+                            awaiting.push_back(w.access);
+                            p.awaiting[j] = p.awaiting.back();
+                            p.awaiting.pop_back();
+                        }
+                        else
+                            ++j;
+                    }
+                }
+            }
+            map->unlock();
+
+            /* chunks may be evicted again */
+            if (copy->src_chunk)
+                area_chunk_unpin(copy->src_chunk);
+            if (copy->dst_chunk)
+                area_chunk_unpin(copy->dst_chunk);
+
+            fetched(runtime, copy->access, device_global_id);
+            for (access_t * access : awaiting)
+                fetched(runtime, access, device_global_id);
+
+            map->unref();
+            delete copy;
+        }
+
+        inline void
+        copy_launch(
+            const copy_t & c,
+            void (*func)(void * args[XKRT_CALLBACK_ARGS_MAX]) = copy_callback
+        ) {
+            assert(c.src_device_global_id != HOST_DEVICE_GLOBAL_ID || c.dst_device_global_id != HOST_DEVICE_GLOBAL_ID);
+
+            /* released in the callback */
+            copy_t * copy = new copy_t(c);
+            this->ref();
+
+            callback_t callback;
+            callback.func    = func;
+            callback.args[0] = this->runtime;
+            callback.args[1] = copy;
+
+            /* the device on which a queue will perform the copy - use the dst device if not the host */
+            const device_global_id_t device_global_id = (copy->dst_device_global_id != HOST_DEVICE_GLOBAL_ID) ? copy->dst_device_global_id : copy->src_device_global_id;
+
+            /* the runtime splits the copy on registered memory boundaries of the host */
+            this->runtime->router->transfer_begin(copy->src_device_global_id, copy->dst_device_global_id);
+            this->runtime->copy(
+                device_global_id,
+                copy->npages * this->page_size,
+                copy->dst_device_global_id,
+                copy->dst_addr,
+                copy->src_device_global_id,
+                copy->src_addr,
+                callback
+            );
+        }
+
+    public:
+
+        /** Fetch the access on the given device */
+        bool
+        fetch(
+            access_t * access,
+            device_global_id_t device_global_id
+        ) {
+            if (access->state == ACCESS_STATE_FETCHING || access->state == ACCESS_STATE_FETCHED)
+                return false;
+
+            assert(access->state == ACCESS_STATE_INIT);
+            access->state = ACCESS_STATE_FETCHING;
+
+            // no need to fetch unified memory
+            if (access->scope == ACCESS_SCOPE_UNIFIED)
+            {
+                const void * addr = (const void *) access->host_view.addr;
+                const size_t size = access->host_view.m;
+                this->runtime->memory_unified_advise(device_global_id, addr, size);
+                this->runtime->memory_unified_prefetch(device_global_id, addr, size);
+
+                access->device_view.addr = access->host_view.addr;
+                access->device_view.ld   = access->host_view.ld;
+                access->state            = ACCESS_STATE_FETCHED;
+                return true;
+            }
+
+            std::vector<copy_t> copies;
+            bool overwrite = false;
+            const task_wait_counter_type_t n = this->fetch_setup(access, device_global_id, copies, false, overwrite);
+
+            # if XKRT_SUPPORT_STATS
+            device_t * device = this->runtime->device_get(device_global_id);
+            if (copies.size())
+                XKRT_STATS_INCR(device->stats.memory.coherence.misses, 1);
+            else if (n)
+                XKRT_STATS_INCR(device->stats.memory.coherence.joined, 1);
+            else if (overwrite)
+                XKRT_STATS_INCR(device->stats.memory.coherence.overwrites, 1);
+            else
+                XKRT_STATS_INCR(device->stats.memory.coherence.hits, 1);
+            # endif /* XKRT_SUPPORT_STATS */
+
+            if (n == 0)
+            {
+                access->state = ACCESS_STATE_FETCHED;
+                return true;
+            }
+
+            if (copies.size())
+            {
+                XKRT_STATS_INCR(this->runtime->stats.memory.paged.copies, copies.size());
+                __task_fetching((task_wait_counter_type_t) copies.size(), access->task);
+                for (const copy_t & copy : copies)
+                {
+                    XKRT_STATS_INCR(this->runtime->stats.memory.paged.pages, copy.npages);
+                    this->copy_launch(copy);
+                }
+            }
+
+            return true;
+        }
+
+        /** Allocate the access on the given device, without fetching it */
+        void
+        allocate_to_device(
+            access_t * access,
+            device_global_id_t device_global_id
+        ) {
+            assert(access->task == NULL);
+            assert(device_global_id != HOST_DEVICE_GLOBAL_ID);
+
+            std::vector<copy_t> copies;
+            bool overwrite = false;
+            this->fetch_setup(access, device_global_id, copies, true, overwrite);
+            assert(copies.empty());
+        }
+
+        void
+        invalidate(void)
+        {
+            this->lock();
+            {
+                this->pages.clear();
+                for (replicas_t & replicas : this->replicas)
+                    replicas.clear();
+                this->released.clear();
+            }
+            this->unlock();
+        }
+
+        device_global_id_bitfield_t
+        who_owns(access_t * access)
+        {
+            assert(access->host_view.m > 0);
+
+            const uintptr_t first = this->page_of(access->host_view.addr);
+            const uintptr_t last  = this->page_of(access->host_view.addr + access->host_view.m - 1);
+
+            // find how many pages are owned per device
+            size_t pages_owned[XKRT_DEVICES_MAX] = {0};
+            this->lock();
+            {
+                for (uintptr_t page = first ; page <= last ; ++page)
+                {
+                    auto it = this->pages.find(page);
+                    device_global_id_bitfield_t valid = (it == this->pages.end()) ? (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID) : it->second.valid;
+                    while (valid)
+                    {
+                        const int device_global_id = __builtin_ctz(valid);
+                        ++pages_owned[device_global_id];
+                        valid &= (device_global_id_bitfield_t) (valid - 1);
+                    }
+                }
+            }
+            this->unlock();
+
+            // find devices which owns the most pages
+            device_global_id_bitfield_t owners = 0;
+            size_t pages_owned_max = 0;
+            for (device_global_id_t device_global_id = 0 ; device_global_id < XKRT_DEVICES_MAX ; ++device_global_id)
+            {
+                if (pages_owned_max < pages_owned[device_global_id])
+                {
+                    pages_owned_max = pages_owned[device_global_id];
+                    owners = (device_global_id_bitfield_t) (1 << device_global_id);
+                }
+                else if (pages_owned_max && pages_owned_max == pages_owned[device_global_id])
+                    owners |= (device_global_id_bitfield_t) (1 << device_global_id);
+            }
+
+            return owners;
+        }
+
+}; /* PagedMemoryMap */
+
+XKRT_NAMESPACE_END
+
+#endif /* __PAGED_MEMORY_MAP_HPP__ */
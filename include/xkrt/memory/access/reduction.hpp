@@ -0,0 +1,96 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+#ifndef __ACCESS_REDUCTION_HPP__
+# define __ACCESS_REDUCTION_HPP__
+
+# include <xkrt/namespace.h>
+# include <xkrt/memory/view.hpp>
+# include <xkrt/sync/spinlock.h>
+
+# include <atomic>
+# include <utility>
+# include <vector>
+
+XKRT_NAMESPACE_BEGIN
+
+struct task_t;
+
+/* combine 'size' bytes of 'in' into 'inout' (must be associative and commutative) */
+typedef void (*access_reduce_op_t)(void * inout, const void * in, size_t size);
+
+/**
+ *  A reduction: accesses in mode ACCESS_MODE_REDUCE to the same data with the
+ *  same operator, that do not depend on each others.  Each task executing
+ *  one of them accumulates into a zero-initialized copy of the data (a
+ *  'partial') that no other executing task uses - partials are reused by
+ *  the next tasks once released, so there are about as many as tasks
+ *  executing concurrently.  The partials are combined in a tree and then into
+ *  the data once none of them is executing, and either the last reduce
+ *  completes or a completing one has a successor that is not part of the
+ *  reduction - so before any such successor may start.
+ */
+typedef struct  access_reduction_t
+{
+    /* the reduced data */
+    memory_view_t view;
+
+    /* the combine operator */
+    access_reduce_op_t op;
+
+    /* protects the fields bellow, held while combining */
+    spinlock_t lock;
+
+    /* number of reduce accesses currently executing */
+    int executing;
+
+    /* partials allocated since the last combine, with the task currently
+     * accumulating into each of them (or NULL if none) */
+    std::vector<std::pair<task_t *, void *>> partials;
+
+    /* number of reduce accesses not completed yet */
+    std::atomic<int> pending;
+
+    access_reduction_t(const memory_view_t & view, access_reduce_op_t op) :
+        view(view), op(op), lock(), executing(0), partials(), pending(0) {}
+
+}               access_reduction_t;
+
+XKRT_NAMESPACE_END
+
+#endif /* __ACCESS_REDUCTION_HPP__ */
@@ -38,7 +38,13 @@
 #ifndef __AREA_H__
 # define __AREA_H__
 
+# include <xkrt/namespace.h>
+# include <xkrt/stats/stats.h>
 # include <xkrt/sync/mutex.h>
+# include <xkrt/sync/spinlock.h>
+
+# include <atomic>
+# include <stdint.h>
 
 ///////////////////////////
 // Driver devices memory //
@@ -56,8 +62,8 @@ XKRT_NAMESPACE_BEGIN
     /**
      * Represent a segment of memory in device memory (used by custom allocator)
      * It is placed in two chained list:
-     *  - the list of all chunk in device memory
-     *  - the list of free chunk in device memory
+     *  - the list of all chunk in device memory, ordered by address
+     *  - the list of free chunk of its size class
     */
     typedef struct  area_chunk_t
     {
@@ -66,20 +72,142 @@ XKRT_NAMESPACE_BEGIN
         int state;                         /* state of the chunk */
         struct area_chunk_t * prev;        /* previous chunk in double chained list */
         struct area_chunk_t * next;        /* next chunk in double chained list */
-        struct area_chunk_t * freelink;    /* next freechunk in the chained list */
+        struct area_chunk_t * freelink;    /* next freechunk in the chained list of its size class */
+        struct area_chunk_t * freeprev;    /* previous freechunk in the chained list of its size class */
         int use_counter;                   /* used in the memory-tree to count how many blocks relies on that allocation chunk */
         int area_idx;                      /* memory area index in the device (TODO: bad design) */
+        volatile int pin_counter;          /* number of tasks/copies currently using that chunk, that cannot be evicted if > 0 */
+        std::atomic<uint64_t> last_use;    /* value of the area clock on the last use of that chunk (for LRU eviction), touched under a shared tree lock */
     }               area_chunk_t;
 
+    /* Free chunks are segregated in size classes (two-level segregated fit):
+     * the first level is the power of 2 of the size, the second level splits
+     * it linearly into AREA_SL_COUNT classes */
+    # define AREA_ALIGN     (8UL)
+    # define AREA_SL_LOG2   (4)
+    # define AREA_SL_COUNT  (1 << AREA_SL_LOG2)
+    # define AREA_FL_COUNT  (64)
+
+    /* A memory segment allocated from the driver, chunks never span two segments */
+    typedef struct  area_segment_t
+    {
+        uintptr_t ptr;                      /* position of the segment in device */
+        size_t size;                        /* size of the segment in byte */
+        area_chunk_t * first;               /* chunk at the start of the segment, it is never merged into another */
+        struct area_segment_t * next;       /* next segment of the area */
+    }               area_segment_t;
+
+    /* Allocation latencies are counted in buckets of power of 2 nanoseconds:
+     * the i-th bucket counts durations in [2^(MIN_LOG2+i-1), 2^(MIN_LOG2+i)[,
+     * the first one durations below 2^MIN_LOG2, and the last one all longer */
+    # define AREA_LATENCY_BUCKETS   (16)
+    # define AREA_LATENCY_MIN_LOG2  (7)
+
+    static inline int
+    area_latency_bucket(const uint64_t ns)
+    {
+        if (ns < (1UL << AREA_LATENCY_MIN_LOG2))
+            return 0;
+        const int b = 63 - __builtin_clzll(ns) - AREA_LATENCY_MIN_LOG2 + 1;
+        return (b < AREA_LATENCY_BUCKETS) ? b : AREA_LATENCY_BUCKETS - 1;
+    }
+
     /* The device memory with allocation information */
     typedef struct  area_t
     {
         mutex_t lock;
-        area_chunk_t chunk0;
-        area_chunk_t * free_chunk_list;
+        area_segment_t * segments;          /* segments of the area */
+        size_t reserved;                    /* total size of the segments */
+        size_t limit;                       /* maximum total size of the segments */
+        volatile bool idle;                 /* set when a segment may have become entirely free */
+        uint64_t fl_bitmap;                                         /* bit i set if a class of the i-th level has free chunks */
+        uint16_t sl_bitmap[AREA_FL_COUNT];                          /* bit j set if the class (i, j) has free chunks */
+        area_chunk_t * free_chunk_lists[AREA_FL_COUNT][AREA_SL_COUNT];
+        area_chunk_t * unused_chunk_list;                          /* chunks descriptors to reuse on splits */
+        std::atomic<uint64_t> clock;       /* logical clock, incremented on each chunk use */
+        size_t used;                        /* bytes allocated, including chunks cached by the threads */
+        size_t peak;                        /* highest value of 'used' */
+
+        # if XKRT_SUPPORT_STATS
+        struct {
+            stats_int_t allocations;                        /* calls to 'memory_allocate_on' */
+            stats_int_t failures;                           /* calls that returned NULL */
+            stats_int_t latency[AREA_LATENCY_BUCKETS];      /* histogram of their duration */
+            stats_int_t reclaims;                           /* allocations that had to defragment or evict memory */
+            stats_int_t reclaim_latency[AREA_LATENCY_BUCKETS];  /* histogram of their duration */
+        } stats;
+        # endif /* XKRT_SUPPORT_STATS */
 
     }               area_t;
 
+    /* A snapshot of the state of an area, see 'device_t::memory_stats_on' */
+    typedef struct  area_stats_t
+    {
+        size_t limit;           /* maximum total size of the segments */
+        size_t reserved;        /* total size of the segments */
+        int nsegments;          /* number of segments */
+        size_t used;            /* bytes allocated, including chunks cached by the threads */
+        size_t peak;            /* highest value of 'used' */
+        size_t free;            /* free bytes */
+        size_t nfree;           /* number of free chunks */
+        size_t largest;         /* size of the largest free chunk */
+        double fragmentation;   /* 1 - largest / free, 0 if there is no free memory */
+
+        /* counters below are only set if stats are supported */
+        uint64_t allocations;
+        uint64_t failures;
+        uint64_t latency[AREA_LATENCY_BUCKETS];
+        uint64_t reclaims;
+        uint64_t reclaim_latency[AREA_LATENCY_BUCKETS];
+
+    }               area_stats_t;
+
+    /* Chunks freed by a device thread are first kept in a cache of that
+     * thread, to be reallocated without locking the area. A cache has
+     * AREA_CACHE_BINS size classes of AREA_CACHE_DEPTH chunks, and is flushed
+     * back to the area every AREA_CACHE_FLUSH_PERIOD deallocations, or when
+     * an allocation of any thread fails */
+    # define AREA_CACHE_BINS            (4)
+    # define AREA_CACHE_DEPTH           (4)
+    # define AREA_CACHE_FLUSH_PERIOD    (1024)
+
+    typedef struct  area_chunk_cache_t
+    {
+        struct {
+            int cls;                                    /* size class of the chunks of that bin */
+            int n;                                      /* number of chunks in the bin */
+            area_chunk_t * chunks[AREA_CACHE_DEPTH];    /* the chunks, still allocated in the area */
+        } bins[AREA_CACHE_BINS];
+
+        /* number of deallocations since the last flush */
+        uint32_t nfreed;
+
+        /* uncontended but for flushes by other threads, on allocation failures */
+        spinlock_t lock;
+
+    }               area_chunk_cache_t;
+
+    /* mark the chunk as used, for LRU eviction */
+    static inline void
+    area_chunk_touch(area_t * area, area_chunk_t * chunk)
+    {
+        chunk->last_use.store(area->clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /* prevent the chunk from being evicted */
+    static inline void
+    area_chunk_pin(area_chunk_t * chunk)
+    {
+        __sync_fetch_and_add(&chunk->pin_counter, 1);
+    }
+
+    /* allow the chunk to be evicted again */
+    static inline void
+    area_chunk_unpin(area_chunk_t * chunk)
+    {
+        __sync_fetch_and_sub(&chunk->pin_counter, 1);
+    }
+
 XKRT_NAMESPACE_END
 
 #endif /* __AREA_H__ */
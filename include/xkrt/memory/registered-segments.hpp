@@ -0,0 +1,232 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+#ifndef __XKRT_MEMORY_REGISTERED_SEGMENTS_HPP__
+# define __XKRT_MEMORY_REGISTERED_SEGMENTS_HPP__
+
+# include <xkrt/namespace.h>
+# include <xkrt/sync/mem.h>
+# include <xkrt/sync/mutex.h>
+
+# include <algorithm>
+# include <atomic>
+# include <cassert>
+# include <cstdint>
+# include <vector>
+
+XKRT_NAMESPACE_BEGIN
+
+/**
+ *  Memory segments registered to the drivers, read on transfer submissions
+ *  and written on (un)registrations only.
+ *
+ *  Readers do not lock: they use the current snapshot, a sorted vector of
+ *  the segments.  Writers are serialized, and replace the snapshot with an
+ *  updated copy.  Readers are counted per epoch (its parity): a writer
+ *  deletes the snapshot it replaced once it flipped the epoch twice, and
+ *  waited for the readers of the previous epoch each time - so the readers
+ *  that may use it completed, and at most one snapshot is ever retired.
+ */
+class RegisteredSegments
+{
+    public:
+
+        /* the segment [a, b[ */
+        typedef struct  segment_t
+        {
+            uintptr_t a;
+            uintptr_t b;
+
+        }               segment_t;
+
+        typedef std::vector<segment_t> snapshot_t;
+
+    private:
+
+        /* the current snapshot, sorted by address */
+        std::atomic<snapshot_t *> snapshot;
+
+        /* the current epoch, only its parity is used */
+        std::atomic<unsigned int> epoch;
+
+        /* number of readers, per epoch parity */
+        std::atomic<int> readers[2];
+
+        /* serialize writers */
+        mutex_t lock;
+
+    public:
+
+        RegisteredSegments() : snapshot(new snapshot_t()), epoch(0), readers()
+        {
+            XKRT_MUTEX_INIT(this->lock);
+        }
+
+        ~RegisteredSegments()
+        {
+            assert(this->readers[0].load() == 0);
+            assert(this->readers[1].load() == 0);
+            delete this->snapshot.load();
+        }
+
+    private:
+
+        /* a reader must not use the returned snapshot after 'release(idx)' */
+        inline const snapshot_t *
+        acquire(unsigned int & idx)
+        {
+            idx = this->epoch.load(std::memory_order_seq_cst) & 1;
+            this->readers[idx].fetch_add(1, std::memory_order_seq_cst);
+            return this->snapshot.load(std::memory_order_seq_cst);
+        }
+
+        inline void
+        release(const unsigned int idx)
+        {
+            this->readers[idx].fetch_sub(1, std::memory_order_release);
+        }
+
+        /* must be called with the lock held */
+        inline void
+        publish(snapshot_t * s)
+        {
+            snapshot_t * old = this->snapshot.exchange(s, std::memory_order_seq_cst);
+
+            // readers that start from now use 's'. A reader may have read
+            // the epoch before a flip but be counted after it: flip twice.
+            for (int i = 0 ; i < 2 ; ++i)
+            {
+                const unsigned int idx = this->epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+                while (this->readers[idx].load(std::memory_order_acquire) > 0)
+                    mem_pause();
+            }
+            delete old;
+        }
+
+    public:
+
+        //////////////////////////
+        // WRITERS              //
+        //////////////////////////
+
+        /* the segment [ptr, ptr + size[ got registered */
+        void
+        insert(uintptr_t ptr, size_t size)
+        {
+            XKRT_MUTEX_LOCK(this->lock);
+            {
+                snapshot_t * s = new snapshot_t(*this->snapshot.load(std::memory_order_relaxed));
+                const segment_t segment = {ptr, ptr + size};
+                auto it = std::lower_bound(s->begin(), s->end(), segment,
+                        [] (const segment_t & x, const segment_t & y) { return x.a < y.a; });
+                if (it != s->end() && it->a == ptr)
+                    *it = segment;
+                else
+                    s->insert(it, segment);
+                this->publish(s);
+            }
+            XKRT_MUTEX_UNLOCK(this->lock);
+        }
+
+        /* the segment [ptr, ptr + size[ got unregistered: it is subtracted
+         * from the registered segments, that may be trimmed or split */
+        void
+        erase(uintptr_t ptr, size_t size)
+        {
+            const uintptr_t a = ptr;
+            const uintptr_t b = ptr + size;
+
+            XKRT_MUTEX_LOCK(this->lock);
+            {
+                const snapshot_t * current = this->snapshot.load(std::memory_order_relaxed);
+                snapshot_t * s = new snapshot_t();
+                s->reserve(current->size() + 1);
+                for (const segment_t & x : *current)
+                {
+                    if (x.b <= a || b <= x.a)
+                        s->push_back(x);
+                    else
+                    {
+                        if (x.a < a)
+                            s->push_back({x.a, a});
+                        if (b < x.b)
+                            s->push_back({b, x.b});
+                    }
+                }
+                this->publish(s);
+            }
+            XKRT_MUTEX_UNLOCK(this->lock);
+        }
+
+        //////////////////////////
+        // READERS - lock-free  //
+        //////////////////////////
+
+        /* call 'f(segment)' for each segment, in address order */
+        template <typename F>
+        void
+        foreach(F && f)
+        {
+            unsigned int idx;
+            const snapshot_t * s = this->acquire(idx);
+            for (const segment_t & segment : *s)
+                f(segment);
+            this->release(idx);
+        }
+
+        /* call 'f(segment)' for each segment intersecting [a, b[, in address order */
+        template <typename F>
+        void
+        foreach_intersecting(uintptr_t a, uintptr_t b, F && f)
+        {
+            unsigned int idx;
+            const snapshot_t * s = this->acquire(idx);
+            {
+                // first segment ending after 'a'
+                auto it = std::upper_bound(s->begin(), s->end(), a,
+                        [] (uintptr_t x, const segment_t & y) { return x < y.b; });
+                for ( ; it != s->end() && it->a < b ; ++it)
+                    f(*it);
+            }
+            this->release(idx);
+        }
+};
+
+XKRT_NAMESPACE_END
+
+#endif /* __XKRT_MEMORY_REGISTERED_SEGMENTS_HPP__ */
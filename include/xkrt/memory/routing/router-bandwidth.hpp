@@ -0,0 +1,269 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+/**
+ *  Learn the bandwidth of each (src, dst) link from the copies completed by
+ *  the queues, and pick the sources of highest measured bandwidth.  Links that
+ *  were never measured are explored first, in the drivers perf rank order.
+ */
+
+# ifndef __ROUTER_BANDWIDTH_HPP__
+#  define __ROUTER_BANDWIDTH_HPP__
+
+# include <xkrt/consts.h>
+# include <xkrt/driver/queue.h>
+# include <xkrt/memory/routing/router-affinity.hpp>
+# include <xkrt/sync/bits.h>
+
+# include <assert.h>
+# include <stdint.h>
+# include <stdio.h>
+
+# include <vector>
+
+XKRT_NAMESPACE_BEGIN
+
+class RouterBandwidth : public RouterAffinity
+{
+    public:
+
+        /* estimation of a link, aggregated over all queues performing copies on it */
+        typedef struct  link_t
+        {
+            uint64_t bytes;     /* total bytes copied */
+            uint64_t ns;        /* total duration of the copies */
+            uint64_t n;         /* number of copies */
+            double bandwidth;   /* mean of the queues bandwidth moving average, in bytes per second */
+
+        }               link_t;
+
+        /* queues that perform copies, per device */
+        std::vector<const queue_t *> queues[XKRT_DEVICES_MAX];
+
+        /* transfers of at least that many bytes may be split across several sources */
+        size_t split_threshold;
+
+    public:
+
+        RouterBandwidth() : queues(), split_threshold(SIZE_MAX) {}
+        ~RouterBandwidth() {}
+
+        /* measure copies completed on that queue of the given device */
+        void
+        add_queue(const device_global_id_t device_global_id, const queue_t * queue)
+        {
+            assert(device_global_id < XKRT_DEVICES_MAX);
+            this->queues[device_global_id].push_back(queue);
+        }
+
+        /**
+         *  Aggregate the measures of the link (src, dst) - a copy is performed
+         *  by a queue of either of its devices.
+         *  Returns false if the link was never measured.
+         */
+        bool
+        get_link(
+            const device_global_id_t src,
+            const device_global_id_t dst,
+            link_t * link
+        ) const {
+            link->bytes = 0;
+            link->ns = 0;
+            link->n = 0;
+            link->bandwidth = 0.0;
+
+            int nqueues = 0;
+            for (const device_global_id_t device_global_id : {src, dst})
+            {
+                for (const queue_t * queue : this->queues[device_global_id])
+                {
+                    const queue_link_t * l = &(queue->links[src][dst]);
+                    const uint64_t n = l->n.load(std::memory_order_acquire);
+                    if (n == 0)
+                        continue ;
+                    link->bytes     += l->bytes.load(std::memory_order_relaxed);
+                    link->ns        += l->ns.load(std::memory_order_relaxed);
+                    link->n         += n;
+                    link->bandwidth += l->bandwidth.load(std::memory_order_relaxed);
+                    ++nqueues;
+                }
+
+                /* a device copying to itself */
+                if (src == dst)
+                    break ;
+            }
+
+            if (nqueues == 0)
+                return false;
+
+            link->bandwidth /= nqueues;
+            return true;
+        }
+
+        /* @override */
+        device_global_id_t
+        get_source(
+            const device_global_id_t dst,
+            const device_global_id_bitfield_t valid
+        ) const override {
+
+            /* fast way out: valid on that device already */
+            if (valid & (1 << dst))
+                return dst;
+
+            device_global_id_t srcs[XKRT_ROUTER_SPLIT_MAX];
+            double bandwidths[XKRT_ROUTER_SPLIT_MAX];
+            device_global_id_bitfield_t unmeasured;
+            const int n = this->get_best_sources(dst, valid, 1, srcs, bandwidths, &unmeasured);
+
+            /* explore links that were never measured */
+            if (unmeasured)
+                return RouterAffinity::get_source(dst, unmeasured);
+
+            if (n)
+                return srcs[0];
+
+            /* get any random device */
+            return (device_global_id_t) (__random_set_bit(valid) - 1);
+        }
+
+        /* @override */
+        int
+        get_sources(
+            const device_global_id_t dst,
+            const device_global_id_bitfield_t valid,
+            const size_t size,
+            device_global_id_t srcs[XKRT_ROUTER_SPLIT_MAX],
+            double shares[XKRT_ROUTER_SPLIT_MAX]
+        ) const override {
+
+            /* small transfers, or not all links measured yet: a single source */
+            int n = 0;
+            device_global_id_bitfield_t unmeasured = 0;
+            if (size >= this->split_threshold && !(valid & (1 << dst)))
+                n = this->get_best_sources(dst, valid, XKRT_ROUTER_SPLIT_MAX, srcs, shares, &unmeasured);
+
+            if (n < 2 || unmeasured)
+                return Router::get_sources(dst, valid, size, srcs, shares);
+
+            /* split proportionally to the bandwidth of each link */
+            double total = 0.0;
+            for (int i = 0 ; i < n ; ++i)
+                total += shares[i];
+            assert(total > 0.0);
+            for (int i = 0 ; i < n ; ++i)
+                shares[i] /= total;
+
+            return n;
+        }
+
+        /* dump the estimation of every measured link */
+        void
+        dump(FILE * f) const
+        {
+            fprintf(f, "%4s %4s %16s %16s %16s %10s\n", "src", "dst", "bandwidth(B/s)", "bytes", "ns", "copies");
+            for (device_global_id_t src = 0 ; src < XKRT_DEVICES_MAX ; ++src)
+            {
+                for (device_global_id_t dst = 0 ; dst < XKRT_DEVICES_MAX ; ++dst)
+                {
+                    link_t link;
+                    if (!this->get_link(src, dst, &link))
+                        continue ;
+                    fprintf(f, "%4u %4u %16.0lf %16lu %16lu %10lu\n",
+                            src, dst, link.bandwidth, link.bytes, link.ns, link.n);
+                }
+            }
+        }
+
+    private:
+
+        /**
+         *  Retrieve up to 'nmax' valid sources of highest measured bandwidth
+         *  to 'dst', sorted by decreasing bandwidth.  'unmeasured' is set to
+         *  the valid sources whose link to 'dst' was never measured.
+         */
+        int
+        get_best_sources(
+            const device_global_id_t dst,
+            const device_global_id_bitfield_t valid,
+            const int nmax,
+            device_global_id_t srcs[XKRT_ROUTER_SPLIT_MAX],
+            double bandwidths[XKRT_ROUTER_SPLIT_MAX],
+            device_global_id_bitfield_t * unmeasured
+        ) const {
+            assert(nmax > 0 && nmax <= XKRT_ROUTER_SPLIT_MAX);
+
+            int n = 0;
+            *unmeasured = 0;
+            for (device_global_id_t src = 0 ; src < XKRT_DEVICES_MAX ; ++src)
+            {
+                if (!(valid & (1 << src)) || src == dst)
+                    continue ;
+
+                link_t link;
+                if (!this->get_link(src, dst, &link))
+                {
+                    *unmeasured |= (device_global_id_bitfield_t) (1 << src);
+                    continue ;
+                }
+
+                /* insertion sort by decreasing bandwidth */
+                int i = (n < nmax) ? n++ : nmax;
+                while (i > 0 && bandwidths[i - 1] < link.bandwidth)
+                {
+                    if (i < nmax)
+                    {
+                        srcs[i] = srcs[i - 1];
+                        bandwidths[i] = bandwidths[i - 1];
+                    }
+                    --i;
+                }
+                if (i < nmax)
+                {
+                    srcs[i] = src;
+                    bandwidths[i] = link.bandwidth;
+                }
+            }
+
+            return n;
+        }
+};
+
+XKRT_NAMESPACE_END
+
+# endif /* __ROUTER_BANDWIDTH_HPP__ */
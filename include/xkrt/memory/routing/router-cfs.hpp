@@ -35,9 +35,15 @@
 ** knowledge of the CeCILL-C license and that you accept its terms.
 **/
 
+
 /**
- *  Idea is to use a dijkstra algorithm with weights being BW, but ignoring the link if there is already a pending transfer
- *  Problem is it may add significant latency
+ *  Router over the device link graph, where the cost of a link is its weight
+ *  (inverse of its bandwidth) scaled by the number of transfers already
+ *  pending on it, so that busy links are avoided when a cheaper one exists.
+ *  Copies are issued directly from the source to the destination, so the
+ *  source is the valid device of the cheapest direct link.  The cheapest
+ *  multi-hop path (Dijkstra) is available to stage copies through
+ *  intermediate devices.
  */
 
 # ifndef __ROUTER_CFS_HPP__
@@ -47,65 +53,249 @@
 # include <xkrt/memory/routing/router.hpp>
 # include <xkrt/sync/bits.h>
 
+# include <assert.h>
+# include <atomic>
 # include <stdint.h>
 
-/** The higher the rank, the lower the performance */
+XKRT_NAMESPACE_BEGIN
+
 class RouterCFS : public Router
 {
     public:
-        typedef struct xkrt_router_cfs_map_t
+
+        /* weight of a missing link */
+        static constexpr uint8_t NO_LINK = UINT8_MAX;
+
+        /* cost of a path that cannot be routed */
+        static constexpr uint64_t INFINITE_COST = UINT64_MAX;
+
+        /**
+         *  A graph where weights[i][j] is the weight of the edge from node 'i' to 'j'
+         *  If weights[i][j] is NO_LINK, then there is no edge
+         *  If weights[i][j] = weights[i'][j'] / x then the bw on link (i,j) is
+         *      'x' times greater than the bw of link (i',j') - i.e. the lower weights[i][j] the greater the BW
+         */
+        uint8_t weights[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX];
+
+        /* pending[i][j] is the number of transfers currently occuring on link (i,j) */
+        std::atomic<uint32_t> pending[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX];
+
+        /* number of nodes in the graph */
+        device_global_id_t ndevices;
+
+    public:
+
+        RouterCFS() : ndevices(0)
         {
-            struct {
-                uint8_t weight;
-                bool used;
-            } values[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX];
+            for (device_global_id_t i = 0 ; i < XKRT_DEVICES_MAX ; ++i)
+            {
+                for (device_global_id_t j = 0 ; j < XKRT_DEVICES_MAX ; ++j)
+                {
+                    this->weights[i][j] = NO_LINK;
+                    this->pending[i][j].store(0, std::memory_order_relaxed);
+                }
+            }
+        }
 
-            xkrt_router_cfs_map_t(const uint8_t weights[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX])
+        ~RouterCFS() {}
+
+        /* set the graph from a weight matrix */
+        void
+        set_weights(
+            const uint8_t weights[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX],
+            const device_global_id_t ndevices
+        ) {
+            assert(ndevices <= XKRT_DEVICES_MAX);
+            for (device_global_id_t i = 0 ; i < XKRT_DEVICES_MAX ; ++i)
+                for (device_global_id_t j = 0 ; j < XKRT_DEVICES_MAX ; ++j)
+                    this->weights[i][j] = weights[i][j];
+            this->ndevices = ndevices;
+        }
+
+        /**
+         *  Set the graph from the affinity matrix reported by the drivers, see
+         *  `RouterAffinity`: a source of perf rank 'r' for 'dst' gets the
+         *  weight 'r + 1'.  The host is not part of the drivers affinity, and
+         *  is linked to every device with a weight higher than any perf rank.
+         */
+        void
+        set_weights_from_affinity(
+            const device_global_id_bitfield_t affinity[XKRT_DEVICES_MAX][XKRT_DEVICES_PERF_RANK_MAX],
+            const device_global_id_t ndevices
+        ) {
+            assert(ndevices <= XKRT_DEVICES_MAX);
+            for (device_global_id_t dst = 0 ; dst < XKRT_DEVICES_MAX ; ++dst)
             {
-                for (xkrt_device_global_id_t i = 0 ; i < XKRT_DEVICES_MAX ; ++i)
+                for (device_global_id_t src = 0 ; src < XKRT_DEVICES_MAX ; ++src)
+                    this->weights[src][dst] = NO_LINK;
+
+                if (dst >= ndevices)
+                    continue ;
+
+                /* the best rank wins, if a source appears in several ranks */
+                for (int rank = XKRT_DEVICES_PERF_RANK_MAX - 1 ; rank >= 0 ; --rank)
+                    for (device_global_id_t src = 0 ; src < ndevices ; ++src)
+                        if (affinity[dst][rank] & (1 << src))
+                            this->weights[src][dst] = (uint8_t) (rank + 1);
+
+                if (dst != HOST_DEVICE_GLOBAL_ID)
                 {
-                    for (xkrt_device_global_id_t j = 0 ; j < XKRT_DEVICES_MAX ; ++j)
-                    {
-                        values[i][j].weight = weights[i][j];
-                        values[i][j].used = false;
-                    }
+                    this->weights[HOST_DEVICE_GLOBAL_ID][dst] = (uint8_t) (XKRT_DEVICES_PERF_RANK_MAX + 1);
+                    this->weights[dst][HOST_DEVICE_GLOBAL_ID] = (uint8_t) (XKRT_DEVICES_PERF_RANK_MAX + 1);
                 }
+                this->weights[dst][dst] = 0;
             }
-        }               xkrt_router_cfs_map_t;
+            this->ndevices = ndevices;
+        }
 
-    public:
+        /* current cost of the link (src, dst) */
+        inline uint64_t
+        get_link_cost(
+            const device_global_id_t src,
+            const device_global_id_t dst
+        ) const {
+            const uint8_t weight = this->weights[src][dst];
+            if (weight == NO_LINK)
+                return INFINITE_COST;
+            return (uint64_t) weight * (1 + this->pending[src][dst].load(std::memory_order_relaxed));
+        }
 
         /**
-         *  A graph where weights[i][j] is the weight of the edge between node 'i' and 'j'
-         *  If weights[i][j] is UINT8_MAX, then there is no edge
-         *  If weights[i][j] = weights[i'][j'] / x then the bw on link (i,j) is
-         *      'x' times greater than the bw of link (i,j) - i.e. the lower weights[i][j] the greater the BW
-         *  If used[i][j], then a communication is already occuring on link (i,j)
+         *  Find the cheapest path to 'dst' starting from any device of 'valid'.
+         *  On success, 'path' holds the devices of the path from the source to
+         *  'dst' (both included), and the number of devices in the path is
+         *  returned.  Returns 0 if 'dst' cannot be reached from 'valid'.
+         *  If 'cost' is not NULL, it is set to the cost of the path.
          */
-        const xkrt_router_cfs_map_t map;
+        int
+        get_path(
+            const device_global_id_t dst,
+            const device_global_id_bitfield_t valid,
+            device_global_id_t path[XKRT_DEVICES_MAX],
+            uint64_t * cost = NULL
+        ) const {
+            assert(dst < this->ndevices);
 
-    public:
+            /* reverse dijkstra from 'dst': dist[i] is the cost from 'i' to 'dst' */
+            uint64_t dist[XKRT_DEVICES_MAX];
+            device_global_id_t next[XKRT_DEVICES_MAX];
+            bool visited[XKRT_DEVICES_MAX];
+            for (device_global_id_t i = 0 ; i < this->ndevices ; ++i)
+            {
+                dist[i]    = INFINITE_COST;
+                next[i]    = UNSPECIFIED_DEVICE_GLOBAL_ID;
+                visited[i] = false;
+            }
+            dist[dst] = 0;
 
-        RouterCFS(const uint8_t weights[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX]) : weights(weights) {}
-        ~RouterCFS() {}
+            device_global_id_t src = UNSPECIFIED_DEVICE_GLOBAL_ID;
+            while (1)
+            {
+                /* closest unvisited node */
+                device_global_id_t u = UNSPECIFIED_DEVICE_GLOBAL_ID;
+                for (device_global_id_t i = 0 ; i < this->ndevices ; ++i)
+                    if (!visited[i] && dist[i] != INFINITE_COST && (u == UNSPECIFIED_DEVICE_GLOBAL_ID || dist[i] < dist[u]))
+                        u = i;
+
+                /* no more reachable nodes */
+                if (u == UNSPECIFIED_DEVICE_GLOBAL_ID)
+                    break ;
+
+                /* the first valid node settled is the cheapest source */
+                if (valid & (1 << u))
+                {
+                    src = u;
+                    break ;
+                }
+                visited[u] = true;
+
+                /* relax links (i, u) */
+                for (device_global_id_t i = 0 ; i < this->ndevices ; ++i)
+                {
+                    if (visited[i] || i == u)
+                        continue ;
+                    const uint64_t c = this->get_link_cost(i, u);
+                    if (c == INFINITE_COST)
+                        continue ;
+                    if (dist[u] + c < dist[i])
+                    {
+                        dist[i] = dist[u] + c;
+                        next[i] = u;
+                    }
+                }
+            }
+
+            if (src == UNSPECIFIED_DEVICE_GLOBAL_ID)
+                return 0;
+
+            if (cost)
+                *cost = dist[src];
+
+            int n = 0;
+            for (device_global_id_t i = src ; i != UNSPECIFIED_DEVICE_GLOBAL_ID ; i = next[i])
+            {
+                assert(n < XKRT_DEVICES_MAX);
+                path[n++] = i;
+            }
+            assert(path[n - 1] == dst);
+
+            return n;
+        }
 
         /* @override */
-        xkrt_device_global_id_t
+        device_global_id_t
         get_source(
-            const xkrt_device_global_id_t dst,
-            const xkrt_device_global_id_bitfield_t valid
-        ) const {
+            const device_global_id_t dst,
+            const device_global_id_bitfield_t valid
+        ) const override {
 
             /* fast way out: valid on that device already */
             if (valid & (1 << dst))
                 return dst;
 
-            // TODO
+            /* the copy is issued directly from the source: the valid device
+             * of the cheapest direct link, ignoring sources with no link */
+            device_global_id_t src = UNSPECIFIED_DEVICE_GLOBAL_ID;
+            uint64_t src_cost = INFINITE_COST;
+            for (device_global_id_t i = 0 ; i < this->ndevices ; ++i)
+            {
+                if (!(valid & (1 << i)))
+                    continue ;
+                const uint64_t cost = this->get_link_cost(i, dst);
+                if (cost < src_cost)
+                {
+                    src = i;
+                    src_cost = cost;
+                }
+            }
+            if (src != UNSPECIFIED_DEVICE_GLOBAL_ID)
+                return src;
 
             /* get any random device */
-            return (xkrt_device_global_id_t) (__random_set_bit(valid) - 1);
+            return (device_global_id_t) (__random_set_bit(valid) - 1);
+        }
+
+        /* @override */
+        void
+        transfer_begin(
+            const device_global_id_t src,
+            const device_global_id_t dst
+        ) override {
+            this->pending[src][dst].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /* @override */
+        void
+        transfer_end(
+            const device_global_id_t src,
+            const device_global_id_t dst
+        ) override {
+            assert(this->pending[src][dst].load(std::memory_order_relaxed) > 0);
+            this->pending[src][dst].fetch_sub(1, std::memory_order_relaxed);
         }
 
 };
 
+XKRT_NAMESPACE_END
+
 # endif /* __ROUTER_CFS_HPP__ */
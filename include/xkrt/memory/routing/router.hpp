@@ -58,6 +58,47 @@ class Router
             const device_global_id_bitfield_t valid
         ) const = 0;
 
+        /**
+         *  Retrieve the sources to use for a data transfer of 'size' bytes to
+         *  'dst' where the valid sources are amongst the 'valid' bitfield.
+         *  The transfer may be split across several sources, 'shares[i]' being
+         *  the fraction of the transfer to fetch from 'srcs[i]'.
+         *  Returns the number of sources, by default a single one.
+         */
+        virtual int
+        get_sources(
+            const device_global_id_t dst,
+            const device_global_id_bitfield_t valid,
+            const size_t size,
+            device_global_id_t srcs[XKRT_ROUTER_SPLIT_MAX],
+            double shares[XKRT_ROUTER_SPLIT_MAX]
+        ) const {
+            (void) size;
+            srcs[0] = this->get_source(dst, valid);
+            shares[0] = 1.0;
+            return 1;
+        }
+
+        /* notify that a transfer from 'src' to 'dst' is starting */
+        virtual void
+        transfer_begin(
+            const device_global_id_t src,
+            const device_global_id_t dst
+        ) {
+            (void) src;
+            (void) dst;
+        }
+
+        /* notify that a transfer from 'src' to 'dst' completed */
+        virtual void
+        transfer_end(
+            const device_global_id_t src,
+            const device_global_id_t dst
+        ) {
+            (void) src;
+            (void) dst;
+        }
+
 };
 
 XKRT_NAMESPACE_END
@@ -48,7 +48,10 @@
 # include <xkrt/memory/access/coherency-controller.hpp>
 # include <xkrt/memory/access/common/interval-set.hpp>
 # include <xkrt/memory/register.h>
+# include <xkrt/memory/registered-segments.hpp>
 # include <xkrt/memory/routing/router-affinity.hpp>
+# include <xkrt/memory/routing/router-bandwidth.hpp>
+# include <xkrt/memory/routing/router-cfs.hpp>
 # include <xkrt/stats/stats.h>
 # include <xkrt/sync/spinlock.h>
 # include <xkrt/task/task.hpp>
@@ -87,6 +90,7 @@ struct  runtime_t
         task_format_id_t host_capture;             ///< Host capture task format ID
         task_format_id_t memory_copy_async;        ///< Async memory copy task format ID
         task_format_id_t memory_touch_async;       ///< Async memory touch task format ID
+        task_format_id_t memory_lock_async;        ///< Async memory lock task format ID
         task_format_id_t memory_register_async;    ///< Async memory registration format ID
         task_format_id_t memory_unregister_async;  ///< Async memory unregistration format ID
         task_format_id_t file_read_async;          ///< Async file read task format ID
@@ -95,10 +99,13 @@ struct  runtime_t
 
     conf_t conf;  ///< User configuration
 
-    RouterAffinity router;  ///< Memory router used by the MCC
+    RouterAffinity router_affinity; ///< Router based on the drivers perf ranks
+    RouterCFS router_cfs;           ///< Router based on the links cost and occupancy
+    RouterBandwidth router_bandwidth;   ///< Router based on the links bandwidth measured at run time
+    Router * router;                ///< Memory router used by the MCC, selected by the conf
 
     # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
-    std::map<uintptr_t, size_t> registered_memory;  ///< Map of registered memory segments (addr -> size)
+    RegisteredSegments registered_memory;  ///< Registered memory segments, read without locking by transfers
     # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
 
     # if XKRT_MEMORY_REGISTER_ASSISTED
@@ -107,6 +114,9 @@ struct  runtime_t
 
     hwloc_topology_t topology;  ///< Hardware locality topology (read-only, initialized at startup)
 
+    /// Direct-mapped cache of the NUMA node holding host pages, as (page << 8) | (node + 1)
+    std::atomic<uint64_t> host_numa_nodes[XKRT_HOST_NUMA_CACHE_SIZE];
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     // PUBLIC INTERFACES //
     //////////////////////////////////////////////////////////////////////////////////////////////
@@ -356,13 +366,25 @@ struct  runtime_t
     ///////////////////////
 
     /**
-     * @brief Ensure chunk0 is preallocated on the device
+     * @brief Ensure the memory pool of the device is initialized: either
+     * preallocated entirely, or set empty to grow on demand
      *
      * @param device_global_id Global device identifier
      * @param memory_id Device memory index
      */
     void memory_device_preallocate_ensure(const device_global_id_t device_global_id, const int memory_id);
 
+    /**
+     * @brief Grow the memory pool of the device by a new segment of at least
+     * `size` bytes, within the limit of the pool
+     *
+     * @param device_global_id Global device identifier
+     * @param size Size in bytes that the new segment must hold
+     * @param memory_id Device memory index
+     * @return 1 if the pool grew, 0 otherwise
+     */
+    int memory_device_grow(const device_global_id_t device_global_id, const size_t size, const int memory_id);
+
     /**
      * @brief Allocate memory on a specific device memory bank
      *
@@ -382,6 +404,16 @@ struct  runtime_t
      */
     area_chunk_t * memory_device_allocate(const device_global_id_t device_global_id, const size_t size);
 
+    /**
+     * @brief Get a snapshot of the allocator state of a device memory:
+     * usage, free chunks, fragmentation and allocation latencies
+     *
+     * @param device_global_id Global device identifier
+     * @param memory_id Device memory index
+     * @param stats Filled with the snapshot
+     */
+    void memory_device_stats(const device_global_id_t device_global_id, const int memory_id, area_stats_t * stats);
+
     /**
      * @brief Deallocate a device memory chunk
      *
@@ -415,6 +447,21 @@ struct  runtime_t
      */
     void memory_host_deallocate(const device_global_id_t device_global_id, void * mem, const size_t size);
 
+    /**
+     * @brief Get the memory area of the host device (one per NUMA node)
+     * holding the page of the given address
+     *
+     * NUMA nodes are placement areas of the single host device: coherence is
+     * tracked per device, not per node, and this is only used to schedule
+     * host tasks near their data. Results are cached per page, so a page
+     * migrated by the OS may be reported on its former node.
+     *
+     * @param ptr Host memory pointer
+     * @return Memory index (bank) of the host device (0 if it has a single
+     *  one), or -1 if the page is not resident yet
+     */
+    int memory_host_numa_node(const void * ptr);
+
     /**
      * @brief Allocate unified memory accessible by both host and device
      *
@@ -1329,6 +1376,14 @@ struct  runtime_t
         struct {
             stats_int_t registered;     ///< Memory regions registered
             stats_int_t unregistered;   ///< Memory regions unregistered
+            stats_int_t locked;         ///< Memory regions locked before registration
+            struct {
+                stats_int_t merged;     ///< Forward transfers saved by merging them
+            } forwards;
+            struct {
+                stats_int_t copies;     ///< Copies launched by the paged coherency controller
+                stats_int_t pages;      ///< Pages fetched by these copies
+            } paged;
             struct {
                 struct {
                     stats_int_t device;  ///< Device-side advised allocations
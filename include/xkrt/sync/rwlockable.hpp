@@ -0,0 +1,126 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+#ifndef __RWLOCKABLE_HPP__
+# define __RWLOCKABLE_HPP__
+
+# include <xkrt/support.h>
+# include <xkrt/sync/mem.h>
+
+# include <atomic>
+# include <assert.h>
+# include <stdint.h>
+
+/**
+ *  An abstract object that can be locked exclusively (writers) or in a shared
+ *  way (readers).  Writers have priority: once a writer is waiting, new
+ *  readers spin until it released the lock, so structural updates are not
+ *  starved by a continuous flow of lookups.
+ */
+class RWLockable {
+
+    private:
+        /* -1 if locked exclusively, else the number of readers */
+        std::atomic<int32_t> state;
+
+        /* number of writers waiting for the lock */
+        std::atomic<int32_t> writers;
+
+    public:
+        RWLockable() : state(0), writers(0) {}
+        ~RWLockable() {}
+
+    public:
+
+        inline void
+        lock(void)
+        {
+            this->writers.fetch_add(1, std::memory_order_relaxed);
+            while (1)
+            {
+                int32_t expected = 0;
+                if (this->state.compare_exchange_weak(expected, -1, std::memory_order_acquire, std::memory_order_relaxed))
+                    break ;
+                mem_pause();
+            }
+            this->writers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        inline void
+        unlock(void)
+        {
+            assert(this->state.load(std::memory_order_relaxed) == -1);
+            this->state.store(0, std::memory_order_release);
+        }
+
+        inline void
+        lock_shared(void)
+        {
+            while (1)
+            {
+                if (this->writers.load(std::memory_order_relaxed) == 0)
+                {
+                    int32_t expected = this->state.load(std::memory_order_relaxed);
+                    if (expected >= 0 && this->state.compare_exchange_weak(expected, expected + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                        break ;
+                }
+                mem_pause();
+            }
+        }
+
+        inline void
+        unlock_shared(void)
+        {
+            assert(this->state.load(std::memory_order_relaxed) > 0);
+            this->state.fetch_sub(1, std::memory_order_release);
+        }
+
+        /* true if locked exclusively */
+        bool
+        is_locked(void) const
+        {
+            return this->state.load(std::memory_order_relaxed) == -1;
+        }
+
+        /* true if locked, either exclusively or shared */
+        bool
+        is_locked_shared(void) const
+        {
+            return this->state.load(std::memory_order_relaxed) != 0;
+        }
+};
+
+#endif /* __RWLOCKABLE_HPP__ */
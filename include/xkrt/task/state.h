@@ -47,7 +47,7 @@ typedef enum    xkrt_task_state_t
     TASK_STATE_DATA_FETCHED     = 3,    // task_t data is fetched, routine can execute
     TASK_STATE_EXECUTING        = 4,    // task_t routine executes
     TASK_STATE_COMPLETED        = 5,    // task_t completed, dependences can be resolved (kernel executed)
-    TASK_STATE_DEALLOCATED      = 6,    // task_t is deallocated (virtual state, never set)
+    TASK_STATE_DEALLOCATED      = 6,    // task_t is deallocated (set when its parent domain reclaims it)
     TASK_STATE_MAX              = 7,
 }               xkrt_task_state_t;
 
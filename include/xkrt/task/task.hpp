@@ -43,6 +43,7 @@
 // # include <stdatomic.h>
 # include <atomic>
 # include <functional>
+# include <unordered_map>
 
 # include <assert.h>
 # include <stdint.h>
@@ -77,6 +78,10 @@ typedef struct  task_t
         /* parent task */
         task_t * parent;
 
+        /* closest ancestor with a dependency domain, that reclaims the task
+         * once completed - the parent, unless it has no domain */
+        task_t * domain;
+
         /* children counter - number of uncompleted children tasks */
         std::atomic<uint32_t> cc;
 
@@ -92,6 +97,9 @@ typedef struct  task_t
         /* task flags */
         task_flag_bitfield_t flags;
 
+        /* next task in the list of completed tasks of the parent domain */
+        task_t * gc_next;
+
         # if XKRT_SUPPORT_DEBUG
         char label[128];
         # endif /* XKRT_SUPPORT_DEBUG */
@@ -100,10 +108,12 @@ typedef struct  task_t
 
         task_t(task_format_id_t fmtid, task_flag_bitfield_t flags) :
             parent(NULL),
+            domain(NULL),
             cc(0),
             state { .lock = SPINLOCK_INITIALIZER, .value = TASK_STATE_ALLOCATED },
             fmtid(fmtid),
-            flags(flags)
+            flags(flags),
+            gc_next(NULL)
         {
             # if XKRT_SUPPORT_DEBUG
             strncpy(this->label, "(unamed)", sizeof(this->label));
@@ -165,17 +175,36 @@ typedef struct  task_dom_info_t
     struct {
         DependencyDomain * handle;
         DependencyDomain * interval;
-        std::vector<DependencyDomain *> blas;
+
+        /* blas matrix domains, keyed by their leading dimension in bytes
+         * (ld * sizeof(type)), so views of different types on the same
+         * memory share the same domain */
+        std::unordered_map<size_t, DependencyDomain *> blas;
+
+        /* reductions of the reduce accesses not completed yet */
+        std::vector<access_reduction_t *> reductions;
     } deps;
 
     /* memory controller for coherency - all threads may try to access this list */
     struct {
         // DependencyDomain * handle; - not implemented
         MemoryCoherencyController * interval;
-        std::vector<MemoryCoherencyController *> blas;
+
+        /* keyed by ld * sizeof(type), as for 'deps.blas' */
+        std::unordered_map<size_t, MemoryCoherencyController *> blas;
+
+        /* protects insertions/lookups in 'blas' */
+        spinlock_t lock;
     } mccs;
 
-    task_dom_info_t() : deps{}, mccs{} {}
+    /* completed children tasks, pushed by any thread and reclaimed by the
+     * thread executing the task once no dependency domain references them */
+    struct {
+        std::atomic<task_t *> completed;
+        std::atomic<uint32_t> ncompleted;
+    } gc;
+
+    task_dom_info_t() : deps{}, mccs{}, gc{} {}
 
 }               task_dom_info_t;
 
@@ -188,12 +217,26 @@ typedef struct  task_mol_info_t
     /* the task args size */
     const size_t args_size;
 
+    /* the task this one was split from, or NULL. The original task only
+     * completes (and releases its successors) once all its parts did */
+    task_t * origin;
+
+    /* number of parts of that task not completed yet, including itself */
+    std::atomic<uint32_t> parts;
+
+    /* number of times that task is still to be halved by the automatic split
+     * policy (see `conf_t::moldable_split`), or -1 if not decided yet */
+    int8_t split_depth;
+
     task_mol_info_t(
         const std::function<bool(task_t *, access_t *)> & split_condition,
         const size_t args_size = 0
     ) :
         split_condition(split_condition),
-        args_size(args_size)
+        args_size(args_size),
+        origin(NULL),
+        parts(1),
+        split_depth(-1)
     {}
 
     ~task_mol_info_t() {}
@@ -207,6 +250,17 @@ void task_dependency_resolve(
     task_access_counter_t AC
 );
 
+/* widen segment accesses to multiples of 'granularity' bytes when resolving
+ * their dependencies, so accesses sharing a coherency page are ordered */
+void task_dependency_granularity(const size_t granularity);
+
+/* reclaim completed children tasks of the passed domain task */
+void task_domain_gc(task_t * task);
+
+/* an access of a completed task, standing for reclaimed writers in
+ * dependency trees so the regions they wrote are still known */
+access_t * task_reclaimed_access(void);
+
 /* retrieve the dependency domain of the given blas matrix */
 DependencyDomain * task_get_dependency_domain_blas_matrix(
     task_t * task,
@@ -485,6 +539,13 @@ __task_precedes(
     return r;
 }
 
+/* true if the task of the access completed - dependency domains may then forget it */
+static inline bool
+__access_completed(const access_t * access)
+{
+    return (volatile task_state_t) access->task->state.value >= TASK_STATE_COMPLETED;
+}
+
 static inline void
 __access_link(access_t * pred, access_t * succ)
 {
@@ -503,6 +564,11 @@ __access_precedes(access_t * pred, access_t * succ)
     // succ has reached the maximum number of dependencies
     assert(TASK_DEP_INFO(succ->task)->wc < ((1 << (8 * sizeof(task_wait_counter_type_t))) - 1));
 
+    // a completed pred may not satisfy more dependencies, and its
+    // successors may have been reclaimed already
+    if (__access_completed(pred))
+        return false;
+
     // avoid redundant edges
     if (pred->successors.size() && pred->successors.back()->task == succ->task)
         return true;
@@ -550,6 +616,23 @@ __task_commit(
         __task_ready(task, F, args...);
 }
 
+/* push a completed task to the list of tasks its parent domain may reclaim */
+static inline void
+__task_domain_completed(
+    task_t * parent,
+    task_t * task
+) {
+    assert(parent->flags & TASK_FLAG_DOMAIN);
+    assert(task->state.value == TASK_STATE_COMPLETED);
+
+    task_dom_info_t * dom = TASK_DOM_INFO(parent);
+    dom->gc.ncompleted.fetch_add(1, std::memory_order_relaxed);
+    task_t * head = dom->gc.completed.load(std::memory_order_relaxed);
+    do {
+        task->gc_next = head;
+    } while (!dom->gc.completed.compare_exchange_weak(head, task, std::memory_order_release, std::memory_order_relaxed));
+}
+
 static inline void
 __task_fetching(
     task_wait_counter_type_t n,
@@ -93,6 +93,16 @@ class NaiveQueue : IQueue<T>
             return this->pop();
         }
 
+        /* number of objects in the queue, that may change concurrently */
+        size_t
+        size(void)
+        {
+            SPINLOCK_LOCK(this->lock);
+            const size_t n = this->list.size();
+            SPINLOCK_UNLOCK(this->lock);
+            return n;
+        }
+
     private:
         std::list<T> list;
         volatile spinlock_t lock;
@@ -70,6 +70,17 @@ typedef enum    thread_state_t
 
 struct team_t;
 
+/* header of a segment of a thread tasks stack */
+typedef struct  alignas(hardware_destructive_interference_size) task_segment_t
+{
+    /* number of tasks of the segment not reclaimed yet, plus 1 while the
+     * thread allocates from that segment */
+    std::atomic<uint32_t> live;
+
+    task_segment_t() : live(1) {}
+
+}               task_segment_t;
+
 /* a thread */
 struct alignas(xkrt_pagesize) thread_t
 {
@@ -133,6 +144,12 @@ struct alignas(xkrt_pagesize) thread_t
         /* memory capacity */
         size_t memory_stack_capacity;
 
+        /* segment of the stack tasks are currently allocated from */
+        task_segment_t * memory_segment;
+
+        /* number of segments of the stack used so far */
+        size_t memory_segments_used;
+
         /* random number generator */
         std::minstd_rand rng;
 
@@ -174,6 +191,8 @@ struct alignas(xkrt_pagesize) thread_t
             deque(),
             memory_stack_bottom(NULL),
             memory_stack_capacity(THREAD_MAX_MEMORY),
+            memory_segment(NULL),
+            memory_segments_used(0),
             rng(),
             parallel_for{.index = 0},
             prev(NULL)
@@ -193,24 +212,28 @@ struct alignas(xkrt_pagesize) thread_t
             snprintf(this->implicit_task.label, sizeof(this->implicit_task.label), "implicit");
             # endif
 
-            // initialize memory allocator
+            // initialize memory allocator - the stack is aligned on the
+            // segment size, so the segment of a task is found from its address
+            static_assert((THREAD_TASKS_SEGMENT_SIZE & (THREAD_TASKS_SEGMENT_SIZE - 1)) == 0);
             while (1)
             {
-                this->memory_stack_bottom = (uint8_t *) malloc(this->memory_stack_capacity);
+                this->memory_stack_bottom = (uint8_t *) aligned_alloc(THREAD_TASKS_SEGMENT_SIZE, this->memory_stack_capacity);
                 if (this->memory_stack_bottom)
                     break ;
 
-                this->memory_stack_capacity = (size_t) (this->memory_stack_capacity * 2 / 3);
+                this->memory_stack_capacity = (size_t) (this->memory_stack_capacity * 2 / 3) & ~(THREAD_TASKS_SEGMENT_SIZE - 1);
                 if (this->memory_stack_capacity == 0)
-                    this->memory_stack_bottom = NULL;
+                    break ;
             }
-            this->memory_stack_ptr = this->memory_stack_bottom;
             assert(this->memory_stack_bottom);
+            this->memory_segment = new (this->memory_stack_bottom) task_segment_t();
+            this->memory_segments_used = 1;
+            this->memory_stack_ptr = (uint8_t *) (this->memory_segment + 1);
         }
 
         ~thread_t()
         {
-            free(this->memory_stack_ptr);
+            free(this->memory_stack_bottom);
         }
 
     public:
@@ -254,6 +277,14 @@ struct alignas(xkrt_pagesize) thread_t
         task_t * allocate_task(const size_t size);
         void deallocate_all_tasks(void);
 
+        /* release the memory of a task allocated by any thread */
+        static void deallocate_task(task_t * task);
+
+    private:
+
+        /* switch to a segment of the stack with no live tasks */
+        void memory_segment_next(void);
+
     /////////////////
     // TASK HELPER //
     /////////////////
@@ -278,8 +309,15 @@ struct alignas(xkrt_pagesize) thread_t
             Args... args
         ) {
             assert(this->current_task);
+
+            // reclaim completed children now and then
+            if (XKRT_TASK_GC_THRESHOLD && (this->current_task->flags & TASK_FLAG_DOMAIN))
+                if (TASK_DOM_INFO(this->current_task)->gc.ncompleted.load(std::memory_order_relaxed) >= XKRT_TASK_GC_THRESHOLD)
+                    task_domain_gc(this->current_task);
+
             ++this->current_task->cc;
             task->parent = this->current_task;
+            task->domain = (this->current_task->flags & TASK_FLAG_DOMAIN) ? this->current_task : this->current_task->domain;
             return __task_commit(task, F, args...);
         }
 
@@ -291,6 +329,8 @@ struct alignas(xkrt_pagesize) thread_t
             fprintf(f, "digraph G {\n");
             for (task_t * & task : tasks)
             {
+                if (task->state.value == TASK_STATE_DEALLOCATED)
+                    continue ;
                 fprintf(f, "    \"%p\" [label=\"%s\"] ;\n", (void *) task, task->label);
                 if (task->flags & TASK_FLAG_DEPENDENT)
                 {
@@ -313,6 +353,8 @@ struct alignas(xkrt_pagesize) thread_t
             fprintf(f, "digraph G {\n");
             for (task_t * & task : tasks)
             {
+                if (task->state.value == TASK_STATE_DEALLOCATED)
+                    continue ;
                 if (task->flags & TASK_FLAG_DEPENDENT)
                 {
                     task_dep_info_t * dep = TASK_DEP_INFO(task);
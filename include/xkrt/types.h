@@ -47,7 +47,9 @@
 # include <xkrt/driver/queue-command-list-counter.h>
 # include <xkrt/driver/queue-type.h>
 # include <xkrt/driver/driver-type.h>
+# include <xkrt/memory/access/blas/matrix-halo.h>
 # include <xkrt/memory/access/blas/matrix-storage.h>
+# include <xkrt/memory/access/blas/matrix-uplo.h>
 # include <xkrt/memory/access/concurrency.h>
 # include <xkrt/memory/access/mode.h>
 # include <xkrt/memory/access/scope.h>
@@ -79,7 +81,9 @@ typedef xkrt_access_concurrency_t               access_concurrency_t;
 typedef xkrt_access_mode_t                      access_mode_t;
 typedef xkrt_access_scope_t                     access_scope_t;
 typedef xkrt_access_type_t                      access_type_t;
+typedef xkrt_matrix_halo_t                      matrix_halo_t;
 typedef xkrt_matrix_storage_t                   matrix_storage_t;
+typedef xkrt_matrix_uplo_t                      matrix_uplo_t;
 
 typedef xkrt_task_formats_t                     task_formats_t;
 typedef xkrt_task_format_t                      task_format_t;
@@ -143,6 +143,104 @@ __parse_gpu_mem_percent(conf_t * conf, char const * value)
         conf->device.gpu_mem_percent = (float) atof(value);
 }
 
+static void
+__parse_gpu_mem_grow(conf_t * conf, char const * value)
+{
+    if (value)
+        conf->device.pool_grow_size = (size_t) atoll(value);
+}
+
+static void
+__parse_moldable_split(conf_t * conf, char const * value)
+{
+    if (value)
+    {
+        if (strcmp(value, "user") == 0)
+            conf->moldable_split = XKRT_MOLDABLE_SPLIT_POLICY_USER;
+        else if (strcmp(value, "auto") == 0)
+            conf->moldable_split = XKRT_MOLDABLE_SPLIT_POLICY_AUTO;
+        else
+            LOGGER_FATAL("Invalid moldable split policy `%s` - must be `user` or `auto`", value);
+    }
+}
+
+static void
+__parse_moldable_split_min_size(conf_t * conf, char const * value)
+{
+    if (value)
+        conf->moldable_split_min_size = (size_t) atoll(value);
+}
+
+static void
+__parse_router(conf_t * conf, char const * value)
+{
+    if (value)
+    {
+        if (strcmp(value, "affinity") == 0)
+            conf->router = XKRT_ROUTER_TYPE_AFFINITY;
+        else if (strcmp(value, "cfs") == 0)
+            conf->router = XKRT_ROUTER_TYPE_CFS;
+        else if (strcmp(value, "bandwidth") == 0)
+            conf->router = XKRT_ROUTER_TYPE_BANDWIDTH;
+        else
+            LOGGER_FATAL("Invalid router `%s` - must be `affinity`, `cfs` or `bandwidth`", value);
+    }
+}
+
+static void
+__parse_router_split_threshold(conf_t * conf, char const * value)
+{
+    if (value)
+        conf->router_split_threshold = (size_t) atoll(value);
+}
+
+static void
+__parse_segment_coherency(conf_t * conf, char const * value)
+{
+    if (value)
+    {
+        if (strcmp(value, "tree") == 0)
+            conf->segment_coherency = XKRT_SEGMENT_COHERENCY_TREE;
+        else if (strcmp(value, "paged") == 0)
+            conf->segment_coherency = XKRT_SEGMENT_COHERENCY_PAGED;
+        else
+            LOGGER_FATAL("Invalid segment coherency `%s` - must be `tree` or `paged`", value);
+    }
+}
+
+static void
+__parse_segment_page_size(conf_t * conf, char const * value)
+{
+    if (value)
+    {
+        const size_t page_size = (size_t) atoll(value);
+        if (page_size == 0 || (page_size & (page_size - 1)))
+            LOGGER_FATAL("Invalid segment page size `%s` - must be a power of 2", value);
+        conf->segment_page_size = page_size;
+    }
+}
+
+static void
+__parse_defrag_threshold(conf_t * conf, char const * value)
+{
+    if (value)
+        conf->device.defrag_threshold = (float) atof(value);
+}
+
+static void
+__parse_eviction_policy(conf_t * conf, char const * value)
+{
+    if (value)
+    {
+        if (strcmp(value, "lru") == 0)
+            conf->device.eviction_policy = XKRT_MEMORY_EVICTION_POLICY_LRU;
+        else if (strcmp(value, "clean-first") == 0)
+            conf->device.eviction_policy = XKRT_MEMORY_EVICTION_POLICY_CLEAN_FIRST;
+        else
+            LOGGER_FATAL("Invalid eviction policy `%s` - must be `lru` or `clean-first`", value);
+    }
+}
+
 static void
 __parse_offloader_capacity(conf_t * conf, char const * value)
 {
@@ -223,6 +321,13 @@ __parse_register_overflow(conf_t * conf, char const * value)
         conf->protect_registered_memory_overflow = atoi(value);
 }
 
+static void
+__parse_register_mlock(conf_t * conf, char const * value)
+{
+    if (value)
+        conf->memory_register_mlock = atoi(value);
+}
+
 static void
 __parse_pause_progress_th(conf_t * conf, char const * value)
 {
@@ -244,6 +349,20 @@ __parse_task_prefetch(conf_t * conf, char const * value)
         conf->enable_prefetching = atoi(value);
 }
 
+static void
+__parse_task_prefetch_mem_percent(conf_t * conf, char const * value)
+{
+    if (value)
+        conf->prefetch_mem_percent = (float) atof(value);
+}
+
+static void
+__parse_numa_scheduling(conf_t * conf, char const * value)
+{
+    if (value)
+        conf->enable_numa_scheduling = atoi(value);
+}
+
 void __parse_help(conf_t * conf, char const * value);
 
 extern char ** environ;
@@ -261,17 +380,25 @@ static conf_parse_t CONF_PARSE[] = {
     {"D2D_PER_QUEUE",                   __parse_d2d_per_queue,     "Number of concurrent copies per D2D queue before throttling device-thread"},
     {"D2H_PER_QUEUE",                   __parse_d2h_per_queue,     "Number of concurrent copies per D2H queue before throttling device-thread"},
     {"DEFAULT_MATH",                     NULL,                       NULL},
+    {"DEFRAG_THRESHOLD",                 __parse_defrag_threshold,   "Fragmentation of the free device memory (1 - largest free block / free bytes, in [0..1]) from which an allocation that failed relocates chunks to make room before evicting - 1 disables it"},
     {"DRIVERS",                          __parse_drivers,            "Exemple: 'cuda,4;hip,2;host,3' - will enable drivers cuda, hip and host respectively with 4, 2, and 3 threads per device."},
-    {"GPU_MEM_PERCENT",                  __parse_gpu_mem_percent,    "%% of total memory to allocate initially per GPU (in ]0..100["},
+    {"EVICTION_POLICY",                  __parse_eviction_policy,    "Device memory eviction policy: 'lru' (default) evicts least recently used allocations first, 'clean-first' evicts allocations still valid elsewhere first"},
+    {"GPU_MEM_GROW",                     __parse_gpu_mem_grow,       "Size in bytes by which the memory pool of a GPU grows on demand, or 0 to allocate the whole pool initially"},
+    {"GPU_MEM_PERCENT",                  __parse_gpu_mem_percent,    "%% of total memory that the memory pool of a GPU may use (in ]0..100["},
     {"H2D_PER_QUEUE",                   __parse_h2d_per_queue,     "Number of concurrent copies per H2D queue before throttling device-thread"},
     {"HELP",                             __parse_help,               "Show this helper"},
     {"KERN_PER_QUEUE",                  __parse_kern_per_queue,    "Number of concurrent kernels per KERN queue before throttling device-thread"},
     {"MERGE_TRANSFERS",                  __parse_merge_transfers,    "Merge memory transfers over continuous virtual memory"},
+    {"MOLDABLE_SPLIT",                   __parse_moldable_split,     "Policy to split moldable tasks: 'user' (default) splits as long as the task split condition holds, 'auto' also requires idle threads/devices to execute the parts, and splits in as many parts as there are"},
+    {"MOLDABLE_SPLIT_MIN_SIZE",          __parse_moldable_split_min_size, "Size in bytes bellow which the 'auto' moldable split policy does not split an access"},
     {"NGPUS",                            __parse_ngpus,              "Number of gpus to use"},
     {"MEMORY_REGISTER_PROTECT_OVERFLOW", __parse_register_overflow,  "Split memory transfers to avoid overflow over registered/unregistered memory that causes cuda to crash"},
+    {"MEMORY_REGISTER_MLOCK",            __parse_register_mlock,     "Boolean to lock and prefault host pages with 'mlock' before registering them to the drivers - asynchronous registrations lock their chunks in parallel"},
     {"PAUSE_PROGRESSION_THREADS",        __parse_pause_progress_th,  "When progression threads have nothing else to do but poll pending commands, put it to sleep until the completion of a random command of a random steam."},
     {"BUSY_POLLING",                     __parse_busy_polling,       "Whether progression threads should pause when there is no tasks and no ready/pending commands"},
     {"TASK_PREFETCH",                    __parse_task_prefetch,      "If enabled, after completing a task, initiate data transfers for all its WaR successors that place of execution is already known (else, transfers only starts once the successor is ready)."},
+    {"TASK_PREFETCH_MEM_PERCENT",        __parse_task_prefetch_mem_percent, "%% of the device memory that may hold prefetched data not yet used by its task (in ]0..100])"},
+    {"NUMA_SCHEDULING",                 __parse_numa_scheduling,    "Boolean to spread host threads over the NUMA nodes, and execute host tasks on a thread of the node holding their first access (placement only, coherence is per device)"},
     {"NQUEUES_D2D",                     __parse_nqueues_d2d,       "Number of D2D queues per device"},
     {"NQUEUES_D2H",                     __parse_nqueues_d2h,       "Number of D2H queues per device"},
     {"NQUEUES_H2D",                     __parse_nqueues_h2d,       "Number of H2D queues per device"},
@@ -280,6 +407,10 @@ static conf_parse_t CONF_PARSE[] = {
     {"NQUEUES_FW",                      __parse_nqueues_fw,        "Number of FW queues per device"},
     {"OFFLOADER_CAPACITY",              __parse_offloader_capacity, "Maximum number of pending commands per queue"},
     {"PRECISION",                       NULL,                       NULL},
+    {"ROUTER",                          __parse_router,             "Data transfer router: 'affinity' (default) picks a source of best perf rank, 'cfs' picks the source of the cheapest direct link, accounting for pending transfers, 'bandwidth' picks the source of highest measured bandwidth"},
+    {"ROUTER_SPLIT_THRESHOLD",          __parse_router_split_threshold, "Size in bytes from which the 'bandwidth' router splits a transfer across several sources"},
+    {"SEGMENT_COHERENCY",               __parse_segment_coherency,  "Memory coherency controller of segment accesses: 'tree' (default) tracks validity per interval, 'paged' tracks validity per page, for accesses to many small scattered points"},
+    {"SEGMENT_PAGE_SIZE",               __parse_segment_page_size,  "Size in bytes of a page of the 'paged' segment coherency controller (a power of 2)"},
     {"STATS",                           __parse_stats,              "Boolean to dump stats on deinit"},
     {"USE_P2P",                         __parse_p2p,                "Boolean to enable/disable the use of p2p transfers"},
     {"WARMUP",                          __parse_warmup,             "Boolean to enable/disable threads/devices warmup on runtime initialization"},
@@ -344,14 +475,26 @@ conf_t::init(void)
 {
     // set default conf
     this->report_stats_on_deinit                = 0;
+    this->router                                = XKRT_ROUTER_TYPE_AFFINITY;
+    this->router_split_threshold                = (size_t) 16 * 1024 * 1024;
+    this->segment_coherency                     = XKRT_SEGMENT_COHERENCY_TREE;
+    this->segment_page_size                     = (size_t) 4096;
+    this->moldable_split                        = XKRT_MOLDABLE_SPLIT_POLICY_USER;
+    this->moldable_split_min_size               = (size_t) 64 * 1024;
     this->device.ngpus                          = (uint8_t)-1;
     this->device.gpu_mem_percent                = (float) 90.0;
+    this->device.pool_grow_size                 = (size_t) 256 * 1024 * 1024;
+    this->device.eviction_policy                = XKRT_MEMORY_EVICTION_POLICY_LRU;
+    this->device.defrag_threshold               = (float) 0.5;
     this->device.use_p2p                        = true;
     this->merge_transfers                       = false;
     this->protect_registered_memory_overflow    = true;
+    this->memory_register_mlock                 = false;
     this->enable_progress_thread_pause          = true;
     this->enable_busy_polling                   = false;
     this->enable_prefetching                    = false;
+    this->prefetch_mem_percent                  = (float) 25.0;
+    this->enable_numa_scheduling                = false;
     this->warmup                                = false;
 
     //////////////////
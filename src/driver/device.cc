@@ -37,7 +37,9 @@
 **/
 
 # include <xkrt/driver/device.hpp>
+# include <xkrt/logger/metric.h>
 # include <xkrt/thread/team.h>
+# include <xkrt/thread/thread.h>
 
 XKRT_NAMESPACE_USE;
 
@@ -45,16 +47,158 @@ XKRT_NAMESPACE_USE;
 // MEMORY MANAGMENT //
 //////////////////////
 
+/* size class (fl, sl) of a free chunk of `size` bytes */
+static inline void
+area_mapping_insert(const size_t size, int * fl, int * sl)
+{
+    const size_t units = size / AREA_ALIGN;
+    if (units < AREA_SL_COUNT)
+    {
+        *fl = 0;
+        *sl = (int) units;
+    }
+    else
+    {
+        const int l = 63 - __builtin_clzll(units);
+        *fl = l - AREA_SL_LOG2 + 1;
+        *sl = (int) ((units >> (l - AREA_SL_LOG2)) - AREA_SL_COUNT);
+    }
+    assert(*fl < AREA_FL_COUNT);
+}
+
+/* smallest size class (fl, sl) which chunks are all large enough for `size` bytes */
+static inline void
+area_mapping_search(const size_t size, int * fl, int * sl)
+{
+    size_t units = size / AREA_ALIGN;
+    if (units >= AREA_SL_COUNT)
+        units += ((size_t) 1 << (63 - __builtin_clzll(units) - AREA_SL_LOG2)) - 1;
+    area_mapping_insert(units * AREA_ALIGN, fl, sl);
+}
+
+/* first non-empty class from (fl, sl), using the bitmaps */
+static inline area_chunk_t *
+area_find_free(area_t * area, int fl, int sl)
+{
+    uint32_t sl_map = area->sl_bitmap[fl] & (~0U << sl);
+    if (sl_map == 0)
+    {
+        const uint64_t fl_map = (fl + 1 < AREA_FL_COUNT) ? (area->fl_bitmap & (~0ULL << (fl + 1))) : 0;
+        if (fl_map == 0)
+            return NULL;
+        fl = __builtin_ctzll(fl_map);
+        sl_map = area->sl_bitmap[fl];
+        assert(sl_map);
+    }
+    sl = __builtin_ctz(sl_map);
+    return area->free_chunk_lists[fl][sl];
+}
+
+static inline void
+area_free_insert(area_t * area, area_chunk_t * chunk)
+{
+    int fl, sl;
+    area_mapping_insert(chunk->size, &fl, &sl);
+
+    area_chunk_t * head = area->free_chunk_lists[fl][sl];
+    chunk->freeprev = NULL;
+    chunk->freelink = head;
+    if (head)
+        head->freeprev = chunk;
+    area->free_chunk_lists[fl][sl] = chunk;
+
+    area->fl_bitmap     |= (1ULL << fl);
+    area->sl_bitmap[fl] |= (uint16_t) (1U << sl);
+}
+
+static inline void
+area_free_remove(area_t * area, area_chunk_t * chunk)
+{
+    int fl, sl;
+    area_mapping_insert(chunk->size, &fl, &sl);
+
+    if (chunk->freelink)
+        chunk->freelink->freeprev = chunk->freeprev;
+    if (chunk->freeprev)
+        chunk->freeprev->freelink = chunk->freelink;
+    else
+    {
+        assert(area->free_chunk_lists[fl][sl] == chunk);
+        area->free_chunk_lists[fl][sl] = chunk->freelink;
+        if (chunk->freelink == NULL)
+        {
+            area->sl_bitmap[fl] &= (uint16_t) ~(1U << sl);
+            if (area->sl_bitmap[fl] == 0)
+                area->fl_bitmap &= ~(1ULL << fl);
+        }
+    }
+    chunk->freelink = NULL;
+    chunk->freeprev = NULL;
+}
+
+/* get a chunk descriptor */
+static inline area_chunk_t *
+area_chunk_new(area_t * area)
+{
+    area_chunk_t * chunk = area->unused_chunk_list;
+    if (chunk)
+        area->unused_chunk_list = chunk->freelink;
+    else
+    {
+        chunk = (area_chunk_t *) malloc(sizeof(area_chunk_t));
+        assert(chunk);
+    }
+    return chunk;
+}
+
+/* release a chunk descriptor, for reuse on the next split */
+static inline void
+area_chunk_delete(area_t * area, area_chunk_t * chunk)
+{
+    chunk->freelink = area->unused_chunk_list;
+    area->unused_chunk_list = chunk;
+}
+
+/* a free chunk covering the whole segment */
+static inline area_chunk_t *
+area_segment_chunk_new(area_t * area, area_segment_t * segment, int area_idx)
+{
+    area_chunk_t * chunk = area_chunk_new(area);
+    chunk->ptr          = segment->ptr;
+    chunk->size         = segment->size & ~(AREA_ALIGN - 1);
+    chunk->state        = XKRT_ALLOC_CHUNK_STATE_FREE;
+    chunk->prev         = NULL;
+    chunk->next         = NULL;
+    chunk->freelink     = NULL;
+    chunk->freeprev     = NULL;
+    chunk->use_counter  = 0;
+    chunk->area_idx     = area_idx;
+    chunk->pin_counter  = 0;
+    chunk->last_use.store(0, std::memory_order_relaxed);
+    if (chunk->size)
+        area_free_insert(area, chunk);
+    return chunk;
+}
+
 void
 device_t::memory_reset_on(int area_idx)
 {
     area_t * area = &(this->memories[area_idx].area);
 
+    area->fl_bitmap = 0;
+    memset(area->sl_bitmap, 0, sizeof(area->sl_bitmap));
+    memset(area->free_chunk_lists, 0, sizeof(area->free_chunk_lists));
+    area->idle = false;
+    area->used = 0;
+    area->clock.store(0, std::memory_order_relaxed);
+
+    /* chunks cached by the threads are no longer valid */
+    for (int tid = 0 ; tid < XKRT_MAX_THREADS_PER_DEVICE ; ++tid)
+        memset(&(this->chunk_caches[tid][area_idx]), 0, sizeof(area_chunk_cache_t));
+
     # pragma message(TODO "This is leaking")
-    area_chunk_t * chunk0 = (area_chunk_t *) malloc(sizeof(area_chunk_t));
-    assert(chunk0);
-    memcpy(chunk0, &(area->chunk0), sizeof(area_chunk_t));
-    area->free_chunk_list = chunk0;
+    for (area_segment_t * segment = area->segments ; segment ; segment = segment->next)
+        segment->first = area_segment_chunk_new(area, segment, area_idx);
 
     XKRT_STATS_INCR(this->stats.memory.freed, this->stats.memory.allocated.currently);
     XKRT_STATS_SET (this->stats.memory.allocated.currently, 0);
@@ -75,110 +219,324 @@ device_t::memory_set_chunk0(
 ) {
     area_t * area = &(this->memories[area_idx].area);
 
-    area->chunk0.ptr            = ptr;
-    area->chunk0.size           = size;
-    area->chunk0.state          = XKRT_ALLOC_CHUNK_STATE_FREE;
-    area->chunk0.prev           = NULL;
-    area->chunk0.next           = NULL;
-    area->chunk0.freelink       = NULL;
-    area->chunk0.use_counter    = 0;
+    while (area->segments)
+    {
+        area_segment_t * segment = area->segments;
+        area->segments = segment->next;
+        free(segment);
+    }
+
+    if (size)
+    {
+        area_segment_t * segment = (area_segment_t *) malloc(sizeof(area_segment_t));
+        assert(segment);
+        segment->ptr    = ptr;
+        segment->size   = size;
+        segment->first  = NULL;
+        segment->next   = NULL;
+        area->segments  = segment;
+    }
+    area->reserved  = size;
+    area->limit     = size;
 
     this->memory_reset_on(area_idx);
 }
 
+void
+device_t::memory_grow_on(
+    uintptr_t ptr,
+    size_t size,
+    int area_idx
+) {
+    area_t * area = &(this->memories[area_idx].area);
+
+    area_segment_t * segment = (area_segment_t *) malloc(sizeof(area_segment_t));
+    assert(segment);
+    segment->ptr    = ptr;
+    segment->size   = size;
+    segment->first  = area_segment_chunk_new(area, segment, area_idx);
+    segment->next   = area->segments;
+    area->segments  = segment;
+}
+
+bool
+device_t::memory_release_idle_on(
+    int area_idx,
+    uintptr_t * ptr,
+    size_t * size
+) {
+    area_t * area = &(this->memories[area_idx].area);
+    area->idle = false;
+
+    /* keep the first entirely free segment, to avoid growing again right away */
+    bool kept = false;
+    for (area_segment_t ** prev = &(area->segments) ; *prev ; prev = &((*prev)->next))
+    {
+        area_segment_t * segment = *prev;
+        area_chunk_t * chunk = segment->first;
+        if (chunk->state != XKRT_ALLOC_CHUNK_STATE_FREE || chunk->next)
+            continue ;
+        if (!kept)
+        {
+            kept = true;
+            continue ;
+        }
+
+        area_free_remove(area, chunk);
+        area_chunk_delete(area, chunk);
+        *prev = segment->next;
+        area->reserved -= segment->size;
+        *ptr  = segment->ptr;
+        *size = segment->size;
+        free(segment);
+        return true;
+    }
+    return false;
+}
+
 void
 device_t::memory_deallocate(area_chunk_t * chunk)
 {
     return this->memory_deallocate_on(chunk, chunk->area_idx);
 }
 
-void
-device_t::memory_deallocate_on(area_chunk_t * chunk, int area_idx)
+/* release the chunk to the area, coalescing it with its free neighbours - the
+ * area must be locked */
+static inline void
+area_deallocate(area_t * area, area_chunk_t * chunk)
 {
-    assert(chunk->area_idx >= 0);
-    assert(chunk->area_idx < this->nmemories);
-    area_t * area = &(this->memories[area_idx].area);
+    assert(chunk->state == XKRT_ALLOC_CHUNK_STATE_ALLOCATED);
+    chunk->state = XKRT_ALLOC_CHUNK_STATE_FREE;
+    chunk->use_counter = 0;
+    assert(area->used >= chunk->size);
+    area->used -= chunk->size;
+
+    /* merge next_chunk into chunk */
+    area_chunk_t * next_chunk = chunk->next;
+    if (next_chunk && next_chunk->state == XKRT_ALLOC_CHUNK_STATE_FREE)
+    {
+        assert(next_chunk->ptr == chunk->ptr + chunk->size);
+        area_free_remove(area, next_chunk);
+        chunk->size += next_chunk->size;
+        chunk->next = next_chunk->next;
+        if (next_chunk->next)
+            next_chunk->next->prev = chunk;
+        area_chunk_delete(area, next_chunk);
+    }
+
+    /* merge chunk into prev_chunk */
+    area_chunk_t * prev_chunk = chunk->prev;
+    if (prev_chunk && prev_chunk->state == XKRT_ALLOC_CHUNK_STATE_FREE)
+    {
+        assert(prev_chunk->ptr + prev_chunk->size == chunk->ptr);
+        area_free_remove(area, prev_chunk);
+        prev_chunk->size += chunk->size;
+        prev_chunk->next = chunk->next;
+        if (chunk->next)
+            chunk->next->prev = prev_chunk;
+        area_chunk_delete(area, chunk);
+        chunk = prev_chunk;
+    }
+
+    area_free_insert(area, chunk);
+
+    /* the whole segment is free, it may be released */
+    if (chunk->prev == NULL && chunk->next == NULL)
+        area->idle = true;
+}
+
+/* allocate a chunk of `size` bytes from the area, or return NULL - the area
+ * must be locked */
+static inline area_chunk_t *
+area_allocate(area_t * area, const size_t size, int area_idx)
+{
+    /* good fit: first chunk of the smallest class that fits for sure */
+    int fl, sl;
+    area_mapping_search(size, &fl, &sl);
+    area_chunk_t * curr = area_find_free(area, fl, sl);
+
+    /* else, the class of the size may still have a large enough chunk */
+    if (curr == NULL)
+    {
+        area_mapping_insert(size, &fl, &sl);
+        for (curr = area->free_chunk_lists[fl][sl] ; curr && curr->size < size ; curr = curr->freelink)
+            ;
+        if (curr == NULL)
+            return NULL;
+    }
+
+    assert(curr->state == XKRT_ALLOC_CHUNK_STATE_FREE);
+    assert(curr->size >= size);
+    area_free_remove(area, curr);
+
+    /* split chunk */
+    if (curr->size - size >= AREA_ALIGN)
+    {
+        area_chunk_t * remainder = area_chunk_new(area);
+        remainder->ptr         = curr->ptr + size;
+        remainder->size        = curr->size - size;
+        remainder->state       = XKRT_ALLOC_CHUNK_STATE_FREE;
+        remainder->use_counter = 0;
+        remainder->area_idx    = area_idx;
+        remainder->pin_counter = 0;
+        remainder->last_use.store(0, std::memory_order_relaxed);
+        remainder->prev        = curr;
+        remainder->next        = curr->next;
+
+        /* link remainder segment after curr */
+        if (curr->next)
+            curr->next->prev = remainder;
+        curr->next = remainder;
+        curr->size = size;
+
+        area_free_insert(area, remainder);
+    }
+
+    curr->state = XKRT_ALLOC_CHUNK_STATE_ALLOCATED;
+    area->used += curr->size;
+    if (area->used > area->peak)
+        area->peak = area->used;
+    return curr;
+}
 
-    bool delete_chunk = false;
+/* the chunks cache of the calling thread for that area, or NULL if it is not
+ * a thread of the device team */
+static inline area_chunk_cache_t *
+area_chunk_cache_get(device_t * device, int area_idx)
+{
+    thread_t * tls = thread_t::get_tls();
+    if (tls->team == NULL || tls->team != device->team)
+        return NULL;
+    assert(tls->tid >= 0);
+    assert(tls->tid < XKRT_MAX_THREADS_PER_DEVICE);
+    return &(device->chunk_caches[tls->tid][area_idx]);
+}
+
+static inline int
+area_chunk_cache_class(const size_t size)
+{
+    int fl, sl;
+    area_mapping_insert(size, &fl, &sl);
+    return fl * AREA_SL_COUNT + sl;
+}
+
+/* give all chunks of the cache back to the area - the cache must be locked */
+static inline void
+area_chunk_cache_flush(area_t * area, area_chunk_cache_t * cache)
+{
     XKRT_MUTEX_LOCK(area->lock);
     {
-        chunk->state = XKRT_ALLOC_CHUNK_STATE_FREE;
-        chunk->use_counter = 0;
+        for (int b = 0 ; b < AREA_CACHE_BINS ; ++b)
+        {
+            for (int i = 0 ; i < cache->bins[b].n ; ++i)
+                area_deallocate(area, cache->bins[b].chunks[i]);
+            cache->bins[b].n = 0;
+        }
+    }
+    XKRT_MUTEX_UNLOCK(area->lock);
+    cache->nfreed = 0;
+}
+
+/* get a cached chunk of at least `size` bytes - the cache must be locked */
+static inline area_chunk_t *
+area_chunk_cache_pop(area_chunk_cache_t * cache, const size_t size)
+{
+    const int cls = area_chunk_cache_class(size);
+    auto & bin = cache->bins[cls % AREA_CACHE_BINS];
+    if (bin.cls != cls)
+        return NULL;
 
-        /* can we merge chunk into next_chunk ? */
-        area_chunk_t * next_chunk = chunk->next;
-        if (next_chunk && next_chunk->state == XKRT_ALLOC_CHUNK_STATE_FREE)
+    for (int i = bin.n - 1 ; i >= 0 ; --i)
+    {
+        area_chunk_t * chunk = bin.chunks[i];
+        if (chunk->size >= size)
         {
-            next_chunk->prev = chunk->prev;
-            if (chunk->prev)
-                chunk->prev->next = next_chunk;
-            next_chunk->size += chunk->size;
-            assert(next_chunk->ptr > chunk->ptr);
-            next_chunk->ptr = chunk->ptr;
-            delete_chunk = true;
+            bin.chunks[i] = bin.chunks[--bin.n];
+            return chunk;
         }
+    }
+    return NULL;
+}
 
-        area_chunk_t * prev_chunk = chunk->prev;
-        if (prev_chunk)
+/* cache the chunk, releasing chunks of another class or of a full bin to the
+ * area - the cache must be locked */
+static inline void
+area_chunk_cache_push(area_t * area, area_chunk_cache_t * cache, area_chunk_t * chunk)
+{
+    const int cls = area_chunk_cache_class(chunk->size);
+    auto & bin = cache->bins[cls % AREA_CACHE_BINS];
+    if (bin.n && (bin.cls != cls || bin.n == AREA_CACHE_DEPTH))
+    {
+        XKRT_MUTEX_LOCK(area->lock);
         {
-            /*  if prev_chunk is a free chunk and 'delete_chunk' is true,
-             *  then we have to merge prev and next */
-            if (prev_chunk->state == XKRT_ALLOC_CHUNK_STATE_FREE)
-            {
-                if (delete_chunk)
-                {
-                    assert(prev_chunk->ptr < chunk->ptr);
-                    assert(prev_chunk->ptr < next_chunk->ptr);
-
-                    prev_chunk->size += next_chunk->size;
-                    prev_chunk->next = next_chunk->next;
-                    if (next_chunk->next)
-                        next_chunk->next->prev = prev_chunk;
-                    prev_chunk->freelink = next_chunk->freelink;
-                    free(next_chunk);
-                }
-                else
-                {
-                    /* merge chunk into prev_chunk */
-                    assert(prev_chunk->ptr < chunk->ptr);
-                    prev_chunk->next = chunk->next;
-                    if (chunk->next)
-                        chunk->next->prev = prev_chunk;
-                    prev_chunk->size += chunk->size;
-                    delete_chunk = true;
-                }
-            }
-            else if (!delete_chunk)
-            {
-                /* free_chunk_list is ordered by increasing adress: search form prev the previous bloc */
-                while (prev_chunk && prev_chunk->state != XKRT_ALLOC_CHUNK_STATE_FREE)
-                    prev_chunk = prev_chunk->prev;
-
-                if (!prev_chunk)
-                {
-                    chunk->freelink = area->free_chunk_list;
-                    area->free_chunk_list = chunk;
-                }
-                else
-                {
-                    chunk->freelink = prev_chunk->freelink;
-                    prev_chunk->freelink = chunk;
-                }
-            }
+            for (int i = 0 ; i < bin.n ; ++i)
+                area_deallocate(area, bin.chunks[i]);
         }
-        else if (!delete_chunk)
+        XKRT_MUTEX_UNLOCK(area->lock);
+        bin.n = 0;
+    }
+    bin.cls = cls;
+    chunk->use_counter = 0;
+    bin.chunks[bin.n++] = chunk;
+
+    if (++cache->nfreed >= AREA_CACHE_FLUSH_PERIOD)
+        area_chunk_cache_flush(area, cache);
+}
+
+void
+device_t::memory_cache_flush(void)
+{
+    for (int i = 0 ; i < this->nmemories ; ++i)
+    {
+        area_chunk_cache_t * cache = area_chunk_cache_get(this, i);
+        if (cache)
         {
-            chunk->freelink = area->free_chunk_list;
-            area->free_chunk_list = chunk;
+            SPINLOCK_LOCK(cache->lock);
+            area_chunk_cache_flush(&(this->memories[i].area), cache);
+            SPINLOCK_UNLOCK(cache->lock);
         }
     }
-    XKRT_MUTEX_UNLOCK(area->lock);
+}
 
-    XKRT_STATS_INCR(this->stats.memory.freed, chunk->size);
-    XKRT_STATS_DECR(this->stats.memory.allocated.currently, chunk->size);
+/* give the chunks cached by all threads of the device back to the area */
+static inline void
+area_chunk_caches_flush(device_t * device, int area_idx)
+{
+    area_t * area = &(device->memories[area_idx].area);
+    for (int tid = 0 ; tid < XKRT_MAX_THREADS_PER_DEVICE ; ++tid)
+    {
+        area_chunk_cache_t * cache = &(device->chunk_caches[tid][area_idx]);
+        SPINLOCK_LOCK(cache->lock);
+        area_chunk_cache_flush(area, cache);
+        SPINLOCK_UNLOCK(cache->lock);
+    }
+}
+
+void
+device_t::memory_deallocate_on(area_chunk_t * chunk, int area_idx)
+{
+    assert(chunk->area_idx >= 0);
+    assert(chunk->area_idx < this->nmemories);
+    area_t * area = &(this->memories[area_idx].area);
 
-    if (delete_chunk)
-        free(chunk);
+    const size_t size = chunk->size;
+
+    area_chunk_cache_t * cache = area_chunk_cache_get(this, area_idx);
+    if (cache)
+    {
+        SPINLOCK_LOCK(cache->lock);
+        area_chunk_cache_push(area, cache, chunk);
+        SPINLOCK_UNLOCK(cache->lock);
+    }
+    else
+    {
+        XKRT_MUTEX_LOCK(area->lock);
+        area_deallocate(area, chunk);
+        XKRT_MUTEX_UNLOCK(area->lock);
+    }
+
+    XKRT_STATS_INCR(this->stats.memory.freed, size);
+    XKRT_STATS_DECR(this->stats.memory.allocated.currently, size);
 }
 
 area_chunk_t *
@@ -189,81 +547,56 @@ device_t::memory_allocate_on(const size_t user_size, int area_idx)
     assert(area_idx < this->nmemories);
     area_t * area = &(this->memories[area_idx].area);
 
+    # if XKRT_SUPPORT_STATS
+    const uint64_t t0 = get_nanotime();
+    # endif /* XKRT_SUPPORT_STATS */
+
     /* align data */
-    const size_t size = (user_size + 7UL) & ~7UL;
-    area_chunk_t * curr;
+    const size_t size = user_size ? (user_size + AREA_ALIGN - 1) & ~(AREA_ALIGN - 1) : AREA_ALIGN;
 
-    XKRT_MUTEX_LOCK(area->lock);
+    /* reuse a chunk freed by that thread */
+    area_chunk_cache_t * cache = area_chunk_cache_get(this, area_idx);
+    area_chunk_t * curr = NULL;
+    if (cache)
     {
-        /* best fit strategy */
-        curr = area->free_chunk_list;
-
-        area_chunk_t * prevfree = NULL;
-        size_t min_size = 0;
-        area_chunk_t * min_size_curr = NULL;
-        area_chunk_t * min_size_prevfree = NULL;
-
-        while (curr)
-        {
-            size_t curr_size = curr->size;
-            if (curr_size >= size)
-            {
-                if ((min_size_curr == 0) || (min_size > curr_size))
-                {
-                    min_size = curr_size;
-                    min_size_curr = curr;
-                    min_size_prevfree = prevfree;
-                }
-            }
-            prevfree = curr;
-            curr = curr->freelink;
-        }
-
-        /* and the winner is min_size_curr ! */
-        curr = min_size_curr;
-        prevfree = min_size_prevfree;
+        SPINLOCK_LOCK(cache->lock);
+        curr = area_chunk_cache_pop(cache, size);
+        SPINLOCK_UNLOCK(cache->lock);
+    }
 
-        /* split chunk */
-        if ((curr != NULL) && (min_size - size >= (size_t)(0.5*(double)size)))
-        {
-            size_t curr_size = curr->size;
-            area_chunk_t * remainder = (area_chunk_t *) malloc(sizeof(area_chunk_t));
-            remainder->ptr         = size + curr->ptr;
-            remainder->size        = (curr_size - size);
-            remainder->state       = XKRT_ALLOC_CHUNK_STATE_FREE;
-            remainder->use_counter = 0;
-            remainder->prev        = curr;
-            remainder->next        = curr->next;
-            remainder->freelink    = curr->freelink;
-
-            /* link remainder segment after curr */
-            if (curr->next)
-                curr->next->prev = remainder;
-            curr->next = remainder;
-            curr->size = size;
-            curr->freelink = remainder;
-        }
+    if (curr == NULL)
+    {
+        XKRT_MUTEX_LOCK(area->lock);
+        curr = area_allocate(area, size, area_idx);
+        XKRT_MUTEX_UNLOCK(area->lock);
 
-        if (curr != NULL)
+        /* the chunks cached by any thread may be coalesced into a large
+         * enough one, before the caller resorts to eviction */
+        if (curr == NULL)
         {
-            if (prevfree)
-                prevfree->freelink = curr->freelink;
-            else
-                area->free_chunk_list = curr->freelink;
-            curr->state = XKRT_ALLOC_CHUNK_STATE_ALLOCATED;
-            curr->freelink = NULL;
+            area_chunk_caches_flush(this, area_idx);
+            XKRT_MUTEX_LOCK(area->lock);
+            curr = area_allocate(area, size, area_idx);
+            XKRT_MUTEX_UNLOCK(area->lock);
         }
     }
 
-    XKRT_MUTEX_UNLOCK(area->lock);
-
     if (curr)
     {
-        curr->area_idx = area_idx;
-        XKRT_STATS_INCR(this->stats.memory.allocated.total,       size);
-        XKRT_STATS_INCR(this->stats.memory.allocated.currently,   size);
+        curr->area_idx      = area_idx;
+        curr->pin_counter   = 0;
+        curr->last_use.store(0, std::memory_order_relaxed);
+        XKRT_STATS_INCR(this->stats.memory.allocated.total,       curr->size);
+        XKRT_STATS_INCR(this->stats.memory.allocated.currently,   curr->size);
     }
 
+    # if XKRT_SUPPORT_STATS
+    XKRT_STATS_INCR(area->stats.allocations, 1);
+    if (curr == NULL)
+        XKRT_STATS_INCR(area->stats.failures, 1);
+    XKRT_STATS_INCR(area->stats.latency[area_latency_bucket(get_nanotime() - t0)], 1);
+    # endif /* XKRT_SUPPORT_STATS */
+
     return curr;
 
 }
@@ -274,6 +607,51 @@ device_t::memory_allocate(const size_t user_size)
     return this->memory_allocate_on(user_size, 0);
 }
 
+void
+device_t::memory_stats_on(int area_idx, area_stats_t * stats)
+{
+    assert(area_idx >= 0);
+    assert(area_idx < this->nmemories);
+    area_t * area = &(this->memories[area_idx].area);
+
+    memset(stats, 0, sizeof(area_stats_t));
+
+    XKRT_MUTEX_LOCK(area->lock);
+    {
+        stats->limit    = area->limit;
+        stats->reserved = area->reserved;
+        stats->used     = area->used;
+        stats->peak     = area->peak;
+        for (area_segment_t * segment = area->segments ; segment ; segment = segment->next)
+        {
+            ++stats->nsegments;
+            for (area_chunk_t * chunk = segment->first ; chunk ; chunk = chunk->next)
+            {
+                if (chunk->state != XKRT_ALLOC_CHUNK_STATE_FREE)
+                    continue ;
+                ++stats->nfree;
+                stats->free += chunk->size;
+                if (chunk->size > stats->largest)
+                    stats->largest = chunk->size;
+            }
+        }
+    }
+    XKRT_MUTEX_UNLOCK(area->lock);
+
+    stats->fragmentation = stats->free ? 1.0 - (double) stats->largest / (double) stats->free : 0.0;
+
+    # if XKRT_SUPPORT_STATS
+    stats->allocations  = area->stats.allocations.load();
+    stats->failures     = area->stats.failures.load();
+    stats->reclaims     = area->stats.reclaims.load();
+    for (int i = 0 ; i < AREA_LATENCY_BUCKETS ; ++i)
+    {
+        stats->latency[i]           = area->stats.latency[i].load();
+        stats->reclaim_latency[i]   = area->stats.reclaim_latency[i].load();
+    }
+    # endif /* XKRT_SUPPORT_STATS */
+}
+
 ///////////////////////
 // QUEUE MANAGEMENT //
 ///////////////////////
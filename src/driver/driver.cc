@@ -41,6 +41,7 @@
 # include <xkrt/internals.h>
 # include <xkrt/driver/driver.h>
 # include <xkrt/logger/logger.h>
+# include <xkrt/logger/logger-hwloc.h>
 # include <xkrt/utils/min-max.h>
 # include <xkrt/sync/spinlock.h>
 # include <xkrt/thread/thread.h>
@@ -50,6 +51,8 @@
 # include <cerrno>
 # include <climits>
 
+# include <hwloc/glibc-sched.h>
+
 XKRT_NAMESPACE_BEGIN;
 
 static void
@@ -98,6 +101,7 @@ driver_thread_main(
     device->driver_id   = device_driver_id;
     device->conf        = &(runtime->conf.device);
     device->global_id   = device_global_id;
+    device->prefetched  = 0;
 
     // register device to the global list
     runtime->drivers.devices.list[device_global_id] = device;
@@ -112,7 +116,7 @@ driver_thread_main(
     driver->f_device_info(device_driver_id, buffer, sizeof(buffer));
     LOGGER_INFO("  global id = %2u | %s", device_global_id, buffer);
 
-    /* get total memory and allocate chunk0 */
+    /* get total memory of each area */
     if (driver->f_memory_device_info)
     {
         driver->f_memory_device_info(device->driver_id, device->memories, &device->nmemories);
@@ -122,6 +126,16 @@ driver_thread_main(
             device_memory_info_t * info = device->memories + i;
             LOGGER_INFO("Found memory `%s` of capacity %zuGB", info->name, info->capacity/(size_t)1e9);
             info->allocated = 0;
+            info->area.segments = NULL;
+            info->area.reserved = 0;
+            info->area.limit = 0;
+            info->area.idle = false;
+            info->area.used = 0;
+            info->area.peak = 0;
+            # if XKRT_SUPPORT_STATS
+            memset(&(info->area.stats), 0, sizeof(info->area.stats));
+            # endif /* XKRT_SUPPORT_STATS */
+            info->area.unused_chunk_list = NULL;
             XKRT_MUTEX_INIT(info->area.lock);
         }
     }
@@ -133,8 +147,8 @@ driver_thread_main(
 
     // commit
     assert(driver->f_device_commit);
-    device_global_id_bitfield_t * affinity = &(runtime->router.affinity[device->global_id][0]);
-    memset(affinity, 0, sizeof(runtime->router.affinity[device->global_id]));
+    device_global_id_bitfield_t * affinity = &(runtime->router_affinity.affinity[device->global_id][0]);
+    memset(affinity, 0, sizeof(runtime->router_affinity.affinity[device->global_id]));
     int err = driver->f_device_commit(device->driver_id, affinity);
     if (err)
         LOGGER_FATAL("Commit fail device %d of driver %s", device->driver_id, driver->f_get_name());
@@ -194,6 +208,29 @@ driver_thread_main(
     device->team->desc.nthreads            = nthreads_per_device;
     device->team->desc.routine             = (team_routine_t) device_thread_main;
 
+    // spread host threads over the NUMA nodes (1 memory area per node), the
+    // i-th thread of the team running on the node `i % nplaces`
+    team_thread_place_t numa_places[XKRT_DEVICE_MEMORIES_MAX];
+    if (driver->type == XKRT_DRIVER_TYPE_HOST && runtime->conf.enable_numa_scheduling && device->nmemories > 1)
+    {
+        const team_thread_place_t * place = team->desc.binding.places_list + device_driver_id;
+        for (int i = 0 ; i < device->nmemories ; ++i)
+        {
+            hwloc_obj_t node = hwloc_get_obj_by_type(runtime->topology, HWLOC_OBJ_NUMANODE, (unsigned int) i);
+            assert(node);
+
+            cpu_set_t cpuset;
+            HWLOC_SAFE_CALL(hwloc_cpuset_to_glibc_sched_affinity(runtime->topology, node->cpuset, &cpuset, sizeof(cpu_set_t)));
+            CPU_AND(numa_places + i, &cpuset, place);
+
+            // nodes without cpus available (memory-only nodes)
+            if (CPU_COUNT(numa_places + i) == 0)
+                numa_places[i] = *place;
+        }
+        device->team->desc.binding.nplaces     = device->nmemories;
+        device->team->desc.binding.places_list = numa_places;
+    }
+
     runtime->team_create(device->team);     // return from the 'device team'
     runtime->team_join(device->team);
 
@@ -209,7 +246,8 @@ driver_thread_main(
             if (device->memories[j].allocated)
             {
                 area_t * area = &(device->memories[j].area);
-                driver->f_memory_device_deallocate(device->driver_id, (void *) area->chunk0.ptr, area->chunk0.size, j);
+                for (area_segment_t * segment = area->segments ; segment ; segment = segment->next)
+                    driver->f_memory_device_deallocate(device->driver_id, (void *) segment->ptr, segment->size, j);
             }
         }
     }
@@ -44,6 +44,7 @@
 # include <xkrt/driver/driver.h>
 # include <xkrt/driver/driver-host.h>
 # include <xkrt/driver/queue.h>
+# include <xkrt/logger/logger-hwloc.h>
 # include <xkrt/sync/bits.h>
 # include <xkrt/sync/mutex.h>
 
@@ -73,12 +74,17 @@
 
 XKRT_NAMESPACE_BEGIN
 
+/* topology of the host, each NUMA node is exposed as a memory area - this is
+ * the runtime topology, retrieved on `device_cpuset` (owned by the runtime) */
+static hwloc_topology_t host_topology;
+
 static int
 XKRT_DRIVER_ENTRYPOINT(init)(
     unsigned int ndevices,
     bool use_p2p
 ) {
     (void) ndevices;
+    (void) use_p2p;
     return 0;
 }
 
@@ -90,25 +96,19 @@ XKRT_DRIVER_ENTRYPOINT(device_info)(
 ) {
     (void) device_driver_id;
 
-    // Initialize and load topology
-    hwloc_topology_t topology;
-    hwloc_topology_init(&topology);
-    hwloc_topology_load(topology);
-
     // Get the first PU (Processing Unit) and move up to the package (CPU)
-    hwloc_obj_t obj = hwloc_get_obj_by_type(topology, HWLOC_OBJ_PACKAGE, 0);
+    hwloc_obj_t obj = hwloc_get_obj_by_type(host_topology, HWLOC_OBJ_PACKAGE, 0);
     if (obj && obj->name)
         snprintf(buffer, size, "%s", obj->name);
     else
         snprintf(buffer, size, "Unknown CPU");
-
-    // Destroy topology
-    hwloc_topology_destroy(topology);
 }
 
 static void
 XKRT_DRIVER_ENTRYPOINT(finalize)(void)
 {
+    // the topology is destroyed by the runtime
+    host_topology = NULL;
 }
 
 static const char *
@@ -126,8 +126,8 @@ XKRT_DRIVER_ENTRYPOINT(get_ndevices_max)(void)
 static int
 XKRT_DRIVER_ENTRYPOINT(device_cpuset)(hwloc_topology_t topology, cpu_set_t * schedset, device_driver_id_t device_driver_id)
 {
-    (void) topology;
     assert(device_driver_id == 0);
+    host_topology = topology;
     pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), schedset);
     return 0;
 }
@@ -247,12 +247,41 @@ XKRT_DRIVER_ENTRYPOINT(queue_command_launch)(
     command_t * cmd,
     queue_command_list_counter_t idx
 ) {
-    assert(cmd->type == COMMAND_TYPE_FD_READ || cmd->type == COMMAND_TYPE_FD_WRITE);
-
     queue_host_t * queue = (queue_host_t *) iqueue;
 
     switch (cmd->type)
     {
+        /* copies between NUMA nodes are performed synchronously by the
+         * thread launching the command, and completed on next progress */
+        case (COMMAND_TYPE_COPY_H2H_1D):
+        {
+            const size_t count = cmd->copy_1D.size;
+            assert(count > 0);
+            memcpy((void *) cmd->copy_1D.dst_device_addr, (const void *) cmd->copy_1D.src_device_addr, count);
+            return 0;
+        }
+
+        case (COMMAND_TYPE_COPY_H2H_2D):
+        {
+            const size_t dpitch = cmd->copy_2D.dst_device_view.ld * cmd->copy_2D.sizeof_type;
+            const size_t spitch = cmd->copy_2D.src_device_view.ld * cmd->copy_2D.sizeof_type;
+
+            const size_t width  = cmd->copy_2D.m * cmd->copy_2D.sizeof_type;
+            const size_t height = cmd->copy_2D.n;
+            assert(width > 0);
+            assert(height > 0);
+
+            uint8_t       * dst = (uint8_t       *) cmd->copy_2D.dst_device_view.addr;
+            const uint8_t * src = (const uint8_t *) cmd->copy_2D.src_device_view.addr;
+
+            if (dpitch == width && spitch == width)
+                memcpy(dst, src, width * height);
+            else
+                for (size_t j = 0 ; j < height ; ++j)
+                    memcpy(dst + j * dpitch, src + j * spitch, width);
+            return 0;
+        }
+
         case (COMMAND_TYPE_FD_READ):
         case (COMMAND_TYPE_FD_WRITE):
         {
@@ -291,7 +320,7 @@ XKRT_DRIVER_ENTRYPOINT(queue_command_launch)(
         }
 
         default:
-            break ;
+            return ENOSYS;
     }
 
     return 0;
@@ -305,6 +334,8 @@ XKRT_DRIVER_ENTRYPOINT(queue_suggest)(
     assert(device_driver_id == 0);
     switch (qtype)
     {
+        /* host-to-host copies, between NUMA nodes */
+        case (XKRT_QUEUE_TYPE_H2D):
         case (XKRT_QUEUE_TYPE_FD_READ):
         case (XKRT_QUEUE_TYPE_FD_WRITE):
             return 1;
@@ -338,6 +369,10 @@ XKRT_DRIVER_ENTRYPOINT(queue_commands_wait)(
             break ;
         }
 
+        /* copies are completed on launch */
+        case (XKRT_QUEUE_TYPE_H2D):
+            break ;
+
         default:
             LOGGER_FATAL("Not supported");
     }
@@ -381,6 +416,17 @@ XKRT_DRIVER_ENTRYPOINT(queue_commands_progress)(
     queue_host_t * queue = (queue_host_t *) iqueue;
     int r = 0;
 
+    // copies were performed on launch, complete them
+    if (iqueue->type == XKRT_QUEUE_TYPE_H2D)
+    {
+        iqueue->pending.progress([&] (command_t * cmd, queue_command_list_counter_t p) {
+            assert(cmd->type == COMMAND_TYPE_COPY_H2H_1D || cmd->type == COMMAND_TYPE_COPY_H2H_2D);
+            iqueue->complete_command(p);
+            return true;
+        });
+        return r;
+    }
+
     // no need to iterate through cmd, its saved in the completion queue for I/O Instructions
     {
         /*
@@ -435,9 +481,9 @@ XKRT_DRIVER_ENTRYPOINT(queue_create)(
     (void)type;
     (void)capacity;
 
-    if (type != XKRT_QUEUE_TYPE_FD_READ && type != XKRT_QUEUE_TYPE_FD_WRITE)
+    if (type != XKRT_QUEUE_TYPE_H2D && type != XKRT_QUEUE_TYPE_FD_READ && type != XKRT_QUEUE_TYPE_FD_WRITE)
         return NULL;
-    assert(type == XKRT_QUEUE_TYPE_FD_READ || type == XKRT_QUEUE_TYPE_FD_WRITE);
+    assert(type == XKRT_QUEUE_TYPE_H2D || type == XKRT_QUEUE_TYPE_FD_READ || type == XKRT_QUEUE_TYPE_FD_WRITE);
 
     uint8_t * mem = (uint8_t *) calloc(1, sizeof(queue_host_t));
     assert(mem);
@@ -477,6 +523,15 @@ XKRT_DRIVER_ENTRYPOINT(queue_delete)(
 // MEMORY //
 ////////////
 
+/* the memory area `area_idx` is the NUMA node of logical index `area_idx` */
+static inline hwloc_obj_t
+XKRT_DRIVER_ENTRYPOINT(memory_numa_node)(int area_idx)
+{
+    hwloc_obj_t node = hwloc_get_obj_by_type(host_topology, HWLOC_OBJ_NUMANODE, (unsigned int) area_idx);
+    assert(node);
+    return node;
+}
+
 static void *
 XKRT_DRIVER_ENTRYPOINT(memory_device_allocate)(
     device_driver_id_t device_driver_id,
@@ -484,8 +539,11 @@ XKRT_DRIVER_ENTRYPOINT(memory_device_allocate)(
     int area_idx
 ) {
     assert(device_driver_id == 0);
-    assert(area_idx == 0);
-    return malloc(size);
+    (void) device_driver_id;
+
+    /* pages are bound to the node on first touch, without failing if binding is not supported */
+    hwloc_obj_t node = XKRT_DRIVER_ENTRYPOINT(memory_numa_node)(area_idx);
+    return hwloc_alloc_membind(host_topology, size, node->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET);
 }
 
 static void
@@ -496,9 +554,9 @@ XKRT_DRIVER_ENTRYPOINT(memory_device_deallocate)(
     int area_idx
 ) {
     assert(device_driver_id == 0);
-    assert(area_idx == 0);
-    (void)size;
-    free(ptr);
+    (void) device_driver_id;
+    (void) area_idx;
+    hwloc_free(host_topology, ptr, size);
 }
 
 static void
@@ -511,19 +569,39 @@ XKRT_DRIVER_ENTRYPOINT(memory_device_info)(
     assert(device_driver_id == 0);
 
     struct sysinfo sinfo;
+    if (sysinfo(&sinfo))
+    {
+        *nmemories = 0;
+        return ;
+    }
 
-    if (sysinfo(&sinfo) == 0)
+    int nnodes = hwloc_get_nbobjs_by_type(host_topology, HWLOC_OBJ_NUMANODE);
+    if (nnodes > XKRT_DEVICE_MEMORIES_MAX)
+    {
+        LOGGER_WARN("Found %d NUMA nodes, only using the first %d. Increase `XKRT_DEVICE_MEMORIES_MAX` and recompile", nnodes, XKRT_DEVICE_MEMORIES_MAX);
+        nnodes = XKRT_DEVICE_MEMORIES_MAX;
+    }
+
+    /* a single node: the whole RAM */
+    if (nnodes <= 1)
     {
         const int i = 0;
         strncpy(info[i].name, "RAM", sizeof(info[i].name));
         info[i].used     = sinfo.totalram - sinfo.freeram;
         info[i].capacity = sinfo.totalram;
         *nmemories = 1;
+        return ;
     }
-    else
+
+    /* one memory area per NUMA node */
+    for (int i = 0 ; i < nnodes ; ++i)
     {
-        *nmemories = 0;
+        hwloc_obj_t node = XKRT_DRIVER_ENTRYPOINT(memory_numa_node)(i);
+        snprintf(info[i].name, sizeof(info[i].name), "NUMA#%u", node->os_index);
+        info[i].used     = 0;
+        info[i].capacity = node->attr->numanode.local_memory ? node->attr->numanode.local_memory : sinfo.totalram / nnodes;
     }
+    *nmemories = nnodes;
 }
 
 # if 0
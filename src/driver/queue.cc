@@ -40,8 +40,10 @@
 # include <string.h>
 
 # include <xkrt/logger/logger.h>
+# include <xkrt/logger/metric.h>
 # include <xkrt/driver/queue.h>
 # include <xkrt/logger/todo.h>
+# include <xkrt/utils/min-max.h>
 
 XKRT_NAMESPACE_BEGIN;
 
@@ -126,6 +128,9 @@ queue_init(
         capacity
     );
 
+    memset(&(queue->links), 0, sizeof(queue->links));
+    queue->last_completion = 0;
+
     # if XKRT_SUPPORT_STATS
     memset(&(queue->stats), 0, sizeof(queue->stats));
     # endif /* XKRT_SUPPORT_STATS */
@@ -202,14 +207,9 @@ queue_t::launch_ready_commands(void)
                 break ;
             }
 
+            /* launch command */
             case (COMMAND_TYPE_COPY_H2H_1D):
             case (COMMAND_TYPE_COPY_H2H_2D):
-            {
-                LOGGER_FATAL("Not implemented");
-                break ;
-            }
-
-            /* launch command */
             case (COMMAND_TYPE_COPY_H2D_1D):
             case (COMMAND_TYPE_COPY_D2H_1D):
             case (COMMAND_TYPE_COPY_D2D_1D):
@@ -220,6 +220,9 @@ queue_t::launch_ready_commands(void)
             case (COMMAND_TYPE_FD_WRITE):
             default:
             {
+                if (command_is_copy(cmd->type))
+                    cmd->link.launched = get_nanotime();
+
                 int err = this->f_command_launch(this, cmd, p);
                 switch (err)
                 {
@@ -283,6 +286,52 @@ queue_t::launch_ready_commands(void)
     return r;
 }
 
+void
+queue_t::link_record(
+    const device_global_id_t src,
+    const device_global_id_t dst,
+    const uint64_t bytes,
+    const uint64_t ns
+) {
+    assert(src < XKRT_DEVICES_MAX);
+    assert(dst < XKRT_DEVICES_MAX);
+
+    /* commands may complete within the clock resolution */
+    const double bandwidth = (double) bytes * 1e9 / (double) (ns ? ns : 1);
+
+    /* only the thread owning that queue completes its commands, other threads may read concurrently */
+    queue_link_t * link = &(this->links[src][dst]);
+    const uint64_t n = link->n.load(std::memory_order_relaxed);
+    const double ewma = (n == 0) ? bandwidth : XKRT_LINK_BANDWIDTH_EWMA_ALPHA * bandwidth + (1.0 - XKRT_LINK_BANDWIDTH_EWMA_ALPHA) * link->bandwidth.load(std::memory_order_relaxed);
+    link->bandwidth.store(ewma, std::memory_order_relaxed);
+    link->bytes.fetch_add(bytes, std::memory_order_relaxed);
+    link->ns.fetch_add(ns, std::memory_order_relaxed);
+    link->n.store(n + 1, std::memory_order_release);
+}
+
+/* number of bytes moved by a copy command */
+static inline uint64_t
+__command_copy_size(const command_t * cmd)
+{
+    switch (cmd->type)
+    {
+        case (COMMAND_TYPE_COPY_H2H_1D):
+        case (COMMAND_TYPE_COPY_H2D_1D):
+        case (COMMAND_TYPE_COPY_D2H_1D):
+        case (COMMAND_TYPE_COPY_D2D_1D):
+            return cmd->copy_1D.size;
+
+        case (COMMAND_TYPE_COPY_H2H_2D):
+        case (COMMAND_TYPE_COPY_H2D_2D):
+        case (COMMAND_TYPE_COPY_D2H_2D):
+        case (COMMAND_TYPE_COPY_D2D_2D):
+            return cmd->copy_2D.m * cmd->copy_2D.n * cmd->copy_2D.sizeof_type;
+
+        default:
+            return 0;
+    }
+}
+
 // TODO : allow out of order completion
 
 template <bool set_completed_flag>
@@ -304,6 +353,19 @@ __complete_command_internal(
     if (set_completed_flag)
         cmd->completed = true;
 
+    /* measure the link bandwidth - commands of a queue execute in order, so
+     * a copy only started once launched and once the previous command
+     * completed. If both completions were observed at once, the duration of
+     * that copy is unknown */
+    const uint64_t now = get_nanotime();
+    if (command_is_copy(cmd->type) && cmd->link.launched)
+    {
+        const uint64_t started = MAX(cmd->link.launched, queue->last_completion);
+        if (started < now)
+            queue->link_record(cmd->link.src, cmd->link.dst, __command_copy_size(cmd), now - started);
+    }
+    queue->last_completion = now;
+
     for (command_callback_index_t i = 0 ; i < cmd->callbacks.n ; ++i)
     {
         assert(cmd->callbacks.list[i].func);
@@ -41,7 +41,9 @@
 # include <xkrt/driver/driver.h>
 # include <xkrt/logger/logger.h>
 # include <xkrt/logger/todo.h>
+# include <xkrt/memory/alignas.h>
 # include <xkrt/sync/mem.h>
+# include <xkrt/utils/min-max.h>
 
 # include <cassert>
 # include <cstring>
@@ -64,12 +66,22 @@ runtime_t::memory_device_preallocate_ensure(
             if (!device->memories[memory_id].allocated)
             {
                 const size_t size = (size_t) ((double)device->memories[memory_id].capacity * (double)(this->conf.device.gpu_mem_percent / 100.0));
-                assert(driver->f_memory_device_allocate);
-                const void * device_ptr = driver->f_memory_device_allocate(device->driver_id, size, memory_id);
-                if (device_ptr == NULL)
-                    LOGGER_FATAL("Out of GPU memory");
-                assert(device_ptr);
-                device->memory_set_chunk0((uintptr_t) device_ptr, size, memory_id);
+
+                /* the pool grows on demand up to `size` bytes */
+                if (this->conf.device.pool_grow_size)
+                {
+                    device->memory_set_chunk0((uintptr_t) NULL, 0, memory_id);
+                    device->memories[memory_id].area.limit = size;
+                }
+                else
+                {
+                    assert(driver->f_memory_device_allocate);
+                    const void * device_ptr = driver->f_memory_device_allocate(device->driver_id, size, memory_id);
+                    if (device_ptr == NULL)
+                        LOGGER_FATAL("Out of GPU memory");
+                    assert(device_ptr);
+                    device->memory_set_chunk0((uintptr_t) device_ptr, size, memory_id);
+                }
                 device->memories[memory_id].allocated = 1;
             }
         }
@@ -77,6 +89,58 @@ runtime_t::memory_device_preallocate_ensure(
     }
 }
 
+int
+runtime_t::memory_device_grow(
+    const device_global_id_t device_global_id,
+    const size_t size,
+    const int memory_id
+) {
+    device_t * device = this->device_get(device_global_id);
+    driver_t * driver = this->driver_get(device->driver_type);
+    area_t * area = &(device->memories[memory_id].area);
+
+    /* reserve the room under the lock, so concurrent grows respect the limit */
+    size_t grow;
+    XKRT_MUTEX_LOCK(area->lock);
+    {
+        /* room left in the pool, in whole allocation units */
+        const size_t room = (area->limit - area->reserved) & ~(AREA_ALIGN - 1);
+        grow = MIN(MAX(this->conf.device.pool_grow_size & ~(AREA_ALIGN - 1), size), room);
+        if (grow && grow >= size)
+            area->reserved += grow;
+        else
+            grow = 0;
+    }
+    XKRT_MUTEX_UNLOCK(area->lock);
+
+    if (grow == 0)
+        return 0;
+
+    /* the driver may synchronize the device: do not hold the area meanwhile */
+    assert(driver->f_memory_device_allocate);
+    const void * device_ptr = driver->f_memory_device_allocate(device->driver_id, grow, memory_id);
+
+    XKRT_MUTEX_LOCK(area->lock);
+    {
+        if (device_ptr)
+        {
+            device->memory_grow_on((uintptr_t) device_ptr, grow, memory_id);
+            LOGGER_DEBUG("Device %u memory %d grew by %zu bytes to %zu bytes", device_global_id, memory_id, grow, area->reserved);
+        }
+        else
+            area->reserved -= grow;
+    }
+    XKRT_MUTEX_UNLOCK(area->lock);
+
+    if (device_ptr == NULL)
+    {
+        LOGGER_WARN("Device %u memory %d could not grow by %zu bytes", device_global_id, memory_id, grow);
+        return 0;
+    }
+
+    return 1;
+}
+
 area_chunk_t *
 runtime_t::memory_device_allocate_on(
     const device_global_id_t device_global_id,
@@ -85,7 +149,14 @@ runtime_t::memory_device_allocate_on(
 ) {
     device_t * device = this->device_get(device_global_id);
     this->memory_device_preallocate_ensure(device_global_id, memory_id);
-    return device->memory_allocate_on(size, memory_id);
+
+    /* the pool is grown, until the allocation succeeds or its limit is reached */
+    const size_t aligned_size = size ? (size + AREA_ALIGN - 1) & ~(AREA_ALIGN - 1) : AREA_ALIGN;
+    area_chunk_t * chunk;
+    while ((chunk = device->memory_allocate_on(size, memory_id)) == NULL)
+        if (!this->memory_device_grow(device_global_id, aligned_size, memory_id))
+            break ;
+    return chunk;
 }
 
 area_chunk_t *
@@ -96,13 +167,48 @@ runtime_t::memory_device_allocate(
     return this->memory_device_allocate_on(device_global_id, size, 0);
 }
 
+void
+runtime_t::memory_device_stats(
+    const device_global_id_t device_global_id,
+    const int memory_id,
+    area_stats_t * stats
+) {
+    device_t * device = this->device_get(device_global_id);
+    device->memory_stats_on(memory_id, stats);
+}
+
 void
 runtime_t::memory_device_deallocate(
     const device_global_id_t device_global_id,
     area_chunk_t * chunk
 ) {
     device_t * device = this->device_get(device_global_id);
-    return device->memory_deallocate(chunk);
+    const int memory_id = chunk->area_idx;
+    device->memory_deallocate(chunk);
+
+    /* release the segments that became entirely free to the driver - they
+     * are detached from the area under its lock, but released out of it, so
+     * that other threads do not wait on the driver to allocate */
+    area_t * area = &(device->memories[memory_id].area);
+    if (area->idle)
+    {
+        driver_t * driver = this->driver_get(device->driver_type);
+        assert(driver->f_memory_device_deallocate);
+        while (1)
+        {
+            uintptr_t device_ptr;
+            size_t size;
+
+            XKRT_MUTEX_LOCK(area->lock);
+            const bool released = device->memory_release_idle_on(memory_id, &device_ptr, &size);
+            XKRT_MUTEX_UNLOCK(area->lock);
+            if (!released)
+                break ;
+
+            driver->f_memory_device_deallocate(device->driver_id, (void *) device_ptr, size, memory_id);
+            LOGGER_DEBUG("Device %u memory %d released %zu bytes", device_global_id, memory_id, size);
+        }
+    }
 }
 
 void
@@ -146,6 +252,41 @@ runtime_t::memory_host_deallocate(
     }
 }
 
+int
+runtime_t::memory_host_numa_node(const void * ptr)
+{
+    device_t * device = this->device_get(HOST_DEVICE_GLOBAL_ID);
+    if (device->nmemories <= 1)
+        return 0;
+
+    // pages rarely migrate: look up the cache first, tagged by the page number
+    const uint64_t page = (uint64_t) ((uintptr_t) ptr / xkrt_pagesize);
+    std::atomic<uint64_t> & entry = this->host_numa_nodes[page & (XKRT_HOST_NUMA_CACHE_SIZE - 1)];
+    const uint64_t cached = entry.load(std::memory_order_relaxed);
+    if (cached && (cached >> 8) == page)
+        return (int) (cached & 0xFF) - 1;
+
+    int r = -1;
+    hwloc_nodeset_t nodeset = hwloc_bitmap_alloc();
+    if (hwloc_get_area_memlocation(this->topology, ptr, 1, nodeset, HWLOC_MEMBIND_BYNODESET) == 0)
+    {
+        const int os_index = hwloc_bitmap_first(nodeset);
+        if (os_index >= 0)
+        {
+            hwloc_obj_t node = hwloc_get_numanode_obj_by_os_index(this->topology, (unsigned int) os_index);
+            if (node && node->logical_index < (unsigned int) device->nmemories)
+                r = (int) node->logical_index;
+        }
+    }
+    hwloc_bitmap_free(nodeset);
+
+    // pages not resident yet are not cached, they are placed on first touch
+    if (r >= 0)
+        entry.store((page << 8) | (uint64_t) (r + 1), std::memory_order_relaxed);
+
+    return r;
+}
+
 void *
 runtime_t::memory_unified_allocate(
     const device_global_id_t device_global_id,
@@ -37,6 +37,8 @@
 # include <xkrt/memory/access/access.hpp>
 # include <xkrt/logger/logger.h>
 
+# include <utility>
+
 XKRT_NAMESPACE_BEGIN;
 
 bool
@@ -64,9 +66,44 @@ access_t::conflicts(
 ) {
     if (!(x->mode & ACCESS_MODE_W) & !(y->mode & ACCESS_MODE_W))
         return false;
+    if ((x->mode & ACCESS_MODE_P) && x->reduction && x->reduction == y->reduction)
+        return false;
     return access_t::intersects(x, y);
 }
 
+/* reconstruct 'x' in place with the passed constructor arguments, keeping
+ * its successors, split mode and reduction */
+template <typename... Args>
+static inline void
+access_reset(access_t * x, Args... args)
+{
+    std::vector<access_t *> successors;
+    successors.swap(x->successors);
+    const access_split_mode_t split_mode = x->split_mode;
+    const access_reduce_op_t reduce_op = x->reduce_op;
+    access_reduction_t * reduction = x->reduction;
+
+    new (x) access_t(std::forward<Args>(args)...);
+
+    x->successors.swap(successors);
+    x->split_mode = split_mode;
+    x->reduce_op = reduce_op;
+    x->reduction = reduction;
+}
+
+/* 'y' got split from 'x': it is split the same way, and contributes to the same reduction */
+static inline void
+access_split_inherit(access_t * x, access_t * y)
+{
+    y->split_mode = x->split_mode;
+    y->reduce_op  = x->reduce_op;
+    if (x->reduction)
+    {
+        y->reduction = x->reduction;
+        y->reduction->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
 void
 access_t::split(
     access_t * x,
@@ -74,10 +111,26 @@ access_t::split(
     task_t * y_task,
     access_split_mode_t split_mode
 ) {
+    /* accesses must be split before being fetched */
+    assert(x->state == ACCESS_STATE_INIT);
+
+    /* duplicated accesses must not be written concurrently, but reductions
+     * write to private copies */
+    assert(split_mode != ACCESS_SPLIT_MODE_NO_SPLIT || !(x->mode & ACCESS_MODE_W) || (x->mode & ACCESS_MODE_P));
+
     switch (x->type)
     {
         case (ACCESS_TYPE_SEGMENT):
         {
+            const uintptr_t a = x->region.interval.segment[0].a;
+            const uintptr_t b = x->region.interval.segment[0].b;
+
+            if (split_mode == ACCESS_SPLIT_MODE_NO_SPLIT)
+            {
+                new (y) access_t(y_task, a, b, x->mode, x->concurrency, x->scope);
+                break ;
+            }
+
             //        a                 b
             //  x = [ . . . . . . . . . [
             //  then
@@ -85,38 +138,52 @@ access_t::split(
             //  y = [ . . . . [         b
             //  x =           [ . . . . [
 
-            const uintptr_t a = x->region.interval.segment[0].a;
-            const uintptr_t b = x->region.interval.segment[0].b;
             const uintptr_t h = (b - a) / 2;
+            assert(h > 0);
             new (y) access_t( y_task, a + 0, a + h, x->mode, x->concurrency, x->scope);
-            new (x) access_t(x->task, a + h, b + 0, x->mode, x->concurrency, x->scope);
+            access_reset(x, x->task, a + h, b + 0, x->mode, x->concurrency, x->scope);
 
             break ;
         }
 
-        // TODO
         case (ACCESS_TYPE_BLAS_MATRIX):
         {
+            if (x->region.matrix.uplo != MATRIX_UPLO_GENERAL)
+                LOGGER_FATAL("Triangular matrix accesses cannot be split");
+            if (!matrix_halo_is_empty(x->region.matrix.halo))
+                LOGGER_FATAL("Matrix accesses with a halo cannot be split");
+
+            const memory_view_t view(x->host_view);
+            const size_t m = view.m;
+            const size_t n = view.n;
+
+            /* split along the largest dimension */
+            if (split_mode == ACCESS_SPLIT_MODE_HALVES)
+                split_mode = (m >= n) ? ACCESS_SPLIT_MODE_HALVES_HORIZONTAL : ACCESS_SPLIT_MODE_HALVES_VERTICAL;
+
+            /* (y_m, y_n) is the size of y, x keeps the rest from (x_offset_m, x_offset_n) */
+            size_t y_m, y_n, x_offset_m, x_offset_n;
+
             switch (split_mode)
             {
-                //  x x x x    y1 y1 y2 y2
-                //  x x x x -> y1 y1 y2 y2
-                //  x x x x    y3 y3 x  x
-                //  x x x x    y3 y3 x  x
-                case (ACCESS_SPLIT_MODE_QUADRANT):
+                case (ACCESS_SPLIT_MODE_NO_SPLIT):
                 {
-                    LOGGER_FATAL("IMPL ME");
-                    break ;
+                    new (y) access_t(y_task, view.storage, (const void *) view.addr, view.ld, 0, 0, m, n, view.sizeof_type, x->mode, x->concurrency, x->scope);
+                    access_split_inherit(x, y);
+                    return ;
                 }
 
                 //  x x x x    y y y y
                 //  x x x x -> y y y y
                 //  x x x x    x x x x
                 //  x x x x    x x x x
-                case (ACCESS_SPLIT_MODE_HALVES):
                 case (ACCESS_SPLIT_MODE_HALVES_HORIZONTAL):
                 {
-                    LOGGER_FATAL("IMPL ME");
+                    assert(m >= 2);
+                    y_m = m / 2;
+                    y_n = n;
+                    x_offset_m = y_m;
+                    x_offset_n = 0;
                     break ;
                 }
 
@@ -126,18 +193,44 @@ access_t::split(
                 //  x x x x    y y x x
                 case (ACCESS_SPLIT_MODE_HALVES_VERTICAL):
                 {
-                    LOGGER_FATAL("IMPL ME");
+                    assert(n >= 2);
+                    y_m = m;
+                    y_n = n / 2;
+                    x_offset_m = 0;
+                    x_offset_n = y_n;
                     break ;
                 }
 
-                case (ACCESS_SPLIT_MODE_NO_SPLIT):
+                //  x x x x    y1 y1 y2 y2
+                //  x x x x -> y1 y1 y2 y2
+                //  x x x x    y3 y3 x  x
+                //  x x x x    y3 y3 x  x
+                case (ACCESS_SPLIT_MODE_QUADRANT):
+                {
+                    LOGGER_FATAL("Quadrant splits produce 3 accesses, split twice in halves instead");
+                    return ;
+                }
+
+                case (ACCESS_SPLIT_MODE_HALVES):
                 case (ACCESS_SPLIT_MODE_CUSTOM):
+                default:
                 {
                     LOGGER_FATAL("Not supported");
-                    break ;
+                    return ;
                 }
             }
 
+            new (y) access_t(
+                y_task, view.storage, (const void *) view.addr, view.ld,
+                0, 0, y_m, y_n,
+                view.sizeof_type, x->mode, x->concurrency, x->scope
+            );
+            access_reset(
+                x, x->task, view.storage, (const void *) view.addr, view.ld,
+                x_offset_m, x_offset_n, m - x_offset_m, n - x_offset_n,
+                view.sizeof_type, x->mode, x->concurrency, x->scope
+            );
+
             break ;
         }
 
@@ -149,6 +242,8 @@ access_t::split(
             break ;
         }
     }
+
+    access_split_inherit(x, y);
 }
 
 XKRT_NAMESPACE_END
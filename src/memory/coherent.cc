@@ -74,8 +74,8 @@ runtime_t::memory_noncoherent_alloc(
     const uintptr_t a = (const uintptr_t) ptr;
     const uintptr_t b = a + size;
     access_t access(NULL, a, b, ACCESS_MODE_V);
-    BLASMemoryTree * memtree = (BLASMemoryTree *) task_get_memory_controller(this, thread->current_task, &access);
-    memtree->allocate_to_device(&access, device_global_id);
+    MemoryCoherencyController * mcc = task_get_memory_controller(this, thread->current_task, &access);
+    mcc->allocate_to_device(&access, device_global_id);
 }
 
 void
@@ -173,12 +173,11 @@ runtime_t::memory_coherent_async(
     {
         /* retrieve the node */
         BLASDependencyTree::Node * node = (BLASDependencyTree::Node *) conflict;
-        access_t * write = node->last_write;
-        assert(write);
+        assert(node->last_write || node->last_reduces.size());
 
         // this may no longer be true due to dependencies between segments and matrices
-        // assert(access.host_view.ld          == write->host_view.ld);
-        // assert(access.host_view.sizeof_type == write->host_view.sizeof_type);
+        // assert(access.host_view.ld          == node->last_write->host_view.ld);
+        // assert(access.host_view.sizeof_type == node->last_write->host_view.sizeof_type);
 
         /* allocate a task with 1 access */
         task_t * task = thread->allocate_task(task_size + args_size);
@@ -203,7 +202,8 @@ runtime_t::memory_coherent_async(
         /* as 'conflicts' are forming a partition of 'access', it must only
          * intersects with a single cube of 'access' : find which of the two */
         bool found = false;
-        for (const Rect & rect : access.rects())
+        Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+        for (const Rect & rect : access.rects(buffer))
         {
             Rect h;
             Rect::intersection(&h, rect, node->hyperrect);
@@ -211,7 +211,7 @@ runtime_t::memory_coherent_async(
             if (!h.is_empty())
             {
                 new (accesses + 0) access_t(task, MATRIX_COLMAJOR, h, access.host_view.ld, access.host_view.sizeof_type, ACCESS_MODE_R);
-                __access_precedes(write, accesses + 0);
+                dependency_node_link(node, accesses + 0);
                 found = true;
                 break ;
             }
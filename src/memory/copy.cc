@@ -39,6 +39,10 @@
 # include <xkrt/runtime.h>
 # include <xkrt/internals.h>
 
+# include <algorithm>
+# include <atomic>
+# include <vector>
+
 XKRT_NAMESPACE_BEGIN
 
 typedef struct  copy_args_t
@@ -82,6 +86,50 @@ runtime_t::copy(
     );
 }
 
+# if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
+
+/* a copy split in several commands, that completes once all of them did */
+typedef struct  copy_split_t
+{
+    std::atomic<int> n;
+    callback_t callback;
+
+}               copy_split_t;
+
+static void
+copy_split_callback(void * vargs [XKRT_CALLBACK_ARGS_MAX])
+{
+    copy_split_t * split = (copy_split_t *) vargs[0];
+    assert(split);
+
+    if (split->n.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        if (split->callback.func)
+            split->callback.func(split->callback.args);
+        delete split;
+    }
+}
+
+/* add the offsets in ]0, size[ where registered segments start or end over the host memory [addr, addr + size[ */
+static inline void
+copy_registered_cuts(
+    runtime_t * runtime,
+    const uintptr_t addr,
+    const size_t size,
+    std::vector<size_t> & cuts
+) {
+    runtime->registered_memory.foreach_intersecting(addr, addr + size,
+        [&] (const RegisteredSegments::segment_t & segment) {
+            if (addr < segment.a)
+                cuts.push_back(segment.a - addr);
+            if (segment.b < addr + size)
+                cuts.push_back(segment.b - addr);
+        }
+    );
+}
+
+# endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
+
 void
 runtime_t::copy(
     const device_global_id_t   device_global_id,
@@ -93,7 +141,49 @@ runtime_t::copy(
     const callback_t         & callback
 ) {
     device_t * device = this->device_get(device_global_id);
-    // TODO: create 1x command per pinned segment, and callback
+
+    # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
+    /* create 1x command per registered/unregistered part of the host memory */
+    if (this->conf.protect_registered_memory_overflow)
+    {
+        std::vector<size_t> cuts;
+        if (dst_device_global_id == HOST_DEVICE_GLOBAL_ID)
+            copy_registered_cuts(this, dst_device_addr, size, cuts);
+        if (src_device_global_id == HOST_DEVICE_GLOBAL_ID)
+            copy_registered_cuts(this, src_device_addr, size, cuts);
+
+        if (cuts.size())
+        {
+            std::sort(cuts.begin(), cuts.end());
+            cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+            cuts.push_back(size);
+
+            copy_split_t * split = new copy_split_t();
+            split->n.store((int) cuts.size(), std::memory_order_relaxed);
+            split->callback = callback;
+
+            callback_t part_callback;
+            part_callback.func    = copy_split_callback;
+            part_callback.args[0] = split;
+
+            size_t offset = 0;
+            for (const size_t cut : cuts)
+            {
+                device->offloader_queue_command_submit_copy<size_t, uintptr_t>(
+                    cut - offset,
+                    dst_device_global_id,
+                    dst_device_addr + offset,
+                    src_device_global_id,
+                    src_device_addr + offset,
+                    part_callback
+                );
+                offset = cut;
+            }
+            return ;
+        }
+    }
+    # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
+
     device->offloader_queue_command_submit_copy<size_t, uintptr_t>(
         size,
         dst_device_global_id,
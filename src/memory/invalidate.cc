@@ -60,6 +60,11 @@ memory_deallocate_all(
         {
             thread_t * thread = device->team->get_thread(i);
             thread->deallocate_all_tasks();
+
+            // completed tasks got released all at once
+            task_dom_info_t * dom = TASK_DOM_INFO(&thread->implicit_task);
+            dom->gc.completed.store(NULL, std::memory_order_relaxed);
+            dom->gc.ncompleted.store(0, std::memory_order_relaxed);
         }
     }
 }
@@ -96,7 +101,7 @@ coherence_reset(runtime_t * runtime)
         dom->mccs.interval = NULL;
     }
 
-    for (auto mcc : dom->mccs.blas)
+    for (auto & [ld_bytes, mcc] : dom->mccs.blas)
         mcc->unref();
     dom->mccs.blas.clear();
 
@@ -116,10 +121,14 @@ coherence_reset(runtime_t * runtime)
         dom->deps.interval = NULL;
     }
 
-    for (auto dep : dom->deps.blas)
+    for (auto & [ld_bytes, dep] : dom->deps.blas)
         delete dep;
     dom->deps.blas.clear();
 
+    for (access_reduction_t * reduction : dom->deps.reductions)
+        delete reduction;
+    dom->deps.reductions.clear();
+
     // deallocate all device memory
     memory_deallocate_all(runtime);
 }
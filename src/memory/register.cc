@@ -37,8 +37,14 @@
 **/
 
 # include <xkrt/runtime.h>
+# include <xkrt/logger/metric.h>
 # include <xkrt/memory/access/blas/memory-tree.hpp>
 
+# include <sys/mman.h>
+
+# include <cerrno>
+# include <cstring>
+
 # if XKRT_MEMORY_REGISTER_PAGE
 #  include <xkrt/memory/pageas.h>
 # endif /* XKRT_MEMORY_REGISTER_PAGE */
@@ -55,10 +61,10 @@ XKRT_NAMESPACE_BEGIN
 //      - it schedule 'pinning tasks' that are tasks with read/write access on the memory
 
 
-//  Some ideas:
-//      - can we lock pages in memory independently from CUDA / HIP / ... via
-//      'mlock' and notify the driver that the memory is locked ? Would be
-//      better in case of server with different GPU vendors...
+//  With `conf.memory_register_mlock`, pages are first locked in memory with
+//  'mlock', that also prefaults them, independently from CUDA / HIP / ...
+//  Asynchronous registrations lock their chunks in parallel over the team, so
+//  that drivers only have to pin pages already resident.
 
 
 # pragma message(TODO "The current implementation spawn independent tasks. Maybe make it dependent to a specific type of access")
@@ -86,13 +92,57 @@ __memory_register_get_memory_controller_task(runtime_t * runtime)
 }
 # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
 
-int
-runtime_t::memory_register(
+/* report the time it took to lock/register/unregister a range */
+static inline void
+__memory_range_report(
+    const char * what,
+    const void * ptr,
+    const size_t size,
+    const uint64_t ns
+) {
+    char bytes[32], time[32], bw[32];
+    metric_byte(bytes, sizeof(bytes), size);
+    metric_time(time, sizeof(time), ns);
+    metric_bandwidth(bw, sizeof(bw), ns ? (size_t) ((double) size / ((double) ns / 1e9)) : 0);
+    LOGGER_INFO("%s [%p..%p] (%s) in %s (%s)", what, ptr, (void *) ((uintptr_t) ptr + size), bytes, time, bw);
+}
+
+/* lock the pages in memory, and fault them */
+static inline void
+__memory_lock(runtime_t * runtime, void * ptr, size_t size)
+{
+    const uint64_t t0 = get_nanotime();
+    if (mlock(ptr, size))
+    {
+        LOGGER_WARN("Could not lock [%p..%p] in memory: %s - is `ulimit -l` large enough ?",
+                ptr, (void *) ((uintptr_t) ptr + size), strerror(errno));
+        return ;
+    }
+    __memory_range_report("Locked", ptr, size, get_nanotime() - t0);
+
+    # if XKRT_SUPPORT_STATS
+    runtime->stats.memory.locked += size;
+    # else
+    (void) runtime;
+    # endif /* XKRT_SUPPORT_STATS */
+}
+
+static inline void
+__memory_unlock(void * ptr, size_t size)
+{
+    if (munlock(ptr, size))
+        LOGGER_WARN("Could not unlock [%p..%p]: %s", ptr, (void *) ((uintptr_t) ptr + size), strerror(errno));
+}
+
+/* register the memory to the drivers, assuming it got locked already if it had to */
+static int
+__memory_register(
+    runtime_t * runtime,
     void * ptr,
     size_t size
 ) {
     # if XKRT_MEMORY_REGISTER_PAGE
-    if (this->conf.protect_registered_memory_overflow)
+    if (runtime->conf.protect_registered_memory_overflow)
         pageas(ptr, size, (uintptr_t *) &ptr, &size);
     # endif /* XKRT_MEMORY_REGISTER_PAGE */
 
@@ -103,7 +153,7 @@ runtime_t::memory_register(
 
     # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
     /* notify the current memory coherency controllers that the memory got registered */
-    task_t * task = __memory_register_get_memory_controller_task(this);
+    task_t * task = __memory_register_get_memory_controller_task(runtime);
     task_dom_info_t * dom = TASK_DOM_INFO(task);
     assert(dom);
     # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
@@ -111,7 +161,7 @@ runtime_t::memory_register(
     /* register the memory segment in each driver */
     for (uint8_t driver_id = 0 ; driver_id < XKRT_DRIVER_TYPE_MAX; ++driver_id)
     {
-        driver_t * driver = this->driver_get((driver_type_t) driver_id);
+        driver_t * driver = runtime->driver_get((driver_type_t) driver_id);
         if (!driver)
             continue ;
         if (!driver->f_memory_host_register)
@@ -120,7 +170,7 @@ runtime_t::memory_register(
         {
             # if XKRT_MEMORY_REGISTER_ASSISTED
             std::vector<Interval> intervals;
-            this->registered_pages.find(a, b, intervals);
+            runtime->registered_pages.find(a, b, intervals);
             assert(std::is_sorted(intervals.begin(), intervals.end()));
 
             unsigned int i = 0;
@@ -136,26 +186,29 @@ runtime_t::memory_register(
                     LOGGER_DEBUG("Registering [%lu..%lu] to driver %u", (uintptr_t) ptr, ((uintptr_t) ptr) + size, driver_id);
             # endif /* XKRT_MEMORY_REGISTER_ASSISTED */
 
+                    const uint64_t t0 = get_nanotime();
                     if (driver->f_memory_host_register(ptr, size))
                         LOGGER_ERROR("Could not register memory for driver `%s`", driver->f_get_name());
+                    else
+                        __memory_range_report(driver->f_get_name(), ptr, size, get_nanotime() - t0);
 
                     # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
-                    if (this->conf.protect_registered_memory_overflow)
+                    if (runtime->conf.protect_registered_memory_overflow)
                     {
-                        /* save in the registered map, for later accesses, that may use
-                         * different memory controllers */
-                        this->registered_memory[(uintptr_t)ptr] = size;
+                        /* save in the registered segments, for later accesses, that may use
+                         * different memory controllers, and for transfers */
+                        runtime->registered_memory.insert((uintptr_t)ptr, size);
 
-                        if (dom->mccs.interval)
+                        if (dom->mccs.interval && runtime->conf.segment_coherency == XKRT_SEGMENT_COHERENCY_TREE)
                             ((BLASMemoryTree *) dom->mccs.interval)->registered((uintptr_t)ptr, size);
 
-                        for (MemoryCoherencyController * mcc : dom->mccs.blas)
+                        for (auto & [ld_bytes, mcc] : dom->mccs.blas)
                             ((BLASMemoryTree *)mcc)->registered((uintptr_t)ptr, size);
                     }
                     # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
 
                     # if XKRT_SUPPORT_STATS
-                    this->stats.memory.registered += size;
+                    runtime->stats.memory.registered += size;
                     # endif /* XKRT_SUPPORT_STATS */
 
             # if XKRT_MEMORY_REGISTER_ASSISTED
@@ -170,17 +223,31 @@ runtime_t::memory_register(
     }
 
     # if XKRT_MEMORY_REGISTER_ASSISTED
-    this->registered_pages.fill(a, b);
+    runtime->registered_pages.fill(a, b);
     # endif /* XKRT_MEMORY_REGISTER_ASSISTED */
 
     return 0;
 }
 
+int
+runtime_t::memory_register(
+    void * ptr,
+    size_t size
+) {
+    if (this->conf.memory_register_mlock)
+        __memory_lock(this, ptr, size);
+    return __memory_register(this, ptr, size);
+}
+
 int
 runtime_t::memory_unregister(
     void * ptr,
     size_t size
 ) {
+    /* the range to unlock */
+    void * const unlock_ptr = ptr;
+    const size_t unlock_size = size;
+
     # if XKRT_MEMORY_REGISTER_PAGE
     if (this->conf.protect_registered_memory_overflow)
         pageas(ptr, size, (uintptr_t *) &ptr, &size);
@@ -221,20 +288,23 @@ runtime_t::memory_unregister(
                 LOGGER_DEBUG("Unregistering [%lu..%lu] to driver %u", (uintptr_t) ptr, ((uintptr_t) ptr) + size, driver_id);
             # endif /* XKRT_MEMORY_REGISTER_ASSISTED */
 
+                const uint64_t t0 = get_nanotime();
                 if (driver->f_memory_host_unregister(ptr, size))
                     LOGGER_ERROR("Could not unregister memory for driver `%s`", driver->f_get_name());
+                else
+                    __memory_range_report(driver->f_get_name(), ptr, size, get_nanotime() - t0);
 
                 # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
                 if (this->conf.protect_registered_memory_overflow)
                 {
-                    /* save in the registered map, for later accesses, that may use
-                     * different memory controllers */
-                    this->registered_memory.erase((uintptr_t)ptr);
+                    /* save in the registered segments, for later accesses, that may use
+                     * different memory controllers, and for transfers */
+                    this->registered_memory.erase((uintptr_t)ptr, size);
 
-                    if (dom->mccs.interval)
+                    if (dom->mccs.interval && this->conf.segment_coherency == XKRT_SEGMENT_COHERENCY_TREE)
                         ((BLASMemoryTree *) dom->mccs.interval)->unregistered((uintptr_t)ptr, size);
 
-                    for (MemoryCoherencyController * mcc : dom->mccs.blas)
+                    for (auto & [ld_bytes, mcc] : dom->mccs.blas)
                         ((BLASMemoryTree *)mcc)->unregistered((uintptr_t)ptr, size);
                 }
                 # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
@@ -253,6 +323,9 @@ runtime_t::memory_unregister(
     this->registered_pages.unfill(a, b);
     # endif /* XKRT_MEMORY_REGISTER_ASSISTED */
 
+    if (this->conf.memory_register_mlock)
+        __memory_unlock(unlock_ptr, unlock_size);
+
     return 0;
 }
 
@@ -297,7 +370,8 @@ typedef enum    memory_op_type_t
 {
     REGISTER,
     UNREGISTER,
-    TOUCH
+    TOUCH,
+    LOCK
 }               memory_op_type_t;
 
 constexpr size_t args_size = sizeof(memory_op_async_args_t);
@@ -311,14 +385,15 @@ body_memory_async(runtime_t * runtime, device_t * device, task_t * task)
     assert(runtime);
     assert(task);
 
-    constexpr task_access_counter_t AC = (T == TOUCH) ? 1 : 2;
+    constexpr task_access_counter_t AC = (T == TOUCH || T == LOCK) ? 1 : 2;
     constexpr size_t task_size = task_compute_size(flags, AC);
 
     memory_op_async_args_t * args = (memory_op_async_args_t *) TASK_ARGS(task, task_size);
     assert(args->start < args->end);
 
+    // pages got locked by the preceding LOCK task, if they had to
     if constexpr (T == REGISTER)
-        runtime->memory_register((void *) args->start, (size_t) (args->end - args->start));
+        __memory_register(runtime, (void *) args->start, (size_t) (args->end - args->start));
     else if constexpr (T == UNREGISTER)
         runtime->memory_unregister((void *) args->start, (size_t) (args->end - args->start));
     else if constexpr (T == TOUCH)
@@ -331,6 +406,8 @@ body_memory_async(runtime_t * runtime, device_t * device, task_t * task)
         for ( ; a < b ; a += pagesize)
             *a = 0;
     }
+    else if constexpr (T == LOCK)
+        __memory_lock(runtime, (void *) args->start, (size_t) (args->end - args->start));
 }
 
 template<memory_op_type_t T>
@@ -344,7 +421,7 @@ memory_op_async(
 ) {
     assert(n > 0);
 
-    constexpr task_access_counter_t AC = (T == TOUCH) ? 1 : 2;
+    constexpr task_access_counter_t AC = (T == TOUCH || T == LOCK) ? 1 : 2;
     constexpr size_t task_size = task_compute_size(flags, AC);
 
     thread_t * tls = thread_t::get_tls();
@@ -353,6 +430,7 @@ memory_op_async(
     const task_format_id_t fmtid = (T == REGISTER)   ? runtime->formats.memory_register_async   :
                                    (T == UNREGISTER) ? runtime->formats.memory_unregister_async :
                                    (T == TOUCH)      ? runtime->formats.memory_touch_async      :
+                                   (T == LOCK)       ? runtime->formats.memory_lock_async       :
                                    0;
     assert(fmtid);
 
@@ -417,6 +495,7 @@ memory_op_async(
                 T == REGISTER   ? "register"   :
                 T == UNREGISTER ? "unregister" :
                 T == TOUCH      ? "touch"      :
+                T == LOCK       ? "lock"       :
                 "(null)");
         # endif /* XKRT_SUPPORT_DEBUG */
 
@@ -447,6 +526,10 @@ runtime_t::memory_register_async(
     const size_t size,
     int n
 ) {
+    // lock and fault pages in parallel, chunks are then registered to the
+    // drivers once locked, as they are accessed in the same way
+    if (this->conf.memory_register_mlock)
+        memory_op_async<LOCK>(this, team, ptr, size, n);
     return memory_op_async<REGISTER>(this, team, ptr, size, n);
 }
 
@@ -486,6 +569,14 @@ memory_register_async_register_format(runtime_t * runtime)
         snprintf(format.label, sizeof(format.label), "memory_touch_async");
         runtime->formats.memory_touch_async = runtime->task_format_create(&format);
     }
+
+    {
+        task_format_t format;
+        memset(format.f, 0, sizeof(format.f));
+        format.f[XKRT_TASK_FORMAT_TARGET_HOST] = (task_format_func_t) body_memory_async<LOCK>;
+        snprintf(format.label, sizeof(format.label), "memory_lock_async");
+        runtime->formats.memory_lock_async = runtime->task_format_create(&format);
+    }
 }
 
 XKRT_NAMESPACE_END
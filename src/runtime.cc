@@ -79,27 +79,67 @@ runtime_t::init(void)
     memset(&this->stats, 0, sizeof(this->stats));
     # endif /* XKRT_SUPPORT_STATS */
 
-    // set affinities to 0
-    memset(&this->router.affinity, 0, sizeof(this->router.affinity));
+    // initialize routers (the runtime may have been allocated without construction) and set affinities to 0
+    new (&this->router_affinity) RouterAffinity();
+    new (&this->router_cfs) RouterCFS();
+    new (&this->router_bandwidth) RouterBandwidth();
+    memset(&this->router_affinity.affinity, 0, sizeof(this->router_affinity.affinity));
+    this->router = &this->router_affinity;
 
     // create topology
     hwloc_topology_init(&this->topology);
     hwloc_topology_load(this->topology);
+    for (std::atomic<uint64_t> & entry : this->host_numa_nodes)
+        entry.store(0, std::memory_order_relaxed);
 
     // load
     this->conf.init();
     task_format_register(this);
 
+    // pages are the unit of coherency of the paged segment controller: two
+    // accesses to disjoint bytes of a same page must not run concurrently
+    if (this->conf.segment_coherency == XKRT_SEGMENT_COHERENCY_PAGED)
+        task_dependency_granularity(this->conf.segment_page_size);
+    else
+        task_dependency_granularity(1);
+
     // the '+1' is to enforce the host device, always
     drivers_init(this);
 
-    # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
-    // initialize the registered memory map
-    if (this->conf.protect_registered_memory_overflow)
+    // select the router, now that devices reported their affinities
+    switch (this->conf.router)
     {
-        new (&this->registered_memory) std::map<uintptr_t, size_t>();
+        case (XKRT_ROUTER_TYPE_CFS):
+        {
+            this->router_cfs.set_weights_from_affinity(this->router_affinity.affinity, this->drivers.devices.n);
+            this->router = &this->router_cfs;
+            break ;
+        }
+
+        case (XKRT_ROUTER_TYPE_BANDWIDTH):
+        {
+            memcpy(this->router_bandwidth.affinity, this->router_affinity.affinity, sizeof(this->router_affinity.affinity));
+            this->router_bandwidth.split_threshold = this->conf.router_split_threshold;
+            for (device_global_id_t device_global_id = 0 ; device_global_id < this->drivers.devices.n ; ++device_global_id)
+            {
+                device_t * device = this->drivers.devices.list[device_global_id];
+                const int nthreads = device->team->get_nthreads();
+                for (int device_tid = 0 ; device_tid < nthreads ; ++device_tid)
+                    for (queue_type_t qtype : {XKRT_QUEUE_TYPE_H2D, XKRT_QUEUE_TYPE_D2H, XKRT_QUEUE_TYPE_D2D})
+                        for (int queue_id = 0 ; queue_id < device->count[qtype] ; ++queue_id)
+                            this->router_bandwidth.add_queue(device_global_id, device->queues[device_tid][qtype][queue_id]);
+            }
+            this->router = &this->router_bandwidth;
+            break ;
+        }
+
+        case (XKRT_ROUTER_TYPE_AFFINITY):
+        default:
+            break ;
     }
-    else
+
+    # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
+    if (!this->conf.protect_registered_memory_overflow)
     {
         LOGGER_WARN("Compiled with `MEMORY_REGISTER_OVERFLOW_PROTECTION` but `XKAAPI_MEMORY_REGISTER_PROTECT_OVERFLOW` environment variable is not set");
     }
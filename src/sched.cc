@@ -53,6 +53,7 @@
 #  include <julia.h>
 # endif
 
+# include <algorithm>
 # include <cassert>
 # include <cstring>
 # include <cerrno>
@@ -68,6 +69,13 @@ XKRT_NAMESPACE_BEGIN
 //  DEVICE PROGRESSION //
 /////////////////////////
 
+/**
+ *  Split a moldable task in two: its accesses are split following their split
+ *  mode, and the part of the task holding the second halves is submitted.
+ *  The dependencies of the task are not refined: all its parts are ready
+ *  already, and the task completes once all its parts did (see `task_dup`),
+ *  so its current and future successors wait on all of them.
+ */
 static inline void
 __task_moldable_split(
     runtime_t * runtime,
@@ -75,82 +83,180 @@ __task_moldable_split(
     access_t * accesses,
     task_dep_info_t * dep
 ) {
-    // right now, all task accesses must have the same type
-    const access_type_t type = (accesses + 0)->type;
+    // dupplicate the task
+    task_t * dup_task = runtime->task_dup(task);
+    assert(dup_task);
 
-    # if XKRT_SUPPORT_DEBUG
-    for (task_access_counter_t i = 1 ; i < dep->ac ; ++i)
-        assert(type == (accesses + i)->type);
-    # endif /* atm, only support moldable tasks with accesses of same type */
+    // split accesses
+    access_t * dup_accesses = TASK_ACCESSES(dup_task);
+    assert(dup_accesses);
 
-    switch (type)
+    // for each access
+    for (task_access_counter_t i = 0 ; i < dep->ac ; ++i)
     {
-        case (ACCESS_TYPE_SEGMENT):
+        access_t * access     = accesses     + i;
+        access_t * dup_access = dup_accesses + i;
+
+        assert(access->task     == task);
+        assert(dup_access->task == task);
+
+        // split access
+        access_t::split(access, dup_access, dup_task, access->split_mode);
+        assert(dup_access->task == dup_task);
+        assert(dup_access->successors.empty());
+    }
+
+    // submit the dupplicated task
+    assert(dup_task->parent);
+    assert(dup_task->parent == task->parent);
+
+    # pragma message(TODO "This is quite ugly, can we have tasks go through a more regular transition path ? At that point, the dupplicated task is in the 'ready' state already, as its original task was ready")
+    ++dup_task->parent->cc;
+    runtime_submit_task(runtime, dup_task);
+}
+
+/* return true if the task accesses can still be split (none got prefetched) */
+static inline bool
+__task_moldable_splittable(
+    access_t * accesses,
+    task_dep_info_t * dep
+) {
+    for (task_access_counter_t i = 0 ; i < dep->ac ; ++i)
+        if (accesses[i].state != ACCESS_STATE_INIT)
+            return false;
+    return true;
+}
+
+/* number of threads of the team, other than the calling one, that are not
+ * executing a task and would not find one already queued */
+static inline int
+__team_idle_threads(team_t * team)
+{
+    thread_t * self = thread_t::get_tls();
+
+    int idle = 0;
+    size_t queued = 0;
+    const int nthreads = team->get_nthreads();
+    for (int tid = 0 ; tid < nthreads ; ++tid)
+    {
+        thread_t * thread = team->get_thread(tid);
+        queued += thread->deque.size();
+        if (thread != self && thread->current_task == &thread->implicit_task)
+            ++idle;
+    }
+    return (queued < (size_t) idle) ? idle - (int) queued : 0;
+}
+
+/* number of devices, other than the given one, with no tasks queued and no
+ * commands ready or pending */
+static inline int
+__devices_idle(
+    runtime_t * runtime,
+    device_t * self
+) {
+    int idle = 0;
+    for (device_global_id_t device_global_id = 0 ; device_global_id < runtime->drivers.devices.n ; ++device_global_id)
+    {
+        if (device_global_id == HOST_DEVICE_GLOBAL_ID || device_global_id == self->global_id)
+            continue ;
+
+        device_t * device = runtime->drivers.devices.list[device_global_id];
+        if (device == NULL || device->state != XKRT_DEVICE_STATE_COMMIT)
+            continue ;
+
+        bool busy = false;
+        const int nthreads = device->team->get_nthreads();
+        for (int tid = 0 ; tid < nthreads && !busy ; ++tid)
         {
-            // dupplicate the task
-            task_t * dup_task = runtime->task_dup(task);
-            assert(dup_task);
+            bool ready, pending;
+            device->offloader_queues_are_empty(tid, XKRT_QUEUE_TYPE_ALL, &ready, &pending);
+            busy = ready || pending || device->team->get_thread(tid)->deque.size();
+        }
+        if (!busy)
+            ++idle;
+    }
+    return idle;
+}
 
-            // split accesses and refine dependencies
-            access_t * dup_accesses = TASK_ACCESSES(dup_task);
-            assert(dup_accesses);
+/**
+ *  Number of times a moldable task should be halved by the automatic split
+ *  policy: enough to have a part for each idle resource that may execute it
+ *  (threads of the host team for host tasks, devices for device tasks), but
+ *  without splitting accesses bellow `conf.moldable_split_min_size` bytes.
+ */
+static inline int8_t
+__task_moldable_split_depth(
+    runtime_t * runtime,
+    device_t * device,
+    task_t * task,
+    access_t * accesses,
+    task_dep_info_t * dep
+) {
+    // size of the largest access that splits
+    size_t size = 0;
+    for (task_access_counter_t i = 0 ; i < dep->ac ; ++i)
+    {
+        access_t * access = accesses + i;
+        if (access->split_mode == ACCESS_SPLIT_MODE_NO_SPLIT)
+            continue ;
+        if (access->type != ACCESS_TYPE_SEGMENT && access->type != ACCESS_TYPE_BLAS_MATRIX)
+            return 0;
+        if (access->type == ACCESS_TYPE_BLAS_MATRIX &&
+                (access->region.matrix.uplo != MATRIX_UPLO_GENERAL || !matrix_halo_is_empty(access->region.matrix.halo)))
+            return 0;
+        const size_t s = access->host_view.m * access->host_view.n * access->host_view.sizeof_type;
+        if (s > size)
+            size = s;
+    }
 
-            // for each access
-            for (task_access_counter_t i = 0 ; i < dep->ac ; ++i)
-            {
-                access_t * access     = accesses     + i;
-                access_t * dup_access = dup_accesses + i;
+    // resources that may execute a part, including the current one
+    const int resources = 1 + ((task->flags & TASK_FLAG_DEVICE) ?
+            __devices_idle(runtime, device) :
+            __team_idle_threads(runtime->device_get(HOST_DEVICE_GLOBAL_ID)->team));
 
-                assert(access->task     == task);
-                assert(dup_access->task == task);
-                dup_access->task = dup_task;
-                assert(access->task     == task);
-                assert(dup_access->task == dup_task);
+    const size_t min_size = runtime->conf.moldable_split_min_size ? runtime->conf.moldable_split_min_size : 1;
+    const size_t nparts = std::min((size_t) resources, size / min_size);
 
-                // split access
-                access_t::split(access, dup_access, dup_task, ACCESS_SPLIT_MODE_HALVES);
+    int8_t depth = 0;
+    while (((size_t) 2 << depth) <= nparts)
+        ++depth;
+    return depth;
+}
 
-                // for each original successor
-                for (access_t * succ_access : access->successors)
-                {
-                    // if new access conflicts
-                    if (access_t::conflicts(dup_access, succ_access))
-                    {
-                        // set a dependency
-                        __access_precedes(dup_access, succ_access);
-                    }
-                    else
-                    {
-                        // nothing to do
-                    }
-
-                    // if shrinked access still conflicts
-                    if (access_t::conflicts(access, succ_access))
-                    {
-                        // nothing to do, we recycle task and the access,
-                        // so the dependency is already set
-                    }
-                    else
-                    {
-                        // TODO: unset the dependency
-                        LOGGER_FATAL("TODO: should unref once the successor");
-                    }
-                }
-            }
+/* return true if the moldable task must split now */
+static inline bool
+__task_moldable_must_split(
+    runtime_t * runtime,
+    device_t * device,
+    task_t * task,
+    access_t * accesses,
+    task_dep_info_t * dep
+) {
+    task_mol_info_t * mol = TASK_MOL_INFO(task);
+    assert(mol->split_condition);
 
-            // submit the dupplicated task
-            assert(dup_task->parent);
-            assert(dup_task->parent == task->parent);
+    if (!__task_moldable_splittable(accesses, dep))
+        return false;
 
-            # pragma message(TODO "This is quite ugly, can we have tasks go through a more regular transition path ? At that point, the dupplicated task is in the 'ready' state already, as its original task was ready")
-            ++dup_task->parent->cc;
-            runtime_submit_task(runtime, dup_task);
+    switch (runtime->conf.moldable_split)
+    {
+        case (XKRT_MOLDABLE_SPLIT_POLICY_USER):
+            return mol->split_condition(task, accesses);
 
-            break ;
+        case (XKRT_MOLDABLE_SPLIT_POLICY_AUTO):
+        {
+            // the depth is decided once, on the original task, and inherited
+            // by its parts (see `task_dup`) so it yields 2^depth parts
+            if (mol->split_depth < 0)
+                mol->split_depth = __task_moldable_split_depth(runtime, device, task, accesses, dep);
+            if (mol->split_depth == 0 || !mol->split_condition(task, accesses))
+                return false;
+            --mol->split_depth;
+            return true;
         }
 
         default:
-            LOGGER_FATAL("Not supported");
+            LOGGER_FATAL("Unknown moldable split policy `%d`", runtime->conf.moldable_split);
     }
 }
 
@@ -190,12 +296,8 @@ __device_prepare_task(
             /* if the task is moldable */
             if (task->flags & TASK_FLAG_MOLDABLE)
             {
-                /* check split condition, and split, or execute normally */
-                task_mol_info_t * mol = TASK_MOL_INFO(task);
-                assert(mol->split_condition);
-
                 /* if the moldable task must split */
-                if (mol->split_condition(task, accesses))
+                if (__task_moldable_must_split(runtime, device, task, accesses, dep))
                 {
                     // shrink the moldable task, and resubmit the original task
                     // whose accesses got shrinked
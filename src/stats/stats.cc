@@ -58,6 +58,26 @@ typedef struct  device_stats_t
         } allocated;
         stats_int_t registered;
         stats_int_t unregistered;
+        stats_int_t locked;
+        struct {
+            stats_int_t merged;
+        } forwards;
+        struct {
+            stats_int_t hits;
+            stats_int_t misses;
+            stats_int_t joined;
+            stats_int_t overwrites;
+            stats_int_t evictions;
+            stats_int_t evicted;
+            stats_int_t relocations;
+            stats_int_t relocated;
+            stats_int_t prefetches;
+            stats_int_t prefetched;
+        } coherence;
+        struct {
+            stats_int_t copies;
+            stats_int_t pages;
+        } paged;
         struct {
             struct {
                 stats_int_t device;
@@ -87,6 +107,12 @@ stats_device_agg_gather(runtime_t * runtime, device_stats_t * agg)
 {
     agg->memory.registered   += runtime->stats.memory.registered;
     agg->memory.unregistered += runtime->stats.memory.unregistered;
+    agg->memory.locked       += runtime->stats.memory.locked;
+
+    agg->memory.forwards.merged += runtime->stats.memory.forwards.merged;
+
+    agg->memory.paged.copies += runtime->stats.memory.paged.copies;
+    agg->memory.paged.pages  += runtime->stats.memory.paged.pages;
 
     agg->memory.unified.advised.device += runtime->stats.memory.unified.advised.device;
     agg->memory.unified.advised.host   += runtime->stats.memory.unified.advised.host;
@@ -102,6 +128,17 @@ stats_device_agg(device_stats_t * src, device_stats_t * agg)
     agg->memory.allocated.total += src->memory.allocated.total;
     agg->memory.allocated.currently += src->memory.allocated.currently;
 
+    agg->memory.coherence.hits      += src->memory.coherence.hits;
+    agg->memory.coherence.misses    += src->memory.coherence.misses;
+    agg->memory.coherence.joined    += src->memory.coherence.joined;
+    agg->memory.coherence.overwrites += src->memory.coherence.overwrites;
+    agg->memory.coherence.evictions += src->memory.coherence.evictions;
+    agg->memory.coherence.evicted   += src->memory.coherence.evicted;
+    agg->memory.coherence.relocations += src->memory.coherence.relocations;
+    agg->memory.coherence.relocated   += src->memory.coherence.relocated;
+    agg->memory.coherence.prefetches  += src->memory.coherence.prefetches;
+    agg->memory.coherence.prefetched  += src->memory.coherence.prefetched;
+
     for (int stype = 0 ; stype < XKRT_QUEUE_TYPE_ALL ; ++stype)
     {
         agg->queues[stype].n += src->queues[stype].n;
@@ -144,8 +181,42 @@ stats_device_report(device_stats_t * stats)
 
         metric_byte(buffer, sizeof(buffer), stats->memory.unregistered.load());
         LOGGER_WARN("    Unregistered: %s", buffer);
+
+        if (stats->memory.locked.load())
+        {
+            metric_byte(buffer, sizeof(buffer), stats->memory.locked.load());
+            LOGGER_WARN("    Locked: %s", buffer);
+        }
     }
 
+    if (stats->memory.coherence.hits.load() || stats->memory.coherence.misses.load() || stats->memory.coherence.joined.load() || stats->memory.coherence.overwrites.load())
+        LOGGER_WARN("    Coherence: %zu hits - %zu misses - %zu joined in-flight - %zu overwrites",
+            stats->memory.coherence.hits.load(), stats->memory.coherence.misses.load(), stats->memory.coherence.joined.load(), stats->memory.coherence.overwrites.load());
+
+    if (stats->memory.coherence.evictions.load())
+    {
+        metric_byte(buffer, sizeof(buffer), stats->memory.coherence.evicted.load());
+        LOGGER_WARN("    Evictions: %zu (%s)", stats->memory.coherence.evictions.load(), buffer);
+    }
+
+    if (stats->memory.coherence.relocations.load())
+    {
+        metric_byte(buffer, sizeof(buffer), stats->memory.coherence.relocated.load());
+        LOGGER_WARN("    Relocations: %zu (%s)", stats->memory.coherence.relocations.load(), buffer);
+    }
+
+    if (stats->memory.coherence.prefetches.load())
+    {
+        metric_byte(buffer, sizeof(buffer), stats->memory.coherence.prefetched.load());
+        LOGGER_WARN("    Prefetches: %zu (%s)", stats->memory.coherence.prefetches.load(), buffer);
+    }
+
+    if (stats->memory.forwards.merged.load())
+        LOGGER_WARN("    Forwards merged (transfers saved): %zu", stats->memory.forwards.merged.load());
+
+    if (stats->memory.paged.copies.load())
+        LOGGER_WARN("    Paged copies: %zu (%zu pages)", stats->memory.paged.copies.load(), stats->memory.paged.pages.load());
+
     if (stats->memory.unified.advised.device.load() || stats->memory.unified.advised.host.load())
     {
         metric_byte(buffer, sizeof(buffer), stats->memory.unified.advised.device.load());
@@ -187,6 +258,62 @@ stats_device_report(device_stats_t * stats)
     }
 }
 
+/* report the latency histogram, skipping empty buckets */
+static void
+stats_latency_report(const char * label, const uint64_t latency[AREA_LATENCY_BUCKETS])
+{
+    char line[512];
+    int n = 0;
+    for (int i = 0 ; i < AREA_LATENCY_BUCKETS ; ++i)
+    {
+        if (latency[i] == 0)
+            continue ;
+        char bound[32];
+        if (i == AREA_LATENCY_BUCKETS - 1)
+        {
+            metric_time(bound, sizeof(bound), 1UL << (AREA_LATENCY_MIN_LOG2 + i - 1));
+            n += snprintf(line + n, sizeof(line) - n, " >=%s: %lu", bound, latency[i]);
+        }
+        else
+        {
+            metric_time(bound, sizeof(bound), 1UL << (AREA_LATENCY_MIN_LOG2 + i));
+            n += snprintf(line + n, sizeof(line) - n, " <%s: %lu", bound, latency[i]);
+        }
+        if (n >= (int) sizeof(line))
+            break ;
+    }
+    if (n)
+        LOGGER_WARN("      %s latency:%s", label, line);
+}
+
+static void
+stats_device_memories_report(device_t * device)
+{
+    char used[32], reserved[32], limit[32], peak[32], free_bytes[32], largest[32];
+
+    for (int i = 0 ; i < device->nmemories ; ++i)
+    {
+        area_stats_t stats;
+        device->memory_stats_on(i, &stats);
+        if (stats.reserved == 0 && stats.allocations == 0)
+            continue ;
+
+        metric_byte(used,       sizeof(used),       stats.used);
+        metric_byte(reserved,   sizeof(reserved),   stats.reserved);
+        metric_byte(limit,      sizeof(limit),      stats.limit);
+        metric_byte(peak,       sizeof(peak),       stats.peak);
+        metric_byte(free_bytes, sizeof(free_bytes), stats.free);
+        metric_byte(largest,    sizeof(largest),    stats.largest);
+
+        LOGGER_WARN("  Memory `%s`", device->memories[i].name);
+        LOGGER_WARN("    Used: %s (peak %s) - Reserved: %s in %d segments (limit %s)", used, peak, reserved, stats.nsegments, limit);
+        LOGGER_WARN("    Free: %s in %zu chunks - largest %s (%.2f fragmented)", free_bytes, stats.nfree, largest, stats.fragmentation);
+        LOGGER_WARN("    Allocations: %lu (%lu failed) - %lu reclaimed memory", stats.allocations, stats.failures, stats.reclaims);
+        stats_latency_report("Allocation", stats.latency);
+        stats_latency_report("Reclaim", stats.reclaim_latency);
+    }
+}
+
 static void
 stats_device_gather(
     device_t * device,
@@ -198,6 +325,17 @@ stats_device_gather(
     stats->memory.allocated.total = device->stats.memory.allocated.total.load();
     stats->memory.allocated.currently = device->stats.memory.allocated.currently.load();
 
+    stats->memory.coherence.hits      = device->stats.memory.coherence.hits.load();
+    stats->memory.coherence.misses    = device->stats.memory.coherence.misses.load();
+    stats->memory.coherence.joined    = device->stats.memory.coherence.joined.load();
+    stats->memory.coherence.overwrites = device->stats.memory.coherence.overwrites.load();
+    stats->memory.coherence.evictions = device->stats.memory.coherence.evictions.load();
+    stats->memory.coherence.evicted   = device->stats.memory.coherence.evicted.load();
+    stats->memory.coherence.relocations = device->stats.memory.coherence.relocations.load();
+    stats->memory.coherence.relocated   = device->stats.memory.coherence.relocated.load();
+    stats->memory.coherence.prefetches  = device->stats.memory.coherence.prefetches.load();
+    stats->memory.coherence.prefetched  = device->stats.memory.coherence.prefetched.load();
+
     int nthreads = device->team->get_nthreads();
     for (int device_tid = 0 ; device_tid < nthreads ; ++device_tid)
     {
@@ -283,6 +421,7 @@ runtime_t::stats_report(void)
         device_stats_t stats;
         stats_device_gather(device, &stats);
         stats_device_report(&stats);
+        stats_device_memories_report(device);
         stats_device_agg(&stats, &agg);
     }
     stats_device_agg_gather(this, &agg);
@@ -294,6 +433,12 @@ runtime_t::stats_report(void)
     LOGGER_WARN("Tasks");
     stats_tasks_report(this);
     LOGGER_WARN("-----------------------------------------");
+    if (this->router == &this->router_bandwidth)
+    {
+        LOGGER_WARN("Links bandwidth");
+        this->router_bandwidth.dump(stderr);
+        LOGGER_WARN("-----------------------------------------");
+    }
 }
 
 # endif /* XKRT_SUPPORT_STATS */
@@ -51,6 +51,7 @@
 # include <cassert>
 # include <cstring>
 # include <cerrno>
+# include <cstdlib>
 
 XKRT_NAMESPACE_BEGIN
 
@@ -125,23 +126,31 @@ __task_guess_device(
         if (dev->targeted_device_id != UNSPECIFIED_DEVICE_GLOBAL_ID)
             return dev->targeted_device_id;
 
-        // if it has an OCR, we may already know which device will own most
-        // bytes once all predecessor tasks finished their execution, but its
-        // not trivial to implement at that point. So it is not supported yet.
-        // This should:
-        //  - for each access of the task
-        //      - get predecessor writers
-        //      - get place of execution of writers
-        //      - if they are all known,
-        //          - return the device with most bytes written
-        //      - else
-        //          - if amongst known devices, one owns more than half of the bytes,
-        //              - return this device
-        //          - else
-        //              - we dont know yet, return UNSPECIFIED_DEVICE
-        if (dev->ocr_access_index)
+        // if it has an OCR, it is called after a predecessor wrote the data,
+        // so the device owning most bytes of the OCR access is known. Elect
+        // it now, so the prefetch and the execution happen on the same device
+        if (dev->ocr_access_index != UNSPECIFIED_TASK_ACCESS)
         {
-            # pragma message(TODO "See file and comment: implement pre-fetching for tasks with OCR")
+            // already resolved by a previous prefetch
+            if (dev->elected_device_id != UNSPECIFIED_DEVICE_GLOBAL_ID)
+                return dev->elected_device_id;
+
+            assert(task->flags & TASK_FLAG_DEPENDENT);
+            access_t * access = TASK_ACCESSES(task) + dev->ocr_access_index;
+            MemoryCoherencyController * memcontroller = task_get_memory_controller(runtime, task->parent, access);
+            if (memcontroller == NULL)
+                return UNSPECIFIED_DEVICE_GLOBAL_ID;
+
+            // retrieve owners excluding the host device
+            const device_global_id_bitfield_t bitmask = (device_global_id_bitfield_t) ((1 << runtime->drivers.devices.n) - 1) & ~(1 << HOST_DEVICE_GLOBAL_ID);
+            const device_global_id_bitfield_t owners = memcontroller->who_owns(access) & bitmask;
+            if (owners == 0)
+                return UNSPECIFIED_DEVICE_GLOBAL_ID;
+
+            // elect one of them, unless a concurrent completion already did
+            const device_global_id_t device_global_id = (device_global_id_t) __random_set_bit(owners) - 1;
+            const device_global_id_t elected = __sync_val_compare_and_swap(&dev->elected_device_id, UNSPECIFIED_DEVICE_GLOBAL_ID, device_global_id);
+            return (elected == UNSPECIFIED_DEVICE_GLOBAL_ID) ? device_global_id : elected;
         }
 
         // could not find the device to execute
@@ -152,13 +161,225 @@ __task_guess_device(
         return HOST_DEVICE_GLOBAL_ID;
 }
 
+/* claim the access for a prefetch on the given device, and account it in the
+ * device prefetched bytes - return false if another predecessor claimed the
+ * access already, or if it would exceed the prefetch bound of the device */
+static inline bool
+__task_prefetch_reserve(
+    runtime_t * runtime,
+    device_global_id_t device_global_id,
+    access_t * access
+) {
+    device_t * device = runtime->device_get(device_global_id);
+    assert(device);
+
+    // writer predecessors may complete concurrently, only one may prefetch
+    if (__sync_val_compare_and_swap(&access->prefetch_device_global_id, UNSPECIFIED_DEVICE_GLOBAL_ID, device_global_id) != UNSPECIFIED_DEVICE_GLOBAL_ID)
+        return false;
+
+    const size_t size = access->host_view.m * access->host_view.n * access->host_view.sizeof_type;
+    if (device->nmemories > 0)
+    {
+        const double capacity = (double) device->memories[0].capacity * (double) (runtime->conf.device.gpu_mem_percent / 100.0);
+        const size_t limit = (size_t) (capacity * (double) (runtime->conf.prefetch_mem_percent / 100.0));
+
+        size_t prefetched = device->prefetched.load(std::memory_order_relaxed);
+        do {
+            if (prefetched + size > limit)
+            {
+                access->prefetch_device_global_id = UNSPECIFIED_DEVICE_GLOBAL_ID;
+                return false;
+            }
+        } while (!device->prefetched.compare_exchange_weak(prefetched, prefetched + size, std::memory_order_relaxed));
+    }
+    else
+        device->prefetched.fetch_add(size, std::memory_order_relaxed);
+
+    XKRT_STATS_INCR(device->stats.memory.coherence.prefetches, 1);
+    XKRT_STATS_INCR(device->stats.memory.coherence.prefetched, size);
+    return true;
+}
+
+/* release the prefetched bytes of the access */
+static inline void
+__task_prefetch_release(
+    runtime_t * runtime,
+    access_t * access
+) {
+    device_t * device = runtime->device_get(access->prefetch_device_global_id);
+    assert(device);
+
+    const size_t size = access->host_view.m * access->host_view.n * access->host_view.sizeof_type;
+    device->prefetched.fetch_sub(size, std::memory_order_relaxed);
+    access->prefetch_device_global_id = UNSPECIFIED_DEVICE_GLOBAL_ID;
+}
+
+/////////////////
+// REDUCTIONS  //
+/////////////////
+
+/**
+ *  Combine the partials of the reduction into its data: pairwise in log2(n)
+ *  rounds, and then the remaining one column per column.
+ *  Must be called with the reduction lock held.
+ */
+static inline void
+__reduction_combine(access_reduction_t * reduction)
+{
+    std::vector<std::pair<task_t *, void *>> & partials = reduction->partials;
+    const size_t npartials = partials.size();
+    if (npartials == 0)
+        return ;
+
+    const memory_view_t & view = reduction->view;
+    const size_t col = view.m * view.sizeof_type;
+    const size_t size = col * view.n;
+
+    for (size_t stride = 1 ; stride < npartials ; stride *= 2)
+        for (size_t i = 0 ; i + stride < npartials ; i += 2 * stride)
+            reduction->op(partials[i].second, partials[i + stride].second, size);
+
+    for (size_t j = 0 ; j < view.n ; ++j)
+        reduction->op(
+            (void *) (view.addr + j * view.ld * view.sizeof_type),
+            (const void *) ((const uint8_t *) partials[0].second + j * col),
+            col
+        );
+
+    for (auto & [owner, partial] : partials)
+    {
+        assert(owner == NULL);
+        free(partial);
+    }
+    partials.clear();
+}
+
+/**
+ *  Bind the reduce accesses of the task to a private copy that no other
+ *  executing task uses: the task accumulates into `access->device_view`.
+ *  The copy is bound to the task rather than to the executing thread, so the
+ *  task may be suspended and resumed on another thread meanwhile.
+ *  Partials are compact copies of the whole reduced data, so accesses split
+ *  from a moldable task bind to their part of it.
+ */
+static inline void
+__task_reductions_bind(task_t * task)
+{
+    task_dep_info_t * dep = TASK_DEP_INFO(task);
+    access_t * accesses = TASK_ACCESSES(task);
+    for (task_access_counter_t i = 0 ; i < dep->ac ; ++i)
+    {
+        access_t * access = accesses + i;
+        if (!(access->mode & ACCESS_MODE_P))
+            continue ;
+
+        access_reduction_t * reduction = access->reduction;
+        assert(reduction);
+        const memory_view_t & view = reduction->view;
+
+        void * partial = NULL;
+        SPINLOCK_LOCK(reduction->lock);
+        {
+            ++reduction->executing;
+            for (auto & [owner, p] : reduction->partials)
+            {
+                if (owner == NULL)
+                {
+                    owner = task;
+                    partial = p;
+                    break ;
+                }
+            }
+            if (partial == NULL)
+            {
+                partial = calloc(1, view.size());
+                if (partial == NULL)
+                    LOGGER_FATAL("Could not allocate the private copy of a reduction");
+                reduction->partials.push_back({task, partial});
+            }
+        }
+        SPINLOCK_UNLOCK(reduction->lock);
+
+        // offset of the access in the reduced data
+        const size_t lds    = view.ld * view.sizeof_type;
+        const size_t offset = access->host_view.addr - view.addr;
+        const size_t i0     = (offset % lds) / view.sizeof_type;
+        const size_t j0     = offset / lds;
+        access->device_view.addr = (uintptr_t) partial + (i0 + j0 * view.m) * view.sizeof_type;
+        access->device_view.ld   = view.m;
+    }
+}
+
+/* return true if an access that is not a reduce of the same reduction
+ * depends on 'access', so the reduction must be complete before it runs */
+static inline bool
+__access_reduction_closed(const access_t * access)
+{
+    for (const access_t * succ : access->successors)
+        if (!(succ->mode & ACCESS_MODE_P) || succ->reduction != access->reduction)
+            return true;
+    return false;
+}
+
+/**
+ *  The reduce accesses of the task completed: partials are kept for the next
+ *  reduces, and combined once none is executing and either the last reduce
+ *  completed, or an access that is not part of the reduction depends on them.
+ *  Must be called with the task state lock held, so no successor may link
+ *  to the task meanwhile.
+ */
+static inline void
+__task_reductions_release(task_t * task)
+{
+    const bool executed = (task->state.value == TASK_STATE_EXECUTING);
+
+    task_dep_info_t * dep = TASK_DEP_INFO(task);
+    access_t * accesses = TASK_ACCESSES(task);
+    for (task_access_counter_t i = 0 ; i < dep->ac ; ++i)
+    {
+        access_t * access = accesses + i;
+        if (!(access->mode & ACCESS_MODE_P))
+            continue ;
+
+        access_reduction_t * reduction = access->reduction;
+        assert(reduction);
+
+        SPINLOCK_LOCK(reduction->lock);
+        {
+            if (executed)
+            {
+                // release the partial of the task, for the next ones
+                for (auto & [owner, p] : reduction->partials)
+                {
+                    if (owner == task)
+                    {
+                        owner = NULL;
+                        break ;
+                    }
+                }
+
+                assert(reduction->executing > 0);
+                --reduction->executing;
+            }
+
+            const bool last = (reduction->pending.load(std::memory_order_relaxed) == 1);
+            if (reduction->executing == 0 && (last || __access_reduction_closed(access)))
+                __reduction_combine(reduction);
+        }
+        SPINLOCK_UNLOCK(reduction->lock);
+
+        // the reduction may now be reclaimed by the thread executing the domain
+        reduction->pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
 /**
  *  - transition the task to completed
  *  - initiate memory prefetching for successors whose place of execution is known
  *  - enqueue all ready successors
  */
 static inline void
-__task_complete(
+__task_do_complete(
     runtime_t * runtime,
     task_t * task
 ) {
@@ -176,16 +397,19 @@ __task_complete(
     // transition the task
     SPINLOCK_LOCK(task->state.lock);
     {
+        // combine the private copies of the reduces, before successors may
+        // run, or see the task completed and not depend on it
+        if (task->flags & TASK_FLAG_DEPENDENT)
+            __task_reductions_release(task);
+
         task->state.value = TASK_STATE_COMPLETED;
         LOGGER_DEBUG_TASK_STATE(task);
     }
     SPINLOCK_UNLOCK(task->state.lock);
     assert(task->parent);
+    task_t * parent = task->parent;
 
-    // TODO: instead, can we have a counter per thread, to reduce the number of
-    // updates on the 'parent' counter ?
     XKRT_STATS_INCR(runtime->stats.tasks[task->fmtid].completed, 1);
-    task->parent->cc.fetch_sub(1, std::memory_order_relaxed);
 
     // if the task has successors, that dependency is now satisfied
     if (task->flags & TASK_FLAG_DEPENDENT)
@@ -196,6 +420,17 @@ __task_complete(
         {
             access_t * access = accesses + i;
 
+            // the device memory used by the task may be evicted again
+            if (access->device_chunk)
+            {
+                area_chunk_unpin(access->device_chunk);
+                access->device_chunk = NULL;
+            }
+
+            // the prefetched memory got consumed
+            if (access->prefetch_device_global_id != UNSPECIFIED_DEVICE_GLOBAL_ID)
+                __task_prefetch_release(runtime, access);
+
             // detached access, not my responsibility to fulfill this dependency
             if (access->mode & ACCESS_MODE_D)
                 continue ;
@@ -214,18 +449,21 @@ __task_complete(
                     // if the succ access is not being fetched, or got fetched already
                     if (succ_access->state == ACCESS_STATE_INIT)
                     {
-                        // if the pred access wrote memory
-                        if (access->mode & ACCESS_MODE_W)
+                        // if the pred access wrote memory that the succ access reads - reduces
+                        // are excluded: the data is only complete once all of them were combined
+                        if ((access->mode & ACCESS_MODE_W) && (succ_access->mode & ACCESS_MODE_R) &&
+                                !(access->mode & ACCESS_MODE_P) && !(succ_access->mode & ACCESS_MODE_P))
                         {
                             // if successor device can already be known
                             const device_global_id_t device_global_id = __task_guess_device(runtime, succ);
                             if (device_global_id != UNSPECIFIED_DEVICE_GLOBAL_ID)
                             {
-                                // then we can prefetch memory
+                                // then we can prefetch memory, if the device did not prefetch too much already
                                 MemoryCoherencyController * mcc = task_get_memory_controller(
                                         runtime, succ->parent, succ_access);
-                                if (mcc)
-                                    mcc->fetch(succ_access, device_global_id);
+                                if (mcc && __task_prefetch_reserve(runtime, device_global_id, succ_access))
+                                    if (!mcc->fetch(succ_access, device_global_id))
+                                        __task_prefetch_release(runtime, succ_access);
                             }
                         }
                     }
@@ -244,6 +482,43 @@ __task_complete(
             }
         }
     }
+
+    // the task may now be reclaimed by the thread executing its domain
+    if (task->domain)
+        __task_domain_completed(task->domain, task);
+
+    // TODO: instead, can we have a counter per thread, to reduce the number of
+    // updates on the 'parent' counter ?
+    // the task must not be accessed past that point
+    parent->cc.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ *  Complete the task. A moldable task that got split completes with the last
+ *  of its parts: dependencies were only set on the original task, so its
+ *  successors, and any task later depending on it, wait for all the parts
+ */
+static inline void
+__task_complete(
+    runtime_t * runtime,
+    task_t * task
+) {
+    if (task->flags & TASK_FLAG_MOLDABLE)
+    {
+        task_t * origin = TASK_MOL_INFO(task)->origin;
+
+        // a part has no successors, it completes right away
+        if (origin)
+        {
+            __task_do_complete(runtime, task);
+            task = origin;
+        }
+
+        if (TASK_MOL_INFO(task)->parts.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return ;
+    }
+
+    __task_do_complete(runtime, task);
 }
 
 /* decrease detachable ref counter by 1, and complete the task if it reached 0 */
@@ -296,6 +571,10 @@ task_execute(runtime_t * runtime, device_t * device, task_t * task)
     thread_t * thread = thread_t::get_tls();
     assert(thread);
 
+    // reduces accumulate into private copies - a requeued task keeps its own
+    if ((task->flags & TASK_FLAG_DEPENDENT) && task->state.value != TASK_STATE_EXECUTING)
+        __task_reductions_bind(task);
+
     task->state.value = TASK_STATE_EXECUTING;
     LOGGER_DEBUG_TASK_STATE(task);
 
@@ -430,6 +709,21 @@ runtime_t::task_dup(
 
     // TODO: probably not C++ standard, but should work ?
     memcpy(dup, task, task_size + args_size);
+    dup->gc_next = NULL;
+
+    // the duplicate is a part of the original task, that now completes once that part did
+    task_t * origin = mol->origin ? mol->origin : (task_t *) task;
+    TASK_MOL_INFO(origin)->parts.fetch_add(1, std::memory_order_relaxed);
+    TASK_MOL_INFO(dup)->origin = origin;
+
+    // the copied accesses have no successors: dependencies were only set on
+    // the original task, whose successors wait for all of its parts
+    if (dup->flags & TASK_FLAG_DEPENDENT)
+    {
+        access_t * accesses = TASK_ACCESSES(dup);
+        for (task_access_counter_t i = 0 ; i < TASK_DEP_INFO(dup)->ac ; ++i)
+            new (&accesses[i].successors) std::vector<access_t *>();
+    }
 
     # if XKRT_SUPPORT_DEBUG
     snprintf(dup->label, sizeof(dup->label), "%s-dup", task->label);
@@ -442,6 +736,47 @@ runtime_t::task_dup(
 // TASK SUBMISSION //
 /////////////////////
 
+/* return a thread of the host team running on the NUMA node holding the data
+ * of the first access of the task, or NULL if there is none */
+static inline thread_t *
+submit_task_host_numa_thread(
+    runtime_t * runtime,
+    thread_t * tls,
+    task_t * task
+) {
+    if (!(task->flags & TASK_FLAG_DEPENDENT) || TASK_DEP_INFO(task)->ac == 0)
+        return NULL;
+
+    // host threads are spread over the NUMA nodes, see `drivers_init`
+    team_t * team = runtime->device_get(HOST_DEVICE_GLOBAL_ID)->team;
+    const int nplaces = team->desc.binding.nplaces;
+    if (nplaces <= 1)
+        return NULL;
+
+    const access_t * access = TASK_ACCESSES(task) + 0;
+    if (access->mode & ACCESS_MODE_V)
+        return NULL;
+
+    const int node = runtime->memory_host_numa_node((const void *) access->host_view.begin_addr());
+    if (node < 0 || node >= nplaces)
+        return NULL;
+
+    // the submitting thread is already on that node
+    if (tls->team == team && tls->tid % nplaces == node)
+        return tls;
+
+    // else, find one that is not already working, on that node
+    const int nthreads = team->get_nthreads();
+    thread_t * thread = NULL;
+    for (int tid = node ; tid < nthreads ; tid += nplaces)
+    {
+        thread = team->get_thread(tid);
+        if (thread->sleep.sleeping)
+            break ;
+    }
+    return thread;
+}
+
 static inline void
 submit_task_host(
     runtime_t * runtime,
@@ -450,6 +785,13 @@ submit_task_host(
     thread_t * tls = thread_t::get_tls();
     assert(tls);
 
+    if (runtime->conf.enable_numa_scheduling)
+    {
+        thread_t * thread = submit_task_host_numa_thread(runtime, tls, task);
+        if (thread)
+            return runtime->task_thread_enqueue(thread, task);
+    }
+
     // tls->team == NULL means it come from a user-thread, unknown to kaapi
     // tls->device_global_id != XKRT_DRIVER_TYPE_HOST means it is a kaapi thread, but not a host thread
     if (tls->team == NULL || tls->device_global_id != HOST_DEVICE_GLOBAL_ID)
@@ -496,9 +838,16 @@ submit_task_device(
         }
     }
 
+    // if an owner-computes rules (ocr) parameter is set, and the device was
+    // already elected while prefetching, keep it as accesses may already be
+    // fetched onto it
+    if (dev->ocr_access_index != UNSPECIFIED_TASK_ACCESS && dev->elected_device_id != UNSPECIFIED_DEVICE_GLOBAL_ID)
+    {
+        devices_bitfield = (device_global_id_bitfield_t) (1 << dev->elected_device_id);
+    }
     // if an owner-computes rules (ocr) parameter is set, filter to keep only
     // devices that owns the larger volume of coherent bytes
-    if (dev->ocr_access_index != UNSPECIFIED_TASK_ACCESS)
+    else if (dev->ocr_access_index != UNSPECIFIED_TASK_ACCESS)
     {
         // if an ocr is set, task must be a dependent task (i.e. with some accesses)
         assert(task->flags & TASK_FLAG_DEPENDENT);
@@ -39,6 +39,7 @@
 # include <xkrt/runtime.h>
 # include <xkrt/memory/access/blas/dependency-tree.hpp>
 # include <xkrt/memory/access/blas/memory-tree.hpp>
+# include <xkrt/memory/access/paged/memory-map.hpp>
 # include <xkrt/memory/access/interval/dependency-tree.hpp>
 # include <xkrt/memory/access/handle/dependency-map.hpp>
 
@@ -75,65 +76,84 @@ task_get_memory_controller(
         {
             // TODO: blas memory coherency tree of ;d SIZE_MAX
             assert(access->host_view.ld == SIZE_MAX);
-            if (dom->mccs.interval == NULL)
+            SPINLOCK_LOCK(dom->mccs.lock);
             {
-                mcc = new BLASMemoryTree(
-                    runtime,
-                    SIZE_MAX,
-                    1,
-                    runtime->conf.merge_transfers
-                );
-                dom->mccs.interval = mcc;
-
-                # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
-                /* insert regions that represents registered memory segment, to
-                 * enforce the split in multiple copies */
-                if (runtime->conf.protect_registered_memory_overflow)
-                    for (const auto & [ptr, size] : runtime->registered_memory)
-                        ((BLASMemoryTree *) mcc)->registered(ptr, size);
-                # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
-
-                LOGGER_DEBUG("Created new `ACCESS_TYPE_SEGMENT` memory coherency controller");
+                if (dom->mccs.interval == NULL && runtime->conf.segment_coherency == XKRT_SEGMENT_COHERENCY_PAGED)
+                {
+                    mcc = new PagedMemoryMap(runtime, runtime->conf.segment_page_size);
+                    dom->mccs.interval = mcc;
+
+                    LOGGER_DEBUG("Created new paged `ACCESS_TYPE_SEGMENT` memory coherency controller with pages of %zu bytes",
+                            runtime->conf.segment_page_size);
+                }
+                else if (dom->mccs.interval == NULL)
+                {
+                    mcc = new BLASMemoryTree(
+                        runtime,
+                        SIZE_MAX,
+                        1,
+                        runtime->conf.merge_transfers
+                    );
+                    dom->mccs.interval = mcc;
+
+                    # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
+                    /* insert regions that represents registered memory segment, to
+                     * enforce the split in multiple copies */
+                    if (runtime->conf.protect_registered_memory_overflow)
+                        runtime->registered_memory.foreach([mcc] (const RegisteredSegments::segment_t & segment) {
+                            ((BLASMemoryTree *) mcc)->registered(segment.a, segment.b - segment.a);
+                        });
+                    # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
+
+                    LOGGER_DEBUG("Created new `ACCESS_TYPE_SEGMENT` memory coherency controller");
+                }
+                else
+                    mcc = dom->mccs.interval;
             }
-            else
-                mcc = dom->mccs.interval;
+            SPINLOCK_UNLOCK(dom->mccs.lock);
 
             break ;
         }
 
         case (ACCESS_TYPE_BLAS_MATRIX):
         {
-            // TODO : have this list dynamically switch to a hashmap ift here
-            // is too many differnet matrices LD
+            /* trees are in byte space: a single tree is shared between all
+             * accesses of same ld * sizeof(type), whatever their type */
+            const size_t ld_bytes = access->host_view.ld * access->host_view.sizeof_type;
 
-            /* find previous mcc for that ld */
-            for (MemoryCoherencyController * mcc : dom->mccs.blas)
+            SPINLOCK_LOCK(dom->mccs.lock);
             {
-                BLASMemoryTree * memtree = (BLASMemoryTree *) mcc;
-                if (memtree->ld == access->host_view.ld &&
-                        memtree->sizeof_type == access->host_view.sizeof_type)
-                    return mcc;
+                /* find previous mcc for that ld */
+                auto it = dom->mccs.blas.find(ld_bytes);
+                if (it != dom->mccs.blas.end())
+                {
+                    mcc = it->second;
+                }
+                /* else insert a new one */
+                else
+                {
+                    mcc = new BLASMemoryTree(
+                        runtime,
+                        ld_bytes,
+                        1,
+                        runtime->conf.merge_transfers
+                    );
+                    dom->mccs.blas[ld_bytes] = mcc;
+
+                    # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
+                    /* insert regions that represents registered memory segment, to
+                     * enforce the split in multiple copies */
+                    if (runtime->conf.protect_registered_memory_overflow)
+                        runtime->registered_memory.foreach([mcc] (const RegisteredSegments::segment_t & segment) {
+                            ((BLASMemoryTree *) mcc)->registered(segment.a, segment.b - segment.a);
+                        });
+                    # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
+
+                    LOGGER_DEBUG("Created a new memory tree with (ld (bytes), merge) = (%lu, %s)",
+                            ld_bytes, runtime->conf.merge_transfers ? "true" : "false");
+                }
             }
-
-            /* else insert a new one */
-            mcc = new BLASMemoryTree(
-                runtime,
-                access->host_view.ld,
-                access->host_view.sizeof_type,
-                runtime->conf.merge_transfers
-            );
-            dom->mccs.blas.push_back((MemoryCoherencyController *) mcc);
-
-            # if XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION
-            /* insert regions that represents registered memory segment, to
-             * enforce the split in multiple copies */
-            if (runtime->conf.protect_registered_memory_overflow)
-                for (const auto & [ptr, size] : runtime->registered_memory)
-                    ((BLASMemoryTree *) mcc)->registered(ptr, size);
-            # endif /* XKRT_MEMORY_REGISTER_OVERFLOW_PROTECTION */
-
-            LOGGER_DEBUG("Created a new memory tree with (ld, sizeof(type), merge) = (%lu, %lu, %s)",
-                    access->host_view.ld, access->host_view.sizeof_type, runtime->conf.merge_transfers ? "true" : "false");
+            SPINLOCK_UNLOCK(dom->mccs.lock);
 
             break ;
         }
@@ -162,17 +182,17 @@ task_get_dependency_domain_blas_matrix(
     task_dom_info_t * dom = TASK_DOM_INFO(task);
     assert(dom);
 
-    /* find previous deptree for that ld */
-    for (DependencyDomain * domain : dom->deps.blas)
-    {
-        BLASDependencyTree * deptree = (BLASDependencyTree *) domain;
-        if (deptree->ld == ld && deptree->sizeof_type == sizeof_type)
-            return deptree;
-    }
+    /* find previous deptree for that ld - rects are in byte space, so
+     * accesses of different types but same ld * sizeof(type) are ordered
+     * within the same tree */
+    const size_t ld_bytes = ld * sizeof_type;
+    auto it = dom->deps.blas.find(ld_bytes);
+    if (it != dom->deps.blas.end())
+        return it->second;
 
     /* if none, create a new one */
-    BLASDependencyTree * deptree = new BLASDependencyTree(ld, sizeof_type);
-    dom->deps.blas.push_back(deptree);
+    BLASDependencyTree * deptree = new BLASDependencyTree(ld_bytes, 1);
+    dom->deps.blas[ld_bytes] = deptree;
 
     /* push each uncompleted tasks from the interval dependency tree,
      * so dependencies between previously spawned interval accesses and
@@ -200,6 +220,17 @@ task_get_dependency_domain_blas_matrix(
     return deptree;
 }
 
+/* segment accesses are widened to that many bytes when resolving
+ * dependencies - set by the runtime, see 'task_dependency_granularity' */
+static uintptr_t segment_granularity = 1;
+
+void
+task_dependency_granularity(const size_t granularity)
+{
+    assert(granularity && (granularity & (granularity - 1)) == 0);
+    segment_granularity = (uintptr_t) granularity;
+}
+
 typedef enum    task_dependency_action_t
 {
     LINK,
@@ -240,14 +271,14 @@ task_dependency_resolve_do(
             case (ACCESS_TYPE_SEGMENT):
             {
                 if (dom->deps.interval == NULL)
-                    dom->deps.interval = new IntervalDependencyTree();
+                    dom->deps.interval = new IntervalDependencyTree(segment_granularity);
 
                 if constexpr (action == LINK)
                     dom->deps.interval->link(access);
                 else if constexpr(action == PUT)
                     dom->deps.interval->put(access);
 
-                for (DependencyDomain * domain : dom->deps.blas)
+                for (auto & [ld_bytes, domain] : dom->deps.blas)
                 {
                     BLASDependencyTree * deptree = (BLASDependencyTree *) domain;
                     if constexpr (action == LINK)
@@ -278,6 +309,173 @@ task_dependency_resolve_do(
     }
 }
 
+access_t *
+task_reclaimed_access(void)
+{
+    static struct reclaimed_t {
+        task_t task;
+        access_t access;
+        reclaimed_t() :
+            task(XKRT_TASK_FORMAT_NULL, TASK_FLAG_DEPENDENT),
+            access(&task, (const void *) NULL, ACCESS_MODE_W)
+        {
+            task.state.value = TASK_STATE_COMPLETED;
+            # if XKRT_SUPPORT_DEBUG
+            snprintf(task.label, sizeof(task.label), "reclaimed");
+            # endif
+        }
+    } reclaimed;
+    return &reclaimed.access;
+}
+
+/**
+ *  Release the domain of a completed task whose children all completed:
+ *  reclaim them, and delete its dependency domains and memory controllers.
+ *  Returns false if some descendants are still completing.
+ */
+static bool
+task_domain_release(task_t * task)
+{
+    assert(task->flags & TASK_FLAG_DOMAIN);
+    assert(task->state.value == TASK_STATE_COMPLETED);
+    assert(task->cc.load(std::memory_order_relaxed) == 0);
+
+    task_domain_gc(task);
+
+    task_dom_info_t * dom = TASK_DOM_INFO(task);
+    if (dom->gc.completed.load(std::memory_order_acquire))
+        return false;
+
+    if (dom->mccs.interval)
+        dom->mccs.interval->unref();
+    for (auto & [ld_bytes, mcc] : dom->mccs.blas)
+        mcc->unref();
+
+    if (dom->deps.handle)
+        delete dom->deps.handle;
+    if (dom->deps.interval)
+        delete dom->deps.interval;
+    for (auto & [ld_bytes, dep] : dom->deps.blas)
+        delete dep;
+    for (access_reduction_t * reduction : dom->deps.reductions)
+        delete reduction;
+
+    dom->~task_dom_info_t();
+
+    return true;
+}
+
+/**
+ *  Reclaim completed children of the passed domain task, and completed tasks
+ *  it is the closest domain of.
+ *  Must be called by the thread executing that task, or once it completed:
+ *  dependency domains are swept first, so no references to the reclaimed
+ *  tasks remain.
+ */
+void
+task_domain_gc(task_t * task)
+{
+    assert(task);
+    assert(task->flags & TASK_FLAG_DOMAIN);
+
+    task_dom_info_t * dom = TASK_DOM_INFO(task);
+    assert(dom);
+
+    task_t * completed = dom->gc.completed.exchange(NULL, std::memory_order_acquire);
+    if (completed == NULL)
+        return ;
+
+    // forget accesses of completed tasks
+    if (dom->deps.handle)
+        dom->deps.handle->gc();
+    if (dom->deps.interval)
+        dom->deps.interval->gc();
+    for (auto & [ld_bytes, domain] : dom->deps.blas)
+        domain->gc();
+    std::erase_if(dom->deps.reductions, [] (access_reduction_t * reduction) {
+        if (reduction->pending.load(std::memory_order_acquire))
+            return false;
+        delete reduction;
+        return true;
+    });
+
+    // reclaim tasks
+    uint32_t n = 0;
+    while (completed)
+    {
+        task_t * t = completed;
+        completed = t->gc_next;
+        ++n;
+
+        // children of that task may still be completing, retry later
+        if (t->cc.load(std::memory_order_acquire))
+        {
+            __task_domain_completed(task, t);
+            continue ;
+        }
+
+        // a domain task first reclaims its own completed tasks
+        if ((t->flags & TASK_FLAG_DOMAIN) && !task_domain_release(t))
+        {
+            __task_domain_completed(task, t);
+            continue ;
+        }
+
+        if (t->flags & TASK_FLAG_DEPENDENT)
+        {
+            access_t * accesses = TASK_ACCESSES(t);
+            for (task_access_counter_t i = 0 ; i < TASK_DEP_INFO(t)->ac ; ++i)
+                accesses[i].~access_t();
+        }
+        t->state.value = TASK_STATE_DEALLOCATED;
+        thread_t::deallocate_task(t);
+    }
+    dom->gc.ncompleted.fetch_sub(n, std::memory_order_relaxed);
+}
+
+/**
+ *  Set the reduction of a reduce access: reduces of the same data with the
+ *  same operator share it, so they do not depend on each others
+ */
+static inline void
+task_reduction_resolve(
+    task_dom_info_t * dom,
+    access_t * access
+) {
+    assert(access->mode & ACCESS_MODE_P);
+
+    // accesses split from a reduce already contribute to its reduction
+    if (access->reduction)
+        return ;
+
+    if (access->type != ACCESS_TYPE_SEGMENT && access->type != ACCESS_TYPE_BLAS_MATRIX)
+        LOGGER_FATAL("Reductions are only supported on segments and matrices");
+    if (access->task->flags & TASK_FLAG_DEVICE)
+        LOGGER_FATAL("Reductions are only supported by host tasks");
+    if (access->reduce_op == NULL)
+        LOGGER_FATAL("Reduce access with no combine operator");
+
+    access_reduction_t * reduction = NULL;
+    for (access_reduction_t * r : dom->deps.reductions)
+    {
+        if (r->op == access->reduce_op && r->view.equals(access->host_view) &&
+                r->pending.load(std::memory_order_acquire) > 0)
+        {
+            reduction = r;
+            break ;
+        }
+    }
+
+    if (reduction == NULL)
+    {
+        reduction = new access_reduction_t(access->host_view, access->reduce_op);
+        dom->deps.reductions.push_back(reduction);
+    }
+
+    reduction->pending.fetch_add(1, std::memory_order_relaxed);
+    access->reduction = reduction;
+}
+
 /**
  * Retrieve or (insert and return) the dependency domain of the passed task for
  * the given access
@@ -291,6 +489,12 @@ task_dependency_resolve(
     assert(task);
     assert(task->flags & TASK_FLAG_DOMAIN);
 
+    // reduces must know their reduction to link
+    task_dom_info_t * dom = TASK_DOM_INFO(task);
+    for (task_access_counter_t i = 0 ; i < AC ; ++i)
+        if (accesses[i].mode & ACCESS_MODE_P)
+            task_reduction_resolve(dom, accesses + i);
+
     // two passes
     //  - first one link with previously inserted accesses
     //  - second one insert accesses to link with future accesses
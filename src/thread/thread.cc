@@ -107,10 +107,16 @@ thread_t::allocate_task(const size_t size)
     assert(thread_t::get_tls() == this);
 
     # if 1
-    if (this->memory_stack_ptr >= this->memory_stack_bottom + THREAD_MAX_MEMORY)
-        LOGGER_FATAL("Stack overflow ! Increase `THREAD_MAX_MEMORY` and recompile");
+    if (size > THREAD_TASKS_SEGMENT_SIZE - sizeof(task_segment_t))
+        LOGGER_FATAL("Task of %zu bytes is too big ! Increase `THREAD_TASKS_SEGMENT_SIZE` and recompile", size);
+
+    // if the task does not fit in the current segment, move to another one
+    if (this->memory_stack_ptr + size > (uint8_t *) this->memory_segment + THREAD_TASKS_SEGMENT_SIZE)
+        this->memory_segment_next();
+
     task_t * task = (task_t *) this->memory_stack_ptr;
     this->memory_stack_ptr += size;
+    this->memory_segment->live.fetch_add(1, std::memory_order_relaxed);
 
     # if XKRT_SUPPORT_DEBUG
     this->tasks.push_back(task);
@@ -122,10 +128,57 @@ thread_t::allocate_task(const size_t size)
     # endif
 }
 
+void
+thread_t::memory_segment_next(void)
+{
+    // the current segment may be reused once all its tasks are reclaimed
+    this->memory_segment->live.fetch_sub(1, std::memory_order_release);
+
+    // find a segment whose tasks were all reclaimed - in debug mode, segments
+    // are never reused so 'dump_tasks' never reads recycled memory
+    task_segment_t * segment = NULL;
+    # if !XKRT_SUPPORT_DEBUG
+    for (size_t i = 0 ; i < this->memory_segments_used ; ++i)
+    {
+        task_segment_t * s = (task_segment_t *) (this->memory_stack_bottom + i * THREAD_TASKS_SEGMENT_SIZE);
+        if (s->live.load(std::memory_order_acquire) == 0)
+        {
+            s->live.store(1, std::memory_order_relaxed);
+            segment = s;
+            break ;
+        }
+    }
+    # endif /* XKRT_SUPPORT_DEBUG */
+
+    // else, use a new segment
+    if (segment == NULL)
+    {
+        if ((this->memory_segments_used + 1) * THREAD_TASKS_SEGMENT_SIZE > this->memory_stack_capacity)
+            LOGGER_FATAL("Stack overflow ! Increase `THREAD_MAX_MEMORY` and recompile");
+        uint8_t * ptr = this->memory_stack_bottom + this->memory_segments_used * THREAD_TASKS_SEGMENT_SIZE;
+        segment = new (ptr) task_segment_t();
+        ++this->memory_segments_used;
+    }
+
+    this->memory_segment = segment;
+    this->memory_stack_ptr = (uint8_t *) (segment + 1);
+}
+
+void
+thread_t::deallocate_task(task_t * task)
+{
+    // the stack is aligned on the segment size
+    task_segment_t * segment = (task_segment_t *) (((uintptr_t) task) & ~((uintptr_t) THREAD_TASKS_SEGMENT_SIZE - 1));
+    assert(segment->live.load() > 0);
+    segment->live.fetch_sub(1, std::memory_order_release);
+}
+
 void
 thread_t::deallocate_all_tasks(void)
 {
-    this->memory_stack_ptr = this->memory_stack_bottom;
+    this->memory_segment = new (this->memory_stack_bottom) task_segment_t();
+    this->memory_segments_used = 1;
+    this->memory_stack_ptr = (uint8_t *) (this->memory_segment + 1);
 }
 
 /* get a thread */
@@ -225,8 +278,12 @@ team_create_get_place(
                     const device_t * device = runtime->device_get(*device_global_id);
                     assert(device);
 
-                    assert(device->team->desc.binding.nplaces == 1);
+                    // the device place is the union of its threads places
+                    // (several if host threads are spread over NUMA nodes)
+                    assert(device->team->desc.binding.nplaces >= 1);
                     *place = device->team->desc.binding.places_list[0];
+                    for (int i = 1 ; i < device->team->desc.binding.nplaces ; ++i)
+                        CPU_OR(place, place, device->team->desc.binding.places_list + i);
 
                     return ;
                 }
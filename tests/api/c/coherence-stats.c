@@ -0,0 +1,142 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <assert.h>
+# include <stdio.h>
+# include <stdlib.h>
+# include <xkrt/xkrt.h>
+
+/* segments of S bytes */
+# define S (1024 * 1024)
+static char A[S], B[S], C[S], D[S];
+
+/* spawn a task accessing the segment on the device, with no body */
+static void
+spawn(xkrt_runtime_t * runtime, xkrt_device_global_id_t device, char * x, xkrt_access_mode_t mode)
+{
+    const xkrt_access_t accesses[] = {
+        {
+            .concurrency    = ACCESS_CONCURRENCY_SEQUENTIAL,
+            .mode           = mode,
+            .scope          = ACCESS_SCOPE_NONUNIFIED,
+            .type           = ACCESS_TYPE_SEGMENT,
+            .region         = {
+                .segment = {
+                    .a = (void *) x,
+                    .b = (void *) (x + S)
+                }
+            }
+        }
+    };
+    xkrt_task_spawn_generic(runtime, device, TASK_FLAG_DEPENDENT | TASK_FLAG_DEVICE, XKRT_TASK_FORMAT_NULL,
+            NULL, 0, accesses, 1, UNSPECIFIED_TASK_ACCESS, 0);
+}
+
+int
+main(void)
+{
+    /* the device pool is a single segment, to control its free memory */
+    setenv("XKRT_GPU_MEM_GROW", "0", 1);
+
+    xkrt_runtime_t * runtime;
+    assert(xkrt_init(&runtime) == 0);
+
+    xkrt_device_coherence_stats_t stats;
+    if (xkrt_get_ndevices(runtime) < 2 || xkrt_device_coherence_stats_get(runtime, 1, &stats))
+    {
+        puts("No device, or no stats support, skipping");
+        assert(xkrt_deinit(runtime) == 0);
+        return 0;
+    }
+    const xkrt_device_global_id_t device = 1;
+    assert(stats.hits == 0 && stats.misses == 0 && stats.joined == 0 && stats.overwrites == 0);
+
+    /* reading A transfers it once: concurrent readers join the transfer, or hit */
+    spawn(runtime, device, A, ACCESS_MODE_R);
+    spawn(runtime, device, A, ACCESS_MODE_R);
+    xkrt_task_wait(runtime);
+    assert(xkrt_device_coherence_stats_get(runtime, device, &stats) == 0);
+    assert(stats.misses == 1);
+    assert(stats.hits + stats.joined == 1);
+
+    /* reading it again hits */
+    const unsigned long hits = stats.hits;
+    spawn(runtime, device, A, ACCESS_MODE_R);
+    xkrt_task_wait(runtime);
+    assert(xkrt_device_coherence_stats_get(runtime, device, &stats) == 0);
+    assert(stats.hits == hits + 1);
+
+    /* writing B allocates it but transfers nothing, then it is valid there */
+    spawn(runtime, device, B, ACCESS_MODE_W);
+    xkrt_task_wait(runtime);
+    assert(xkrt_device_coherence_stats_get(runtime, device, &stats) == 0);
+    assert(stats.overwrites == 1);
+    assert(stats.misses == 1);
+    spawn(runtime, device, B, ACCESS_MODE_W);
+    xkrt_task_wait(runtime);
+    assert(xkrt_device_coherence_stats_get(runtime, device, &stats) == 0);
+    assert(stats.overwrites == 1);
+    assert(stats.hits == hits + 2);
+
+    /* fill the device memory, but for a hole of S bytes */
+    enum { NCHUNKS_MAX = 1 << 16 };
+    static void * chunks[NCHUNKS_MAX];
+    int nchunks = 0;
+    while (nchunks < NCHUNKS_MAX && (chunks[nchunks] = xkrt_memory_device_allocate(runtime, device, S)) != NULL)
+        ++nchunks;
+    assert(nchunks > 0 && nchunks < NCHUNKS_MAX);
+    xkrt_memory_device_deallocate(runtime, device, chunks[--nchunks]);
+
+    /* C fills the hole, so D evicts the least recently used replicas */
+    assert(stats.evictions == 0);
+    spawn(runtime, device, C, ACCESS_MODE_W);
+    xkrt_task_wait(runtime);
+    spawn(runtime, device, D, ACCESS_MODE_W);
+    xkrt_task_wait(runtime);
+    assert(xkrt_device_coherence_stats_get(runtime, device, &stats) == 0);
+    assert(stats.overwrites == 3);
+    assert(stats.evictions >= 1);
+    assert(stats.evicted >= S);
+
+    while (nchunks)
+        xkrt_memory_device_deallocate(runtime, device, chunks[--nchunks]);
+
+    assert(xkrt_deinit(runtime) == 0);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+# include <xkrt/runtime.h>
+# include <xkrt/driver/device.hpp>
+# include <xkrt/memory/access/blas/memory-tree.hpp>
+
+# include <assert.h>
+# include <stdlib.h>
+
+# include <atomic>
+
+XKRT_NAMESPACE_USE;
+
+/* a matrix of NT column tiles, each of size (M x NB) */
+# define M  32
+# define NB 8
+# define NT 32
+# define T  (M * NB * sizeof(double))
+
+/* max number of threads */
+# define NTHREADS 64
+
+static double A[M * NB * NT];
+
+/* device address of each tile, seen by each thread */
+static uintptr_t addr[NTHREADS][NT];
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    team_t team;
+    team.desc.routine = XKRT_TEAM_ROUTINE_PARALLEL_FOR;
+    runtime.team_create(&team);
+    const int nthreads = team.priv.nthreads < NTHREADS ? team.priv.nthreads : NTHREADS;
+
+    /* enough device memory for every tile, and one concurrent allocation
+     * per thread that loses against another */
+    const size_t size = (NT + nthreads) * T;
+    device_global_id_t device_global_id = HOST_DEVICE_GLOBAL_ID;
+    device_t * device = runtime.device_get(device_global_id);
+    assert(device);
+    void * memory = malloc(size);
+    assert(memory);
+    device->memory_set_chunk0((uintptr_t) memory, size, 0);
+    device->memories[0].allocated = 1;
+
+    {
+        BLASMemoryTree tree(&runtime, M * sizeof(double), 1, false);
+        std::atomic<int> ready(0);
+
+        /* every thread allocates every tile, starting from a different one,
+         * so allocations of the same blocks race outside the tree lock */
+        runtime.team_parallel_for(&team, [&tree, &ready, nthreads, device_global_id] (thread_t * thread) {
+                const int tid = thread->tid;
+                if (tid >= nthreads)
+                    return ;
+
+                ++ready;
+                while (ready.load() < nthreads)
+                    ;
+
+                for (int k = 0 ; k < NT ; ++k)
+                {
+                    const int i = (tid + k) % NT;
+                    access_t access(NULL, MATRIX_COLMAJOR, A + i * M * NB, M, M, NB, sizeof(double), ACCESS_MODE_R);
+                    tree.fetch_list_to_device<true>(&access, device_global_id);
+                    addr[tid][i] = access.device_view.addr;
+                }
+            }
+        );
+
+        /* all threads agreed on a single replica per tile */
+        for (int i = 0 ; i < NT ; ++i)
+        {
+            assert(addr[0][i] >= (uintptr_t) memory);
+            assert(addr[0][i] + T <= (uintptr_t) memory + size);
+            for (int tid = 1 ; tid < nthreads ; ++tid)
+                assert(addr[tid][i] == addr[0][i]);
+            for (int j = 0 ; j < i ; ++j)
+                assert(addr[0][i] != addr[0][j]);
+        }
+
+        /* the allocations that lost were released: the remaining memory is free */
+        area_chunk_t * chunks[NTHREADS];
+        for (int tid = 0 ; tid < nthreads ; ++tid)
+        {
+            chunks[tid] = runtime.memory_device_allocate(device_global_id, T);
+            assert(chunks[tid]);
+        }
+        for (int tid = 0 ; tid < nthreads ; ++tid)
+            runtime.memory_device_deallocate(device_global_id, chunks[tid]);
+    }
+
+    runtime.team_join(&team);
+
+    device->memory_set_chunk0((uintptr_t) NULL, 0, 0);
+    device->memories[0].allocated = 0;
+    free(memory);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
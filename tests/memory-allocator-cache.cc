@@ -0,0 +1,103 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/driver/device.hpp>
+
+# include <assert.h>
+# include <stdlib.h>
+
+XKRT_NAMESPACE_USE;
+
+/* size of the pool */
+# define POOL   ((size_t) 64 * 1024 * 1024)
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    /* use a pool of the host device */
+    device_t * device = runtime.device_get(HOST_DEVICE_GLOBAL_ID);
+    assert(device);
+    void * memory = malloc(POOL);
+    assert(memory);
+    device->memory_set_chunk0((uintptr_t) memory, POOL, 0);
+    device->memories[0].allocated = 1;
+
+    /* a thread of the device team frees chunks, that remain in its cache */
+    runtime.task_spawn(
+        [device] (runtime_t * runtime, device_t * unused, task_t * task) {
+            (void) runtime;
+            (void) unused;
+            (void) task;
+
+            area_chunk_t * a = device->memory_allocate_on(POOL / 4, 0);
+            area_chunk_t * b = device->memory_allocate_on(POOL / 4, 0);
+            assert(a && b);
+            device->memory_deallocate(a);
+            device->memory_deallocate(b);
+        }
+    );
+    runtime.task_wait();
+
+    /* the cached chunks are still allocated in the area */
+    area_stats_t stats;
+    device->memory_stats_on(0, &stats);
+    assert(stats.used >= POOL / 2);
+
+    /* another thread, with no cache, allocating the whole pool flushes the
+     * caches of the device threads to coalesce their chunks */
+    area_chunk_t * chunk = device->memory_allocate_on(POOL, 0);
+    assert(chunk);
+    assert(chunk->ptr == (uintptr_t) memory);
+    assert(chunk->prev == NULL && chunk->next == NULL);
+    device->memory_deallocate(chunk);
+
+    device->memory_stats_on(0, &stats);
+    assert(stats.used == 0);
+
+    device->memory_set_chunk0((uintptr_t) NULL, 0, 0);
+    device->memories[0].allocated = 0;
+    free(memory);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
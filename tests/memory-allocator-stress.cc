@@ -0,0 +1,152 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/driver/device.hpp>
+# include <xkrt/logger/logger.h>
+# include <xkrt/logger/metric.h>
+
+# include <assert.h>
+# include <stdlib.h>
+
+# include <random>
+
+XKRT_NAMESPACE_USE;
+
+/* size of the pool */
+# define POOL   ((size_t) 128 * 1024 * 1024)
+
+/* number of allocations alive at most */
+# define NLIVE  (2048)
+
+/* number of allocations/deallocations */
+# define NOPS   (1000000)
+
+/* randomly allocate and free chunks of mixed sizes */
+static void
+stress(device_t * device, void * memory, const char * label)
+{
+    area_chunk_t * live[NLIVE] = {};
+    std::minstd_rand rng(42);
+    int nfailed = 0;
+
+    uint64_t t0 = get_nanotime();
+    for (int op = 0 ; op < NOPS ; ++op)
+    {
+        const int i = (int) (rng() % NLIVE);
+        if (live[i])
+        {
+            device->memory_deallocate(live[i]);
+            live[i] = NULL;
+        }
+        else
+        {
+            /* mixed sizes of square tiles of doubles, and of odd sizes */
+            const size_t nb   = (size_t) 8 << (rng() % 6);
+            const size_t size = (rng() % 4) ? nb * nb * sizeof(double) : 1 + rng() % (64 * 1024);
+
+            area_chunk_t * chunk = device->memory_allocate_on(size, 0);
+            if (chunk == NULL)
+            {
+                ++nfailed;
+                continue ;
+            }
+            assert(chunk->size >= size);
+            assert(chunk->ptr % AREA_ALIGN == 0);
+            assert(chunk->ptr >= (uintptr_t) memory);
+            assert(chunk->ptr + chunk->size <= (uintptr_t) memory + POOL);
+            assert(chunk->prev == NULL || chunk->prev->ptr + chunk->prev->size == chunk->ptr);
+            assert(chunk->next == NULL || chunk->ptr + chunk->size == chunk->next->ptr);
+            live[i] = chunk;
+        }
+    }
+    uint64_t tf = get_nanotime();
+    LOGGER_INFO("(%s) %d allocations/deallocations in %.2lf ms (%.1lf ns per operation, %d failed)",
+            label, NOPS, (tf - t0) / 1e6, (double) (tf - t0) / NOPS, nfailed);
+
+    /* freeing everything coalesces the pool back into a single chunk */
+    for (int i = 0 ; i < NLIVE ; ++i)
+        if (live[i])
+            device->memory_deallocate(live[i]);
+    device->memory_cache_flush();
+
+    area_chunk_t * chunk = device->memory_allocate_on(POOL, 0);
+    assert(chunk);
+    assert(chunk->ptr == (uintptr_t) memory);
+    assert(chunk->prev == NULL && chunk->next == NULL);
+    device->memory_deallocate(chunk);
+    device->memory_cache_flush();
+}
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    /* use a pool of the host device */
+    device_global_id_t device_global_id = HOST_DEVICE_GLOBAL_ID;
+    device_t * device = runtime.device_get(device_global_id);
+    assert(device);
+    void * memory = malloc(POOL);
+    assert(memory);
+    device->memory_set_chunk0((uintptr_t) memory, POOL, 0);
+    device->memories[0].allocated = 1;
+
+    /* from a thread out of the device team, always locking the area */
+    stress(device, memory, "shared");
+
+    /* from a thread of the device team, going through its cache */
+    runtime.task_spawn(
+        [device, memory] (runtime_t * runtime, device_t * unused, task_t * task) {
+            (void) runtime;
+            (void) unused;
+            (void) task;
+            stress(device, memory, "cached");
+        }
+    );
+    runtime.task_wait();
+
+    device->memory_set_chunk0((uintptr_t) NULL, 0, 0);
+    device->memories[0].allocated = 0;
+    free(memory);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
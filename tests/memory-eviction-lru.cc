@@ -0,0 +1,110 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/driver/device.hpp>
+# include <xkrt/memory/access/blas/memory-tree.hpp>
+
+# include <assert.h>
+# include <stdlib.h>
+
+XKRT_NAMESPACE_USE;
+
+/* a matrix of NT column tiles, each of size (M x NB) */
+# define M  32
+# define NB 8
+# define NT 6
+# define T  (M * NB * sizeof(double))
+
+static double A[M * NB * NT];
+
+/* allocate the i-th tile on the device, and return its device address */
+static uintptr_t
+allocate(BLASMemoryTree & tree, device_global_id_t device_global_id, int i)
+{
+    access_t access(NULL, MATRIX_COLMAJOR, A + i * M * NB, M, M, NB, sizeof(double), ACCESS_MODE_R);
+    tree.fetch_list_to_device<true>(&access, device_global_id);
+    return access.device_view.addr;
+}
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    /* restrict the device memory to 4 tiles */
+    device_global_id_t device_global_id = HOST_DEVICE_GLOBAL_ID;
+    device_t * device = runtime.device_get(device_global_id);
+    assert(device);
+    void * memory = malloc(4 * T);
+    assert(memory);
+    device->memory_set_chunk0((uintptr_t) memory, 4 * T, 0);
+    device->memories[0].allocated = 1;
+
+    {
+        BLASMemoryTree tree(&runtime, M * sizeof(double), 1, false);
+
+        /* fill the device memory */
+        uintptr_t addr[NT];
+        for (int i = 0 ; i < 4 ; ++i)
+            addr[i] = allocate(tree, device_global_id, i);
+
+        /* use tile 0 again, tile 1 is now the least recently used */
+        assert(allocate(tree, device_global_id, 0) == addr[0]);
+
+        /* tile 4 evicts tile 1, then tile 5 evicts tile 2 */
+        addr[4] = allocate(tree, device_global_id, 4);
+        assert(addr[4] == addr[1]);
+
+        addr[5] = allocate(tree, device_global_id, 5);
+        assert(addr[5] == addr[2]);
+
+        /* tiles 0 and 3 were not evicted */
+        assert(allocate(tree, device_global_id, 0) == addr[0]);
+        assert(allocate(tree, device_global_id, 3) == addr[3]);
+    }
+
+    device->memory_set_chunk0((uintptr_t) NULL, 0, 0);
+    device->memories[0].allocated = 0;
+    free(memory);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+# include <xkrt/runtime.h>
+# include <xkrt/logger/logger.h>
+# include <xkrt/memory/access/blas/memory-tree.hpp>
+
+# include <assert.h>
+# include <stdlib.h>
+
+XKRT_NAMESPACE_USE;
+
+/* a matrix of NT column tiles, each of size (M x NB) */
+# define M  256
+# define NB 64
+# define NT 8
+# define T  (M * NB * sizeof(double))
+
+static double A[M * NB * NT];
+
+/* spawn a task writing the i-th tile on the device */
+static void
+write_on_device(runtime_t & runtime, device_global_id_t device_global_id, int i)
+{
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    # define AC 1
+    constexpr task_flag_bitfield_t flags = TASK_FLAG_DEPENDENT | TASK_FLAG_DEVICE;
+    constexpr size_t task_size = task_compute_size(flags, AC);
+
+    task_t * task = thread->allocate_task(task_size);
+    new (task) task_t(XKRT_TASK_FORMAT_NULL, flags);
+
+    task_dep_info_t * dep = TASK_DEP_INFO(task);
+    new (dep) task_dep_info_t(AC);
+
+    task_dev_info_t * dev = TASK_DEV_INFO(task);
+    new (dev) task_dev_info_t(device_global_id, UNSPECIFIED_TASK_ACCESS);
+
+    access_t * accesses = TASK_ACCESSES(task, flags);
+    new (accesses + 0) access_t(task, MATRIX_COLMAJOR, A + i * M * NB, M, M, NB, sizeof(double), ACCESS_MODE_RW);
+    thread->resolve(accesses, AC);
+    # undef AC
+
+    runtime.task_commit(task);
+}
+
+int
+main(void)
+{
+    /* the device pool is a single segment, to control its free memory */
+    setenv("XKRT_GPU_MEM_GROW", "0", 1);
+
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    if (runtime.get_ndevices() < 2)
+    {
+        LOGGER_WARN("No device to evict memory from, skipping");
+        assert(runtime.deinit() == 0);
+        return 0;
+    }
+    const device_global_id_t device_global_id = 1;
+
+    for (int i = 0 ; i < M * NB * NT ; ++i)
+        A[i] = (double) i;
+
+    /* only leave 2 tiles of free device memory, in 2 holes */
+    area_chunk_t * hole = runtime.memory_device_allocate(device_global_id, T);
+    assert(hole);
+    area_stats_t stats;
+    runtime.memory_device_stats(device_global_id, 0, &stats);
+    assert(stats.largest > 2 * T);
+    area_chunk_t * filler = runtime.memory_device_allocate(device_global_id, stats.largest - T);
+    assert(filler);
+    runtime.memory_device_deallocate(device_global_id, hole);
+
+    /* each tile is only valid on the device once written there: allocating
+     * the third one evicts the first one, that must be written back first */
+    for (int i = 0 ; i < NT ; ++i)
+        write_on_device(runtime, device_global_id, i);
+    runtime.task_wait();
+
+    /* evicted tiles are coherent on the host */
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+    access_t access(NULL, MATRIX_COLMAJOR, A, M, M, NB * NT, sizeof(double), ACCESS_MODE_R);
+    BLASMemoryTree * tree = (BLASMemoryTree *) task_get_memory_controller(&runtime, thread->current_task, &access);
+    assert(tree);
+
+    const device_global_id_bitfield_t hostbit = (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID);
+    for (int i = 0 ; i < NT - 2 ; ++i)
+    {
+        access_t tile(NULL, MATRIX_COLMAJOR, A + i * M * NB, M, M, NB, sizeof(double), ACCESS_MODE_R);
+        assert(tree->who_owns(&tile) == hostbit);
+    }
+
+    /* read the data back on the host */
+    runtime.task_spawn<1>(
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, MATRIX_COLMAJOR, A, M, M, NB * NT, sizeof(double), ACCESS_MODE_R);
+        },
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+            for (int i = 0 ; i < M * NB * NT ; ++i)
+                assert(A[i] == (double) i);
+        }
+    );
+    runtime.task_wait();
+
+    runtime.memory_device_deallocate(device_global_id, filler);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+# include <xkrt/runtime.h>
+# include <xkrt/memory/access/blas/memory-tree.hpp>
+
+# include <assert.h>
+
+XKRT_NAMESPACE_USE;
+
+/* a matrix of NT column tiles, each of size (M x NB) */
+# define M  64
+# define NB 16
+# define NT 16
+
+/* number of times each tile is concurrently fetched */
+# define NR 4
+
+static double A[M * NB * NT];
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    /* initialize the matrix in a task, so device fetches depend on it */
+    runtime.task_spawn<1>(
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, MATRIX_COLMAJOR, A, M, M, NB * NT, sizeof(double), ACCESS_MODE_W);
+        },
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+            for (int i = 0 ; i < M * NB * NT ; ++i)
+                A[i] = (double) i;
+        }
+    );
+
+    const device_global_id_t ndevices = (device_global_id_t) runtime.get_ndevices();
+
+    /* fetch overlapping pairs of tiles on every device, several times: reads
+     * do not depend on each others, so fetches of the same blocks complete
+     * concurrently while others await on them or forward them */
+    for (int r = 0 ; r < NR ; ++r)
+        for (device_global_id_t device_global_id = 1 ; device_global_id < ndevices ; ++device_global_id)
+            for (int i = 0 ; i < NT - 1 ; ++i)
+                runtime.memory_coherent_async(device_global_id, MATRIX_COLMAJOR, A + i * M * NB, M, M, 2 * NB, sizeof(double));
+    runtime.task_wait();
+
+    /* every tile is now coherent on every device, and no fetch is pending */
+    access_t access(NULL, MATRIX_COLMAJOR, A, M, M, NB * NT, sizeof(double), ACCESS_MODE_R);
+    BLASMemoryTree * tree = (BLASMemoryTree *) task_get_memory_controller(&runtime, thread->current_task, &access);
+    assert(tree);
+
+    device_global_id_bitfield_t all = 0;
+    for (device_global_id_t device_global_id = 0 ; device_global_id < ndevices ; ++device_global_id)
+        all |= (device_global_id_bitfield_t) (1 << device_global_id);
+
+    for (int i = 0 ; i < NT ; ++i)
+    {
+        access_t tile(NULL, MATRIX_COLMAJOR, A + i * M * NB, M, M, NB, sizeof(double), ACCESS_MODE_R);
+        assert(tree->who_owns(&tile) == all);
+    }
+
+    /* a write on the host invalidates device replicas, that are fetched again */
+    runtime.task_spawn<1>(
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, MATRIX_COLMAJOR, A, M, M, NB * NT, sizeof(double), ACCESS_MODE_RW);
+        },
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+            for (int i = 0 ; i < M * NB * NT ; ++i)
+                A[i] = -A[i];
+        }
+    );
+
+    for (device_global_id_t device_global_id = 1 ; device_global_id < ndevices ; ++device_global_id)
+        for (int i = 0 ; i < NT - 1 ; ++i)
+            runtime.memory_coherent_async(device_global_id, MATRIX_COLMAJOR, A + i * M * NB, M, M, 2 * NB, sizeof(double));
+    runtime.task_wait();
+
+    for (int i = 0 ; i < NT ; ++i)
+    {
+        access_t tile(NULL, MATRIX_COLMAJOR, A + i * M * NB, M, M, NB, sizeof(double), ACCESS_MODE_R);
+        assert(tree->who_owns(&tile) == all);
+    }
+    for (int i = 0 ; i < M * NB * NT ; ++i)
+        assert(A[i] == (double) -i);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/memory/access/blas/memory-tree.hpp>
+
+# include <assert.h>
+
+XKRT_NAMESPACE_USE;
+
+using MemoryForward = KMemoryForward<2>;
+
+/* a tile of 'M' bytes x 'N' columns in a (LD x *) byte matrix */
+# define LD  128
+# define M   64
+# define N   8
+
+static MemoryForward
+forward(access_t * access, area_chunk_t * chunk, uintptr_t base, int i, int j)
+{
+    Interval intervals[2];
+    intervals[ACCESS_BLAS_ROW_DIM] = Interval(i * M, (i + 1) * M);
+    intervals[ACCESS_BLAS_COL_DIM] = Interval(j * N, (j + 1) * N);
+    const Rect rect(intervals);
+
+    memory_replica_view_t view(base + i * M + j * N * LD, LD);
+    return MemoryForward(access, chunk, rect, 1, view);
+}
+
+int
+main(void)
+{
+    static char A[LD * 2 * N];
+    access_t a1(NULL, MATRIX_COLMAJOR, A, LD, 2 * M, 2 * N, 1, ACCESS_MODE_R);
+    access_t a2(NULL, MATRIX_COLMAJOR, A, LD,     M,     N, 1, ACCESS_MODE_R);
+    area_chunk_t chunk;
+    const uintptr_t base = 0x1000;
+
+    std::vector<MemoryForward> forwards;
+
+    // a 2x2 grid of tiles forwarded to the same allocation for the same access
+    forwards.push_back(forward(&a1, &chunk, base, 1, 1));
+    forwards.push_back(forward(&a1, &chunk, base, 0, 0));
+    forwards.push_back(forward(&a1, &chunk, base, 1, 0));
+    forwards.push_back(forward(&a1, &chunk, base, 0, 1));
+
+    // another access, that cannot be merged with the previous ones
+    forwards.push_back(forward(&a2, &chunk, base, 2, 0));
+
+    size_t saved = BLASMemoryTree::forwards_merge(forwards, 1);
+    assert(saved == 3);
+    assert(forwards.size() == 2);
+
+    for (MemoryForward & f : forwards)
+    {
+        if (f.access == &a1)
+        {
+            assert(f.n == 4);
+            assert(f.device_view.addr == base);
+            assert(f.dst_hyperrect[ACCESS_BLAS_ROW_DIM] == Interval(0, 2 * M));
+            assert(f.dst_hyperrect[ACCESS_BLAS_COL_DIM] == Interval(0, 2 * N));
+        }
+        else
+        {
+            assert(f.access == &a2);
+            assert(f.n == 1);
+        }
+    }
+
+    // non-adjacent tiles are not merged
+    forwards.clear();
+    forwards.push_back(forward(&a1, &chunk, base, 0, 0));
+    forwards.push_back(forward(&a1, &chunk, base, 1, 1));
+    saved = BLASMemoryTree::forwards_merge(forwards, 1);
+    assert(saved == 0);
+    assert(forwards.size() == 2);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/driver/device.hpp>
+
+# include <assert.h>
+# include <stdlib.h>
+# include <string.h>
+
+# include <atomic>
+
+XKRT_NAMESPACE_USE;
+
+/* bytes copied between the NUMA nodes */
+# define S ((size_t) 4 * 1024 * 1024)
+
+int
+main(void)
+{
+    /* do not preallocate most of each node memory */
+    setenv("XKRT_GPU_MEM_PERCENT", "1", 1);
+    setenv("XKRT_NUMA_SCHEDULING", "1", 1);
+
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    device_t * device = runtime.device_get(HOST_DEVICE_GLOBAL_ID);
+    assert(device);
+    const int nmemories = device->nmemories;
+    assert(nmemories >= 1);
+    assert(nmemories <= XKRT_DEVICE_MEMORIES_MAX);
+
+    unsigned char * src = (unsigned char *) malloc(S);
+    assert(src);
+    for (size_t i = 0 ; i < S ; ++i)
+        src[i] = (unsigned char) (i % 251);
+
+    /* touched pages are resident on some node */
+    const int src_node = runtime.memory_host_numa_node(src);
+    assert(src_node >= 0 && src_node < nmemories);
+
+    /* the node of a page is cached, subsequent lookups must agree */
+    assert(runtime.memory_host_numa_node(src) == src_node);
+    assert(runtime.memory_host_numa_node(src + 1) == src_node);
+
+    /* allocate a buffer on each node */
+    area_chunk_t * chunks[XKRT_DEVICE_MEMORIES_MAX];
+    for (int i = 0 ; i < nmemories ; ++i)
+    {
+        chunks[i] = runtime.memory_device_allocate_on(HOST_DEVICE_GLOBAL_ID, S, i);
+        assert(chunks[i]);
+        assert(chunks[i]->area_idx == i);
+    }
+
+    /* migrate the data from node to node, through host-to-host copies */
+    uintptr_t from = (uintptr_t) src;
+    for (int i = 0 ; i < nmemories ; ++i)
+    {
+        runtime.memory_copy_async(HOST_DEVICE_GLOBAL_ID, S, HOST_DEVICE_GLOBAL_ID, chunks[i]->ptr, HOST_DEVICE_GLOBAL_ID, from, 4);
+        runtime.task_wait();
+        assert(memcmp((void *) chunks[i]->ptr, src, S) == 0);
+
+        const int node = runtime.memory_host_numa_node((void *) chunks[i]->ptr);
+        assert(node >= -1 && node < nmemories);
+
+        from = chunks[i]->ptr;
+    }
+
+    /* host tasks are enqueued onto a thread of the node holding their data
+     * (they may still be stolen by threads of other nodes) */
+    const int nplaces = device->team->desc.binding.nplaces;
+    assert(nmemories == 1 || nplaces == nmemories);
+
+    std::atomic<int> executed(0);
+    for (int i = 0 ; i < nmemories ; ++i)
+    {
+        const uintptr_t a = chunks[i]->ptr;
+        const uintptr_t b = a + S;
+
+        runtime.task_spawn<1>(
+            [a, b] (task_t * task, access_t * accesses) {
+                new (accesses + 0) access_t(task, a, b, ACCESS_MODE_R);
+            },
+
+            [&executed, a] (runtime_t * runtime, device_t * device, task_t * task) {
+                (void) runtime;
+                (void) device;
+                (void) task;
+                assert(((unsigned char *) a)[S - 1] == (unsigned char) ((S - 1) % 251));
+                ++executed;
+            }
+        );
+    }
+    runtime.task_wait();
+    assert(executed == nmemories);
+
+    for (int i = 0 ; i < nmemories ; ++i)
+        runtime.memory_device_deallocate(HOST_DEVICE_GLOBAL_ID, chunks[i]);
+    free(src);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/logger/logger.h>
+# include <xkrt/memory/access/blas/memory-tree.hpp>
+
+# include <assert.h>
+
+XKRT_NAMESPACE_USE;
+
+/* a (N x N) tile of a (LD x LD) matrix */
+# define LD 32
+# define N  8
+# define S  sizeof(double)
+
+static double A[LD * LD];
+
+/* is the element (i, j) of the tile in its lower triangle */
+# define IN_LOWER(I, J) ((I) >= (J))
+
+/* spawn a task writing the lower triangle of the tile on the device */
+static void
+write_on_device(runtime_t & runtime, device_global_id_t device_global_id)
+{
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    # define AC 1
+    constexpr task_flag_bitfield_t flags = TASK_FLAG_DEPENDENT | TASK_FLAG_DEVICE;
+    constexpr size_t task_size = task_compute_size(flags, AC);
+
+    task_t * task = thread->allocate_task(task_size);
+    new (task) task_t(XKRT_TASK_FORMAT_NULL, flags);
+
+    task_dep_info_t * dep = TASK_DEP_INFO(task);
+    new (dep) task_dep_info_t(AC);
+
+    task_dev_info_t * dev = TASK_DEV_INFO(task);
+    new (dev) task_dev_info_t(device_global_id, UNSPECIFIED_TASK_ACCESS);
+
+    access_t * accesses = TASK_ACCESSES(task, flags);
+    new (accesses + 0) access_t(task, MATRIX_COLMAJOR, MATRIX_UPLO_LOWER, A, LD, 0, 0, N, N, S, ACCESS_MODE_RW);
+    thread->resolve(accesses, AC);
+    # undef AC
+
+    runtime.task_commit(task);
+}
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    if (runtime.get_ndevices() < 2)
+    {
+        LOGGER_WARN("No device to move the tile to, skipping");
+        assert(runtime.deinit() == 0);
+        return 0;
+    }
+    const device_global_id_t device_global_id = 1;
+
+    for (int i = 0 ; i < LD * LD ; ++i)
+        A[i] = (double) i;
+
+    /* the lower triangle is only valid on the device once written there */
+    write_on_device(runtime, device_global_id);
+    runtime.task_wait();
+
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+    access_t lower(NULL, MATRIX_COLMAJOR, MATRIX_UPLO_LOWER, A, LD, 0, 0, N, N, S, ACCESS_MODE_R);
+    BLASMemoryTree * tree = (BLASMemoryTree *) task_get_memory_controller(&runtime, thread->current_task, &lower);
+    assert(tree);
+    const device_global_id_bitfield_t hostbit = (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID);
+    const device_global_id_bitfield_t devbit  = (device_global_id_bitfield_t) (1 << device_global_id);
+    assert(tree->who_owns(&lower) == devbit);
+
+    /* the strictly upper part is not accessed: it stays valid on the host,
+     * and must not be overwritten when moving the triangle back */
+    for (int j = 0 ; j < N ; ++j)
+        for (int i = 0 ; i < N ; ++i)
+            if (!IN_LOWER(i, j))
+                A[j * LD + i] = -1.0;
+
+    /* read the triangle back on the host */
+    runtime.task_spawn<1>(
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, MATRIX_COLMAJOR, MATRIX_UPLO_LOWER, A, LD, 0, 0, N, N, S, ACCESS_MODE_R);
+        },
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+            for (int j = 0 ; j < N ; ++j)
+                for (int i = 0 ; i < N ; ++i)
+                    assert(A[j * LD + i] == (IN_LOWER(i, j) ? (double) (j * LD + i) : -1.0));
+        }
+    );
+    runtime.task_wait();
+
+    /* both the host and the device now hold a valid copy of the triangle */
+    assert(tree->who_owns(&lower) == (hostbit | devbit));
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/logger/logger.h>
+# include <xkrt/memory/access/paged/memory-map.hpp>
+
+# include <assert.h>
+# include <stdlib.h>
+
+XKRT_NAMESPACE_USE;
+
+/* NG groups of 2 pages */
+# define PAGE   4096
+# define NG     64
+# define N      (NG * 2 * PAGE / sizeof(double))
+
+alignas(PAGE) static double A[N];
+
+# define PAGE_ADDR(I) ((uintptr_t) A + (I) * PAGE)
+
+/* spawn a task reading [a, b[ on the device */
+static void
+read_on_device(runtime_t & runtime, device_global_id_t device_global_id, uintptr_t a, uintptr_t b)
+{
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    # define AC 1
+    constexpr task_flag_bitfield_t flags = TASK_FLAG_DEPENDENT | TASK_FLAG_DEVICE;
+    constexpr size_t task_size = task_compute_size(flags, AC);
+
+    task_t * task = thread->allocate_task(task_size);
+    new (task) task_t(XKRT_TASK_FORMAT_NULL, flags);
+
+    task_dep_info_t * dep = TASK_DEP_INFO(task);
+    new (dep) task_dep_info_t(AC);
+
+    task_dev_info_t * dev = TASK_DEV_INFO(task);
+    new (dev) task_dev_info_t(device_global_id, UNSPECIFIED_TASK_ACCESS);
+
+    access_t * accesses = TASK_ACCESSES(task, flags);
+    new (accesses + 0) access_t(task, a, b, ACCESS_MODE_R);
+    thread->resolve(accesses, AC);
+    # undef AC
+
+    runtime.task_commit(task);
+}
+
+int
+main(void)
+{
+    setenv("SEGMENT_COHERENCY", "paged", 1);
+    setenv("SEGMENT_PAGE_SIZE", "4096", 1);
+
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    if (runtime.get_ndevices() < 2)
+    {
+        LOGGER_WARN("No device to fetch paged replicas to, skipping");
+        assert(runtime.deinit() == 0);
+        return 0;
+    }
+    const device_global_id_t device_global_id = 1;
+
+    /* initialize the data in a task, so the reads below become ready at once */
+    runtime.task_spawn<1>(
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, PAGE_ADDR(0), PAGE_ADDR(2 * NG), ACCESS_MODE_W);
+        },
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+            for (size_t i = 0 ; i < N ; ++i)
+                A[i] = (double) i;
+        }
+    );
+
+    /* for each group, a reader fetches its second page to a chunk, a second
+     * reader awaits on that copy, and a third reader of both pages remaps
+     * the second page to a new contiguous chunk while the copy is in-flight.
+     * The awaiting reader must still be released once the first copy
+     * completes, else the wait never returns */
+    for (int g = 0 ; g < NG ; ++g)
+    {
+        read_on_device(runtime, device_global_id, PAGE_ADDR(2 * g + 1), PAGE_ADDR(2 * g + 2));
+        read_on_device(runtime, device_global_id, PAGE_ADDR(2 * g + 1), PAGE_ADDR(2 * g + 2));
+        read_on_device(runtime, device_global_id, PAGE_ADDR(2 * g + 0), PAGE_ADDR(2 * g + 2));
+    }
+    runtime.task_wait();
+
+    /* every page is now valid on the host and on the device */
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+    access_t access(NULL, PAGE_ADDR(0), PAGE_ADDR(2 * NG), ACCESS_MODE_R);
+    PagedMemoryMap * map = dynamic_cast<PagedMemoryMap *>(task_get_memory_controller(&runtime, thread->current_task, &access));
+    assert(map);
+
+    const device_global_id_bitfield_t hostbit = (device_global_id_bitfield_t) (1 << HOST_DEVICE_GLOBAL_ID);
+    const device_global_id_bitfield_t devbit  = (device_global_id_bitfield_t) (1 << device_global_id);
+    for (int g = 0 ; g < NG ; ++g)
+    {
+        access_t group(NULL, PAGE_ADDR(2 * g), PAGE_ADDR(2 * g + 2), ACCESS_MODE_R);
+        assert(map->who_owns(&group) == (hostbit | devbit));
+    }
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
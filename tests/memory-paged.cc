@@ -0,0 +1,135 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/memory/access/paged/memory-map.hpp>
+
+# include <assert.h>
+# include <stdlib.h>
+
+XKRT_NAMESPACE_USE;
+
+# define PAGE 4096
+
+alignas(PAGE) static char buffer[4 * PAGE];
+
+# define ADDR(X) ((uintptr_t) (buffer + (X)))
+
+/* create a task writing [a, b[ and resolve its dependencies, without committing it */
+static task_t *
+write_task(thread_t * thread, uintptr_t a, uintptr_t b)
+{
+    # define AC 1
+    constexpr task_flag_bitfield_t flags = TASK_FLAG_DEPENDENT;
+    constexpr size_t task_size = task_compute_size(flags, AC);
+
+    task_t * task = thread->allocate_task(task_size);
+    new (task) task_t(XKRT_TASK_FORMAT_NULL, flags);
+
+    task_dep_info_t * dep = TASK_DEP_INFO(task);
+    new (dep) task_dep_info_t(AC);
+
+    access_t * accesses = TASK_ACCESSES(task, flags);
+    new (accesses + 0) access_t(task, a, b, ACCESS_MODE_W);
+    thread->resolve(accesses, AC);
+    # undef AC
+
+    return task;
+}
+
+int
+main(void)
+{
+    setenv("SEGMENT_COHERENCY", "paged", 1);
+    setenv("SEGMENT_PAGE_SIZE", "4096", 1);
+
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    // segment accesses are controlled by a paged map
+    access_t access(NULL, ADDR(0), ADDR(1), ACCESS_MODE_R);
+    PagedMemoryMap * map = dynamic_cast<PagedMemoryMap *>(task_get_memory_controller(&runtime, thread->current_task, &access));
+    assert(map);
+    assert(map->page_size == PAGE);
+    assert(map->page_of(ADDR(PAGE + 7)) == map->page_of(ADDR(0)) + 1);
+    assert(map->npages() == 0);
+
+    // an access straddling 3 pages is fetched on the host in place
+    access_t a1(NULL, ADDR(100), ADDR(2 * PAGE + 10), ACCESS_MODE_R);
+    map->fetch(&a1, HOST_DEVICE_GLOBAL_ID);
+    assert(a1.state == ACCESS_STATE_FETCHED);
+    assert(a1.device_view.addr == ADDR(100));
+    assert(map->npages() == 3);
+    assert(map->who_owns(&a1) == (1 << HOST_DEVICE_GLOBAL_ID));
+
+    // an access within a page already tracked is a single lookup
+    access_t a2(NULL, ADDR(PAGE + 8), ADDR(PAGE + 16), ACCESS_MODE_RW);
+    map->fetch(&a2, HOST_DEVICE_GLOBAL_ID);
+    assert(a2.state == ACCESS_STATE_FETCHED);
+    assert(a2.device_view.addr == ADDR(PAGE + 8));
+    assert(map->npages() == 3);
+
+    // pages never accessed are owned by the host, and are not tracked
+    access_t a3(NULL, ADDR(3 * PAGE), ADDR(4 * PAGE), ACCESS_MODE_R);
+    assert(map->who_owns(&a3) == (1 << HOST_DEVICE_GLOBAL_ID));
+    assert(map->npages() == 3);
+
+    // invalidating forgets all pages
+    map->invalidate();
+    assert(map->npages() == 0);
+
+    // writes to disjoint bytes of a same page are serialized, as pages move
+    // as a whole between devices, but not writes to different pages
+    task_t * t1 = write_task(thread, ADDR(0),        ADDR(64));
+    task_t * t2 = write_task(thread, ADDR(128),      ADDR(192));
+    task_t * t3 = write_task(thread, ADDR(PAGE + 1), ADDR(PAGE + 2));
+    assert(TASK_DEP_INFO(t1)->wc.load() == 1);
+    assert(TASK_DEP_INFO(t2)->wc.load() == 2);
+    assert(TASK_DEP_INFO(t3)->wc.load() == 1);
+    runtime.task_commit(t1);
+    runtime.task_commit(t2);
+    runtime.task_commit(t3);
+    runtime.task_wait();
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/driver/device.hpp>
+
+# include <assert.h>
+# include <stdio.h>
+# include <stdlib.h>
+
+XKRT_NAMESPACE_USE;
+
+/* the pool grows by segments of GROW bytes */
+# define GROW   (1024 * 1024)
+# define N      16
+
+int
+main(void)
+{
+    char grow[32];
+    snprintf(grow, sizeof(grow), "%d", GROW);
+    setenv("XKRT_GPU_MEM_GROW", grow, 1);
+
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    device_global_id_t device_global_id = HOST_DEVICE_GLOBAL_ID;
+    device_t * device = runtime.device_get(device_global_id);
+    assert(device);
+    area_t * area = &(device->memories[0].area);
+
+    /* nothing is allocated before the first use */
+    assert(area->reserved == 0);
+
+    /* each allocation of a full segment grows the pool by one segment */
+    area_chunk_t * chunks[N];
+    for (int i = 0 ; i < N ; ++i)
+    {
+        chunks[i] = runtime.memory_device_allocate(device_global_id, GROW);
+        assert(chunks[i]);
+        assert(area->reserved == (size_t) (i + 1) * GROW);
+        assert(area->reserved <= area->limit);
+    }
+
+    /* larger allocations grow the pool by a segment of their size */
+    area_chunk_t * large = runtime.memory_device_allocate(device_global_id, 3 * GROW);
+    assert(large);
+    assert(area->reserved == (size_t) (N + 3) * GROW);
+
+    /* small allocations share a segment */
+    area_chunk_t * small[2];
+    small[0] = runtime.memory_device_allocate(device_global_id, GROW / 4);
+    small[1] = runtime.memory_device_allocate(device_global_id, GROW / 4);
+    assert(small[0] && small[1]);
+    assert(small[1]->ptr == small[0]->ptr + GROW / 4 || small[0]->ptr == small[1]->ptr + GROW / 4);
+    assert(area->reserved == (size_t) (N + 4) * GROW);
+
+    /* the allocator state is queryable */
+    area_stats_t stats;
+    runtime.memory_device_stats(device_global_id, 0, &stats);
+    assert(stats.reserved == area->reserved);
+    assert(stats.nsegments == N + 2);
+    assert(stats.used == (size_t) (N + 3) * GROW + GROW / 2);
+    assert(stats.peak == stats.used);
+    assert(stats.nfree == 1);
+    assert(stats.free == GROW / 2);
+    assert(stats.largest == GROW / 2);
+    assert(stats.fragmentation == 0.0);
+
+    /* entirely free segments go back to the driver, but one */
+    runtime.memory_device_deallocate(device_global_id, large);
+    for (int i = 0 ; i < N ; ++i)
+        runtime.memory_device_deallocate(device_global_id, chunks[i]);
+    runtime.memory_device_deallocate(device_global_id, small[0]);
+    runtime.memory_device_deallocate(device_global_id, small[1]);
+    assert(area->reserved == GROW || area->reserved == 3 * GROW);
+
+    runtime.memory_device_stats(device_global_id, 0, &stats);
+    assert(stats.used == 0);
+    assert(stats.peak == (size_t) (N + 3) * GROW + GROW / 2);
+    assert(stats.nsegments == 1);
+    assert(stats.free == stats.reserved);
+
+    /* the pool cannot grow past its limit */
+    assert(runtime.memory_device_allocate(device_global_id, area->limit + GROW) == NULL);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+
+# include <assert.h>
+# include <stdlib.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/resource.h>
+
+XKRT_NAMESPACE_USE;
+
+/* register SIZE bytes in N chunks */
+# define SIZE   (4 * 1024 * 1024)
+# define N      8
+
+int
+main(void)
+{
+    setenv("XKRT_MEMORY_REGISTER_MLOCK", "1", 1);
+
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+    assert(runtime.conf.memory_register_mlock);
+
+    const size_t pagesize = (size_t) getpagesize();
+    const size_t npages = SIZE / pagesize;
+    void * ptr = aligned_alloc(pagesize, SIZE);
+    assert(ptr);
+
+    /* chunks are locked in parallel over the team, then registered */
+    team_t * team = runtime.team_get(XKRT_DRIVER_TYPE_HOST);
+    assert(team);
+    runtime.memory_register_async(team, ptr, SIZE, N);
+    runtime.task_wait();
+
+    /* if the process may lock that much memory, all pages got faulted */
+    struct rlimit limit;
+    assert(getrlimit(RLIMIT_MEMLOCK, &limit) == 0);
+    if (limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur >= SIZE)
+    {
+        unsigned char * resident = (unsigned char *) malloc(npages);
+        assert(resident);
+        assert(mincore(ptr, SIZE, resident) == 0);
+        for (size_t i = 0 ; i < npages ; ++i)
+            assert(resident[i] & 1);
+        free(resident);
+    }
+
+    runtime.memory_unregister_async(team, ptr, SIZE, N);
+    runtime.task_wait();
+
+    assert(runtime.deinit() == 0);
+    free(ptr);
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/memory/registered-segments.hpp>
+
+# include <assert.h>
+# include <atomic>
+# include <thread>
+# include <vector>
+
+XKRT_NAMESPACE_USE;
+
+/* segments of S bytes every 2*S bytes */
+# define S   4096
+# define N   64
+
+/* concurrent readers while segments get (un)registered */
+# define NREADERS   4
+# define NWRITES    1024
+
+int
+main(void)
+{
+    RegisteredSegments segments;
+
+    ///////////////////////////////////////////
+    // lookups                               //
+    ///////////////////////////////////////////
+
+    // insert in reverse order, snapshots stay sorted
+    for (int i = N - 1 ; i >= 0 ; --i)
+        segments.insert((uintptr_t) (2 * i * S), S);
+
+    uintptr_t last = 0;
+    int n = 0;
+    segments.foreach([&] (const RegisteredSegments::segment_t & segment) {
+        assert(segment.a >= last);
+        assert(segment.b == segment.a + S);
+        last = segment.b;
+        ++n;
+    });
+    assert(n == N);
+
+    // [S/2, 5S[ intersects the segments at 0, 2S and 4S
+    std::vector<uintptr_t> found;
+    segments.foreach_intersecting(S / 2, 5 * S, [&] (const RegisteredSegments::segment_t & segment) {
+        found.push_back(segment.a);
+    });
+    assert(found == std::vector<uintptr_t>({0, 2 * S, 4 * S}));
+
+    // [S, 2S[ is between two segments
+    found.clear();
+    segments.foreach_intersecting(S, 2 * S, [&] (const RegisteredSegments::segment_t & segment) {
+        found.push_back(segment.a);
+    });
+    assert(found.empty());
+
+    // unregister even segments
+    for (int i = 0 ; i < N ; i += 2)
+        segments.erase((uintptr_t) (2 * i * S), S);
+    found.clear();
+    segments.foreach_intersecting(0, 8 * S, [&] (const RegisteredSegments::segment_t & segment) {
+        found.push_back(segment.a);
+    });
+    assert(found == std::vector<uintptr_t>({2 * S, 6 * S}));
+
+    // unregistering a range trims and splits the segments it intersects
+    segments.erase(2 * S + S / 2, 4 * S);
+    std::vector<RegisteredSegments::segment_t> trimmed;
+    segments.foreach_intersecting(0, 16 * S, [&] (const RegisteredSegments::segment_t & segment) {
+        trimmed.push_back(segment);
+    });
+    assert(trimmed.size() == 4);
+    assert(trimmed[0].a == 2 * S            && trimmed[0].b == 2 * S + S / 2);
+    assert(trimmed[1].a == 6 * S + S / 2    && trimmed[1].b == 7 * S);
+    assert(trimmed[2].a == 10 * S           && trimmed[2].b == 11 * S);
+    assert(trimmed[3].a == 14 * S           && trimmed[3].b == 15 * S);
+
+    // unregistering within a segment splits it
+    segments.erase(10 * S + S / 4, S / 2);
+    found.clear();
+    segments.foreach_intersecting(10 * S, 11 * S, [&] (const RegisteredSegments::segment_t & segment) {
+        found.push_back(segment.a);
+    });
+    assert(found == std::vector<uintptr_t>({10 * S, 10 * S + 3 * S / 4}));
+
+    ///////////////////////////////////////////
+    // readers do not lock                   //
+    ///////////////////////////////////////////
+
+    // a segment at 'X' gets registered/unregistered while readers look it up
+    const uintptr_t X = 2 * N * S;
+    std::atomic<bool> done(false);
+    std::vector<std::thread> readers;
+    for (int r = 0 ; r < NREADERS ; ++r)
+    {
+        readers.emplace_back([&] () {
+            while (!done.load())
+            {
+                int m = 0;
+                segments.foreach_intersecting(X, X + S, [&] (const RegisteredSegments::segment_t & segment) {
+                    assert(segment.a == X && segment.b == X + S);
+                    ++m;
+                });
+                assert(m <= 1);
+            }
+        });
+    }
+
+    for (int i = 0 ; i < NWRITES ; ++i)
+    {
+        segments.insert(X, S);
+        segments.erase(X, S);
+    }
+    done.store(true);
+
+    for (std::thread & reader : readers)
+        reader.join();
+
+    return 0;
+}
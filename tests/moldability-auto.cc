@@ -0,0 +1,164 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+/**
+ *  Compare the automatic moldable split policy against fixed grains: each
+ *  configuration runs a chain of moldable tasks over the same buffer, that
+ *  either split down to a fixed number of bytes (policy 'user'), or in as
+ *  many parts as there are idle threads (policy 'auto')
+ */
+
+# include <xkrt/runtime.h>
+# include <xkrt/logger/logger.h>
+# include <xkrt/logger/metric.h>
+
+# include <atomic>
+# include <cmath>
+
+XKRT_NAMESPACE_USE;
+
+# define N      (1 << 22)
+# define ITER   16
+
+static double X[N];
+static std::atomic<int> nparts;
+
+/* the parts split while larger than that many bytes */
+static size_t grain;
+
+static void
+run(
+    runtime_t & runtime,
+    team_t * team,
+    const std::function<bool(task_t *, access_t *)> & split_condition,
+    char const * label
+) {
+    nparts = 0;
+
+    const uint64_t t0 = get_nanotime();
+    for (int it = 0 ; it < ITER ; ++it)
+    {
+        runtime.team_task_spawn<1>(
+            team,
+
+            // set accesses
+            [] (task_t * task, access_t * accesses) {
+                const uintptr_t a = (const uintptr_t) X;
+                const uintptr_t b = (const uintptr_t) (X + N);
+                new (accesses + 0) access_t(task, a, b, ACCESS_MODE_RW);
+            },
+
+            // split condition
+            split_condition,
+
+            // routine: X(i) = sqrt(X(i) + i)
+            [] (runtime_t * runtime, device_t * device, task_t * task) {
+                (void) runtime;
+                (void) device;
+
+                const access_t * access = TASK_ACCESSES(task) + 0;
+                double * x = (double *) access->region.interval.segment[0].a;
+                double * y = (double *) access->region.interval.segment[0].b;
+                for ( ; x < y ; ++x)
+                    *x = std::sqrt(*x + (double) (x - X));
+
+                ++nparts;
+            }
+        );
+    }
+    runtime.task_wait();
+    const uint64_t tf = get_nanotime();
+
+    LOGGER_INFO("%-12s - %4d parts in %lf s", label, nparts.load(), (tf - t0) / 1e9);
+    assert(nparts >= ITER);
+}
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    for (int i = 0 ; i < N ; ++i)
+        X[i] = 0.0;
+
+    team_t * team = runtime.team_get(XKRT_DRIVER_TYPE_HOST);
+
+    const std::function<bool(task_t *, access_t *)> split_condition =
+        [] (task_t * task, access_t * accesses) {
+            (void) task;
+            return accesses[0].region.interval.segment[0].length() > grain;
+        };
+
+    // fixed grains
+    runtime.conf.moldable_split = XKRT_MOLDABLE_SPLIT_POLICY_USER;
+
+    grain = sizeof(X);
+    run(runtime, team, split_condition, "no split");
+    assert(nparts == ITER);
+
+    grain = sizeof(X) / 4;
+    run(runtime, team, split_condition, "user 4");
+    assert(nparts == 4 * ITER);
+
+    grain = sizeof(X) / 64;
+    run(runtime, team, split_condition, "user 64");
+    assert(nparts == 64 * ITER);
+
+    // the runtime picks the number of parts, bounded by the idle threads
+    runtime.conf.moldable_split = XKRT_MOLDABLE_SPLIT_POLICY_AUTO;
+
+    grain = 0;
+    run(runtime, team, split_condition, "auto");
+    assert(nparts <= ITER * team->get_nthreads());
+
+    // the user condition still bounds the grain
+    grain = sizeof(X);
+    run(runtime, team, split_condition, "auto bounded");
+    assert(nparts == ITER);
+
+    // every iteration ran over the whole buffer
+    double x = 0.0;
+    for (int it = 0 ; it < 5 * ITER ; ++it)
+        x = std::sqrt(x + (double) (N - 1));
+    assert(std::fabs(X[N - 1] - x) <= 1e-9 * x);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
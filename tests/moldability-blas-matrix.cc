@@ -0,0 +1,139 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/logger/logger.h>
+
+# include <atomic>
+
+XKRT_NAMESPACE_USE;
+
+/* a (M x N) matrix split in tiles of at most (T x T) */
+# define M 64
+# define N 64
+# define T 16
+
+static double C[M * N];
+static double B[N];
+static std::atomic<int> nparts;
+static bool checked = false;
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    for (int j = 0 ; j < N ; ++j)
+        B[j] = 1000.0 * j;
+
+    team_t * team = runtime.team_get(XKRT_DRIVER_TYPE_HOST);
+
+    // split 'C' while it is larger than a tile, 'B' is read entirely by every part
+    const std::function<bool(task_t *, access_t *)> split_condition =
+        [] (task_t * task, access_t * accesses) {
+            (void) task;
+            return accesses[0].host_view.m * accesses[0].host_view.n > T * T;
+        };
+
+    runtime.team_task_spawn<2>(
+        team,
+
+        // set accesses
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, MATRIX_COLMAJOR, C, M, M, N, sizeof(double), ACCESS_MODE_W);
+            new (accesses + 1) access_t(task, MATRIX_COLMAJOR, B, 1, 1, N, sizeof(double), ACCESS_MODE_R);
+            accesses[1].split_mode = ACCESS_SPLIT_MODE_NO_SPLIT;
+        },
+
+        // split condition
+        split_condition,
+
+        // routine: C(i, j) = B(j) + i
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+
+            access_t * accesses = TASK_ACCESSES(task);
+            const memory_view_t & c = accesses[0].host_view;
+            const memory_view_t & b = accesses[1].host_view;
+            assert(c.m == T && c.n == T);
+            assert(b.addr == (uintptr_t) B && b.m == 1 && b.n == N);
+
+            const size_t offset = (c.addr - (uintptr_t) C) / sizeof(double);
+            const size_t i0 = offset % M;
+            const size_t j0 = offset / M;
+            for (size_t j = 0 ; j < c.n ; ++j)
+                for (size_t i = 0 ; i < c.m ; ++i)
+                    ((double *) c.addr)[i + j * c.ld] = B[j0 + j] + (double) (i0 + i);
+
+            ++nparts;
+        }
+    );
+
+    // the successor only runs once all the parts completed
+    runtime.team_task_spawn<1>(
+        team,
+
+        // set accesses
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, MATRIX_COLMAJOR, C, M, M, N, sizeof(double), ACCESS_MODE_R);
+        },
+
+        // routine
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+
+            assert(nparts == (M / T) * (N / T));
+            for (int j = 0 ; j < N ; ++j)
+                for (int i = 0 ; i < M ; ++i)
+                    assert(C[i + j * M] == B[j] + (double) i);
+            checked = true;
+        }
+    );
+
+    /* wait for all tasks completion */
+    runtime.task_wait();
+    assert(checked);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/logger/logger.h>
+
+# include <atomic>
+
+XKRT_NAMESPACE_USE;
+
+/* a segment of X doubles, and a (T x T) tile in a (M x M) matrix */
+# define X 1024
+# define M 64
+# define T 16
+
+/* number of reducing tasks */
+# define R 64
+
+static double x[X];
+static double A[M * M];
+static std::atomic<int> nreduces;
+static bool checked = false;
+
+static void
+sum(void * inout, const void * in, size_t size)
+{
+    double * a = (double *) inout;
+    const double * b = (const double *) in;
+    for (size_t i = 0 ; i < size / sizeof(double) ; ++i)
+        a[i] += b[i];
+}
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    team_t * team = runtime.team_get(XKRT_DRIVER_TYPE_HOST);
+
+    // initialize
+    runtime.team_task_spawn<2>(
+        team,
+
+        // set accesses
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, (uintptr_t) x, (uintptr_t) (x + X), ACCESS_MODE_W);
+            new (accesses + 1) access_t(task, MATRIX_COLMAJOR, A, M, T, T, T, T, sizeof(double), ACCESS_MODE_W);
+        },
+
+        // routine
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+
+            for (int i = 0 ; i < X ; ++i)
+                x[i] = (double) i;
+            for (int j = 0 ; j < M ; ++j)
+                for (int i = 0 ; i < M ; ++i)
+                    A[i + j * M] = -1.0;
+            for (int j = T ; j < 2 * T ; ++j)
+                for (int i = T ; i < 2 * T ; ++i)
+                    A[i + j * M] = (double) (i + j);
+        }
+    );
+
+    // reduce: tasks do not depend on each others, and accumulate into private copies
+    for (int r = 0 ; r < R ; ++r)
+    {
+        runtime.team_task_spawn<2>(
+            team,
+
+            // set accesses
+            [] (task_t * task, access_t * accesses) {
+                new (accesses + 0) access_t(task, (uintptr_t) x, (uintptr_t) (x + X), ACCESS_MODE_REDUCE);
+                new (accesses + 1) access_t(task, MATRIX_COLMAJOR, A, M, T, T, T, T, sizeof(double), ACCESS_MODE_REDUCE);
+                accesses[0].reduce_op = sum;
+                accesses[1].reduce_op = sum;
+            },
+
+            // routine
+            [] (runtime_t * runtime, device_t * device, task_t * task) {
+                (void) runtime;
+                (void) device;
+
+                access_t * accesses = TASK_ACCESSES(task);
+
+                // the private copy is not the data
+                const memory_replica_view_t & u = accesses[0].device_view;
+                assert(u.addr != (uintptr_t) x);
+                for (int i = 0 ; i < X ; ++i)
+                    ((double *) u.addr)[i] += 1.0;
+
+                const memory_replica_view_t & a = accesses[1].device_view;
+                assert(a.addr != accesses[1].host_view.addr);
+                for (size_t j = 0 ; j < T ; ++j)
+                    for (size_t i = 0 ; i < T ; ++i)
+                        ((double *) a.addr)[i + j * a.ld] += 2.0;
+
+                ++nreduces;
+            }
+        );
+    }
+
+    // the successor only runs once all partials were combined
+    runtime.team_task_spawn<2>(
+        team,
+
+        // set accesses
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, (uintptr_t) x, (uintptr_t) (x + X), ACCESS_MODE_R);
+            new (accesses + 1) access_t(task, MATRIX_COLMAJOR, A, M, M, M, sizeof(double), ACCESS_MODE_R);
+        },
+
+        // routine
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+
+            assert(nreduces == R);
+            for (int i = 0 ; i < X ; ++i)
+                assert(x[i] == (double) (i + R));
+            for (int j = 0 ; j < M ; ++j)
+                for (int i = 0 ; i < M ; ++i)
+                    if (T <= i && i < 2 * T && T <= j && j < 2 * T)
+                        assert(A[i + j * M] == (double) (i + j + 2 * R));
+                    else
+                        assert(A[i + j * M] == -1.0);
+            checked = true;
+        }
+    );
+
+    /* wait for all tasks completion */
+    runtime.task_wait();
+    assert(checked);
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
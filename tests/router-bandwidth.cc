@@ -0,0 +1,160 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/driver/queue.h>
+# include <xkrt/memory/routing/router-bandwidth.hpp>
+
+# include <assert.h>
+# include <math.h>
+# include <stdio.h>
+# include <string.h>
+
+XKRT_NAMESPACE_USE;
+
+static int
+command_launch(queue_t * queue, command_t * cmd, queue_command_list_counter_t idx)
+{
+    (void) queue;
+    (void) cmd;
+    (void) idx;
+    return 0;
+}
+
+static int
+commands_progress(queue_t * queue)
+{
+    (void) queue;
+    return 0;
+}
+
+static int
+commands_wait(queue_t * queue)
+{
+    (void) queue;
+    return 0;
+}
+
+static int
+command_wait(queue_t * queue, command_t * cmd, queue_command_list_counter_t idx)
+{
+    (void) queue;
+    (void) cmd;
+    (void) idx;
+    return 0;
+}
+
+static bool
+near(double x, double y)
+{
+    return fabs(x - y) <= 1e-6 * y;
+}
+
+int
+main(void)
+{
+    // completed copy commands are measured on their link
+    queue_t queue;
+    queue_init(&queue, XKRT_QUEUE_TYPE_D2D, 8, command_launch, commands_progress, commands_wait, command_wait);
+    {
+        queue.lock();
+        command_t * cmd = queue.command_new<false>(COMMAND_TYPE_COPY_D2D_1D);
+        assert(cmd);
+        cmd->copy_1D.size = 4096;
+        cmd->link.src = 1;
+        cmd->link.dst = 3;
+        queue.commit(cmd);
+
+        assert(queue.launch_ready_commands() == 1);
+        assert(cmd->link.launched);
+        queue.complete_command(queue.pending.pos.r);
+
+        assert(queue.links[1][3].n == 1);
+        assert(queue.links[1][3].bytes == 4096);
+        assert(queue.links[1][3].bandwidth > 0.0);
+        assert(queue.links[3][1].n == 0);
+    }
+
+    // the bandwidth is a moving average of the measures
+    queue.link_record(1, 2, 1000000000, 1000000000);
+    assert(near(queue.links[1][2].bandwidth, 1e9));
+    queue.link_record(1, 2, 2000000000, 1000000000);
+    assert(near(queue.links[1][2].bandwidth, XKRT_LINK_BANDWIDTH_EWMA_ALPHA * 2e9 + (1.0 - XKRT_LINK_BANDWIDTH_EWMA_ALPHA) * 1e9));
+    queue.link_record(3, 2, 4000000000, 1000000000);
+
+    // the router picks the source of highest bandwidth
+    RouterBandwidth router;
+    memset(router.affinity, 0, sizeof(router.affinity));
+    router.split_threshold = 1024 * 1024;
+    router.add_queue(2, &queue);
+
+    RouterBandwidth::link_t link;
+    assert(router.get_link(1, 2, &link));
+    assert(link.n == 2 && link.bytes == 3000000000);
+    assert(!router.get_link(2, 1, &link));
+
+    assert(router.get_source(2, (1 << 1) | (1 << 3)) == 3);
+    assert(router.get_source(2, (1 << 1) | (1 << 2)) == 2);
+
+    // links never measured are explored first
+    assert(router.get_source(2, (1 << 1) | (1 << 3) | (1 << 0)) == 0);
+
+    // large transfers are split proportionally to the bandwidth
+    device_global_id_t srcs[XKRT_ROUTER_SPLIT_MAX];
+    double shares[XKRT_ROUTER_SPLIT_MAX];
+    assert(router.get_sources(2, (1 << 1) | (1 << 3), 1024, srcs, shares) == 1);
+    assert(srcs[0] == 3);
+    assert(router.get_sources(2, (1 << 1) | (1 << 3), 8 * 1024 * 1024, srcs, shares) == 2);
+    assert(srcs[0] == 3 && srcs[1] == 1);
+    assert(near(shares[0] + shares[1], 1.0));
+    assert(shares[0] > shares[1]);
+
+    // estimates are dumpable
+    FILE * f = tmpfile();
+    assert(f);
+    router.dump(f);
+    rewind(f);
+    int nlines = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+        ++nlines;
+    fclose(f);
+    assert(nlines == 1 + 2);
+
+    queue_deinit(&queue);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/memory/routing/router-cfs.hpp>
+
+# include <assert.h>
+
+XKRT_NAMESPACE_USE;
+
+/* a synthetic node: the host (0) and 4 devices (1..4)
+ *  - 1 <-> 2 and 1 -> 3 are fast links
+ *  - 2 cannot reach 3 directly
+ *  - 4 is not connected */
+# define NDEVICES 5
+# define H RouterCFS::NO_LINK
+# define HOST_LINK 5
+
+static void
+synthetic_weights(uint8_t weights[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX])
+{
+    for (int i = 0 ; i < XKRT_DEVICES_MAX ; ++i)
+        for (int j = 0 ; j < XKRT_DEVICES_MAX ; ++j)
+            weights[i][j] = (i == j) ? 0 : H;
+
+    for (int i = 1 ; i < 4 ; ++i)
+        weights[HOST_DEVICE_GLOBAL_ID][i] = weights[i][HOST_DEVICE_GLOBAL_ID] = HOST_LINK;
+
+    weights[1][2] = 1;
+    weights[2][1] = 1;
+    weights[1][3] = 1;
+}
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    // the router built from the host driver affinities
+    {
+        RouterCFS router;
+        router.set_weights_from_affinity(runtime.router_affinity.affinity, runtime.drivers.devices.n);
+        assert(router.get_source(HOST_DEVICE_GLOBAL_ID, 1 << HOST_DEVICE_GLOBAL_ID) == HOST_DEVICE_GLOBAL_ID);
+
+        device_global_id_t path[XKRT_DEVICES_MAX];
+        assert(router.get_path(HOST_DEVICE_GLOBAL_ID, 1 << HOST_DEVICE_GLOBAL_ID, path) == 1);
+        assert(path[0] == HOST_DEVICE_GLOBAL_ID);
+    }
+
+    // the router built from a synthetic link matrix
+    {
+        uint8_t weights[XKRT_DEVICES_MAX][XKRT_DEVICES_MAX];
+        synthetic_weights(weights);
+
+        RouterCFS router;
+        router.set_weights(weights, NDEVICES);
+
+        device_global_id_t path[XKRT_DEVICES_MAX];
+        uint64_t cost;
+
+        // 2 -> 3 goes through 1 rather than the host
+        assert(router.get_path(3, 1 << 2, path, &cost) == 3);
+        assert(path[0] == 2 && path[1] == 1 && path[2] == 3);
+        assert(cost == 2);
+
+        // the source of the cheapest direct link is picked, as copies are not staged
+        assert(router.get_source(3, (1 << HOST_DEVICE_GLOBAL_ID) | (1 << 1)) == 1);
+        assert(router.get_source(2, (1 << HOST_DEVICE_GLOBAL_ID) | (1 << 1)) == 1);
+        assert(router.get_source(3, (1 << 3) | (1 << 1)) == 3);
+
+        // 2 is never picked for 3, as they have no direct link
+        assert(router.get_source(3, (1 << HOST_DEVICE_GLOBAL_ID) | (1 << 2)) == HOST_DEVICE_GLOBAL_ID);
+
+        // loading the link 1 -> 3 makes the host cheaper
+        for (int i = 0 ; i < 10 ; ++i)
+            router.transfer_begin(1, 3);
+        assert(router.get_link_cost(1, 3) == 11);
+        assert(router.get_source(3, (1 << HOST_DEVICE_GLOBAL_ID) | (1 << 1)) == HOST_DEVICE_GLOBAL_ID);
+
+        // and 2 -> 3 now routes through the host
+        assert(router.get_path(3, 1 << 2, path, &cost) == 3);
+        assert(path[0] == 2 && path[1] == HOST_DEVICE_GLOBAL_ID && path[2] == 3);
+        assert(cost == 2 * HOST_LINK);
+
+        // releasing the link restores the fast route
+        for (int i = 0 ; i < 10 ; ++i)
+            router.transfer_end(1, 3);
+        assert(router.get_source(3, (1 << HOST_DEVICE_GLOBAL_ID) | (1 << 1)) == 1);
+
+        // 4 is unreachable
+        assert(router.get_path(4, 1 << 1, path) == 0);
+        assert(router.get_path(3, 1 << 4, path) == 0);
+    }
+
+    runtime.deinit();
+    return 0;
+}
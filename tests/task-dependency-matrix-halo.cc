@@ -0,0 +1,133 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/memory/access/blas/dependency-tree.hpp>
+# include <xkrt/runtime.h>
+
+# include <assert.h>
+
+XKRT_NAMESPACE_USE;
+
+/* (3 x 3) tiles of (N x N) in a (LD x LD) matrix, with a border of H */
+# define LD (3 * N)
+# define N  8
+# define H  1
+# define S  sizeof(double)
+
+static double A[LD * LD];
+
+/* volume in bytes covered by the rects of the access */
+static size_t
+volume(const access_t & access)
+{
+    size_t v = 0;
+    Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+    for (const Rect & rect : access.rects(buffer))
+        if (!rect.is_empty())
+            v += (size_t) (rect[ACCESS_BLAS_ROW_DIM].length() * rect[ACCESS_BLAS_COL_DIM].length());
+    return v;
+}
+
+/* return true if 'access' conflicts with a node last written by 'write' */
+static bool
+conflicts_with(BLASDependencyTree & tree, access_t * access, const access_t * write)
+{
+    std::vector<void *> conflicts;
+    tree.conflicting(&conflicts, access);
+    for (void * node : conflicts)
+        if (((BLASDependencyTree::Node *) node)->last_write == write)
+            return true;
+    return false;
+}
+
+int
+main(void)
+{
+    //////////////////////////////////////////////////////////////
+    // Halos only cover the tile and its borders                //
+    //////////////////////////////////////////////////////////////
+
+    const matrix_halo_t halo = {H, H, H, H};
+    access_t center(NULL, MATRIX_COLMAJOR, halo, A, LD, N, N, N, N, S, ACCESS_MODE_R);
+    assert(volume(center) == (N * N + 4 * H * N) * S);
+
+    // the memory view is the tile with its halo
+    assert(center.host_view.m == N + 2 * H);
+    assert(center.host_view.n == N + 2 * H);
+    assert(center.host_view.addr == (uintptr_t) (A + (N - H) + (N - H) * LD));
+
+    // tiles on the edge of the matrix have no border outside of it
+    const matrix_halo_t corner_halo = {0, H, 0, H};
+    access_t corner(NULL, MATRIX_COLMAJOR, corner_halo, A, LD, 0, 0, N, N, S, ACCESS_MODE_R);
+    assert(volume(corner) == (N * N + 2 * H * N) * S);
+
+    //////////////////////////////////////////////////////////////
+    // Dependencies are resolved on the borders only            //
+    //////////////////////////////////////////////////////////////
+
+    access_t * tiles[3][3];
+    {
+        BLASDependencyTree tree(LD, S);
+
+        // write all tiles
+        for (int i = 0 ; i < 3 ; ++i)
+        {
+            for (int j = 0 ; j < 3 ; ++j)
+            {
+                tiles[i][j] = new access_t(NULL, MATRIX_COLMAJOR, A, LD, i * N, j * N, N, N, S, ACCESS_MODE_W);
+                tree.put(tiles[i][j]);
+            }
+        }
+
+        // the center tile halo depends on the tile and its 4 neighbours, but not on the diagonal ones
+        for (int i = 0 ; i < 3 ; ++i)
+        {
+            for (int j = 0 ; j < 3 ; ++j)
+            {
+                const bool neighbour = (i == 1 || j == 1);
+                assert(conflicts_with(tree, &center, tiles[i][j]) == neighbour);
+            }
+        }
+    }
+
+    for (int i = 0 ; i < 3 ; ++i)
+        for (int j = 0 ; j < 3 ; ++j)
+            delete tiles[i][j];
+
+    return 0;
+}
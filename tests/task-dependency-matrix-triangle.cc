@@ -0,0 +1,125 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/memory/access/blas/dependency-tree.hpp>
+# include <xkrt/runtime.h>
+
+# include <assert.h>
+
+XKRT_NAMESPACE_USE;
+
+/* (N x N) tiles in a (LD x LD) matrix */
+# define LD 32
+# define N  8
+# define S  sizeof(double)
+
+static double A[LD * LD];
+
+/* volume in bytes covered by the rects of the access */
+static size_t
+volume(const access_t & access)
+{
+    size_t v = 0;
+    Rect buffer[XKRT_ACCESS_MATRIX_RECTS];
+    for (const Rect & rect : access.rects(buffer))
+        if (!rect.is_empty())
+            v += (size_t) (rect[ACCESS_BLAS_ROW_DIM].length() * rect[ACCESS_BLAS_COL_DIM].length());
+    return v;
+}
+
+/* return true if all the nodes conflicting with 'access' were last written by 'write' */
+static bool
+conflicts_only_with(BLASDependencyTree & tree, access_t * access, const access_t * write)
+{
+    std::vector<void *> conflicts;
+    tree.conflicting(&conflicts, access);
+    for (void * node : conflicts)
+        if (((BLASDependencyTree::Node *) node)->last_write != write)
+            return false;
+    return conflicts.size() > 0;
+}
+
+int
+main(void)
+{
+    //////////////////////////////////////////////////////////////
+    // Triangular accesses only cover the triangle of the tile  //
+    //////////////////////////////////////////////////////////////
+
+    access_t full (NULL, MATRIX_COLMAJOR,                    A, LD, N, 0, N, N, S, ACCESS_MODE_R);
+    access_t lower(NULL, MATRIX_COLMAJOR, MATRIX_UPLO_LOWER, A, LD, N, 0, N, N, S, ACCESS_MODE_W);
+    access_t upper(NULL, MATRIX_COLMAJOR, MATRIX_UPLO_UPPER, A, LD, N, 0, N, N, S, ACCESS_MODE_W);
+    static_assert(N <= XKRT_ACCESS_TRIANGLE_STEPS);
+    assert(volume(full)  == N * N * S);
+    assert(volume(lower) == N * (N + 1) / 2 * S);
+    assert(volume(upper) == N * (N + 1) / 2 * S);
+
+    // on larger tiles, the staircase is coarser but still only covers the triangle and the diagonal steps
+    access_t large(NULL, MATRIX_COLMAJOR, MATRIX_UPLO_LOWER, A, LD, 0, 0, LD, N * XKRT_ACCESS_TRIANGLE_STEPS / 2, S, ACCESS_MODE_R);
+    assert(volume(large) <  LD * N * XKRT_ACCESS_TRIANGLE_STEPS / 2 * S);
+    assert(volume(large) >= LD * N * XKRT_ACCESS_TRIANGLE_STEPS / 4 * S);
+
+    //////////////////////////////////////////////////////////////
+    // Dependencies are resolved on the triangle only           //
+    //////////////////////////////////////////////////////////////
+
+    BLASDependencyTree tree(LD, S);
+
+    // the lower triangle, and the strictly upper block of the tile, are written
+    access_t block(NULL, MATRIX_COLMAJOR, A, LD, N, N/2, N/2, N/2, S, ACCESS_MODE_W);
+    tree.put(&lower);
+    tree.put(&block);
+
+    // reading the strictly lower block only conflicts with the triangle
+    access_t rl(NULL, MATRIX_COLMAJOR, A, LD, N + N/2, 0, N/2, N/2, S, ACCESS_MODE_R);
+    assert(conflicts_only_with(tree, &rl, &lower));
+
+    // reading the strictly upper block only conflicts with the block
+    access_t ru(NULL, MATRIX_COLMAJOR, A, LD, N, N/2, N/2, N/2, S, ACCESS_MODE_R);
+    assert(conflicts_only_with(tree, &ru, &block));
+
+    // reading the lower triangle only conflicts with the triangle
+    access_t rt(NULL, MATRIX_COLMAJOR, MATRIX_UPLO_LOWER, A, LD, N, 0, N, N, S, ACCESS_MODE_R);
+    assert(conflicts_only_with(tree, &rt, &lower));
+
+    // reading the whole tile conflicts with both
+    assert(!conflicts_only_with(tree, &full, &lower));
+    assert(!conflicts_only_with(tree, &full, &block));
+
+    return 0;
+}
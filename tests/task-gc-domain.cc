@@ -0,0 +1,182 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/task/format.h>
+# include <xkrt/task/task.hpp>
+
+# include <assert.h>
+# include <string.h>
+
+# include <atomic>
+
+XKRT_NAMESPACE_USE;
+
+// spawn several times the memory of a stack segment in tasks with a
+// dependency domain, each spawning dependent children, one of them spawning
+// a task whose closest domain is its grandparent, and check that domain
+// tasks got reclaimed with their children, so segments are reused
+
+# define NCHILDREN 4
+static int x[NCHILDREN];
+
+static std::atomic<int> ndomains;
+static std::atomic<int> nchildren;
+static std::atomic<int> ngrandchildren;
+
+static runtime_t runtime;
+
+constexpr task_flag_bitfield_t domain_flags = TASK_FLAG_DOMAIN;
+constexpr size_t domain_size = task_compute_size(domain_flags, 0);
+
+# define AC 1
+constexpr task_flag_bitfield_t child_flags = TASK_FLAG_DEPENDENT;
+constexpr size_t child_size = task_compute_size(child_flags, AC);
+constexpr size_t child_args_size = sizeof(int);
+
+constexpr task_flag_bitfield_t grandchild_flags = TASK_FLAG_ZERO;
+constexpr size_t grandchild_size = task_compute_size(grandchild_flags, 0);
+
+# define NTASKS_PER_BATCH 1024
+# define NSEGMENTS        16
+
+static task_format_id_t DOMAIN_FORMAT;
+static task_format_id_t CHILD_FORMAT;
+static task_format_id_t GRANDCHILD_FORMAT;
+
+static void
+grandchild_func(task_t * task)
+{
+    (void) task;
+    ++ngrandchildren;
+}
+
+static void
+child_func(task_t * task)
+{
+    ++nchildren;
+
+    // the first child spawns a task, whose closest domain is its grandparent
+    int * args = (int *) TASK_ARGS(task, child_size);
+    if (*args == 0)
+    {
+        thread_t * thread = thread_t::get_tls();
+        task_t * grandchild = thread->allocate_task(grandchild_size);
+        new (grandchild) task_t(GRANDCHILD_FORMAT, grandchild_flags);
+        runtime.task_commit(grandchild);
+        runtime.task_wait();
+    }
+}
+
+static void
+domain_func(task_t * task)
+{
+    (void) task;
+    ++ndomains;
+
+    thread_t * thread = thread_t::get_tls();
+    for (int i = 0 ; i < NCHILDREN ; ++i)
+    {
+        task_t * child = thread->allocate_task(child_size + child_args_size);
+        new (child) task_t(CHILD_FORMAT, child_flags);
+
+        task_dep_info_t * dep = TASK_DEP_INFO(child);
+        new (dep) task_dep_info_t(AC);
+
+        int * args = (int *) TASK_ARGS(child, child_size);
+        *args = i;
+
+        access_t * accesses = TASK_ACCESSES(child);
+        new (accesses + 0) access_t(child, x + i, ACCESS_MODE_RW);
+        thread->resolve(accesses, AC);
+
+        runtime.task_commit(child);
+    }
+    runtime.task_wait();
+}
+
+int
+main(void)
+{
+    assert(runtime.init() == 0);
+
+    task_format_t format;
+    memset(&format, 0, sizeof(task_format_t));
+    format.f[XKRT_TASK_FORMAT_TARGET_HOST] = (task_format_func_t) domain_func;
+    DOMAIN_FORMAT = runtime.task_format_create(&format);
+    format.f[XKRT_TASK_FORMAT_TARGET_HOST] = (task_format_func_t) child_func;
+    CHILD_FORMAT = runtime.task_format_create(&format);
+    format.f[XKRT_TASK_FORMAT_TARGET_HOST] = (task_format_func_t) grandchild_func;
+    GRANDCHILD_FORMAT = runtime.task_format_create(&format);
+    assert(DOMAIN_FORMAT && CHILD_FORMAT && GRANDCHILD_FORMAT);
+
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    // enough domain tasks to fill 'NSEGMENTS' segments if they were never reclaimed
+    const int nbatches = (int) ((NSEGMENTS * THREAD_TASKS_SEGMENT_SIZE) / (NTASKS_PER_BATCH * domain_size));
+    assert(nbatches > 1);
+
+    for (int b = 0 ; b < nbatches ; ++b)
+    {
+        for (int t = 0 ; t < NTASKS_PER_BATCH ; ++t)
+        {
+            task_t * task = thread->allocate_task(domain_size);
+            new (task) task_t(DOMAIN_FORMAT, domain_flags);
+
+            task_dom_info_t * dom = TASK_DOM_INFO(task);
+            new (dom) task_dom_info_t();
+
+            runtime.task_commit(task);
+        }
+        runtime.task_wait();
+    }
+
+    assert(ndomains.load()       == nbatches * NTASKS_PER_BATCH);
+    assert(nchildren.load()      == nbatches * NTASKS_PER_BATCH * NCHILDREN);
+    assert(ngrandchildren.load() == nbatches * NTASKS_PER_BATCH);
+
+    // segments are never reused in debug mode
+    # if !XKRT_SUPPORT_DEBUG
+    assert(thread->memory_segments_used < NSEGMENTS / 2);
+    # endif /* XKRT_SUPPORT_DEBUG */
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+
+# include <xkrt/runtime.h>
+# include <xkrt/task/format.h>
+# include <xkrt/task/task.hpp>
+
+# include <assert.h>
+# include <string.h>
+
+XKRT_NAMESPACE_USE;
+
+// spawn several times the memory of a stack segment in dependent tasks,
+// and check that completed tasks got reclaimed so segments are reused
+
+# define NHANDLES 8
+static int x[NHANDLES];
+
+# define AC 1
+constexpr task_flag_bitfield_t flags = TASK_FLAG_DEPENDENT;
+constexpr size_t task_size = task_compute_size(flags, AC);
+constexpr size_t args_size = sizeof(int);
+
+# define NTASKS_PER_BATCH 4096
+# define NSEGMENTS        16
+
+static void
+func(task_t * task)
+{
+    int * args = (int *) TASK_ARGS(task, task_size);
+    ++x[*args];
+}
+
+int
+main(void)
+{
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    task_format_id_t FORMAT;
+    {
+        task_format_t format;
+        memset(&format, 0, sizeof(task_format_t));
+        format.f[XKRT_TASK_FORMAT_TARGET_HOST] = (task_format_func_t) func;
+        FORMAT = runtime.task_format_create(&format);
+    }
+    assert(FORMAT);
+
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    // enough tasks to fill 'NSEGMENTS' segments if they were never reclaimed
+    const int nbatches = (int) ((NSEGMENTS * THREAD_TASKS_SEGMENT_SIZE) / (NTASKS_PER_BATCH * (task_size + args_size)));
+    assert(nbatches > 1);
+
+    for (int b = 0 ; b < nbatches ; ++b)
+    {
+        for (int t = 0 ; t < NTASKS_PER_BATCH ; ++t)
+        {
+            task_t * task = thread->allocate_task(task_size + args_size);
+            new (task) task_t(FORMAT, flags);
+
+            task_dep_info_t * dep = TASK_DEP_INFO(task);
+            new (dep) task_dep_info_t(AC);
+
+            int * args = (int *) TASK_ARGS(task, task_size);
+            *args = t % NHANDLES;
+
+            access_t * accesses = TASK_ACCESSES(task);
+            new (accesses + 0) access_t(task, x + *args, ACCESS_MODE_RW);
+            thread->resolve(accesses, AC);
+
+            runtime.task_commit(task);
+        }
+        runtime.task_wait();
+    }
+
+    for (int i = 0 ; i < NHANDLES ; ++i)
+        assert(x[i] == nbatches * NTASKS_PER_BATCH / NHANDLES);
+
+    // segments are never reused in debug mode
+    # if !XKRT_SUPPORT_DEBUG
+    assert(thread->memory_segments_used < NSEGMENTS / 2);
+    # endif /* XKRT_SUPPORT_DEBUG */
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}
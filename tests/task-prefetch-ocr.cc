@@ -0,0 +1,139 @@
+/*
+** Copyright 2024,2025 INRIA
+**
+** Contributors :
+** Thierry Gautier, thierry.gautier@inrialpes.fr
+** Romain PEREIRA, romain.pereira@inria.fr + rpereira@anl.gov
+**
+** This software is a computer program whose purpose is to execute
+** blas subroutines on multi-GPUs system.
+**
+** This software is governed by the CeCILL-C license under French law and
+** abiding by the rules of distribution of free software.  You can  use,
+** modify and/ or redistribute the software under the terms of the CeCILL-C
+** license as circulated by CEA, CNRS and INRIA at the following URL
+** "http://www.cecill.info".
+
+** As a counterpart to the access to the source code and  rights to copy,
+** modify and redistribute granted by the license, users are provided only
+** with a limited warranty  and the software's author,  the holder of the
+** economic rights,  and the successive licensors  have only  limited
+** liability.
+
+** In this respect, the user's attention is drawn to the risks associated
+** with loading,  using,  modifying and/or developing or reproducing the
+** software by the user in light of its specific status of free software,
+** that may mean  that it is complicated to manipulate,  and  that  also
+** therefore means  that it is reserved for developers  and  experienced
+** professionals having in-depth computer knowledge. Users are therefore
+** encouraged to load and test the software's suitability as regards their
+** requirements in conditions enabling the security of their systems and/or
+** data to be ensured and,  more generally, to use and operate it in the
+** same conditions as regards security.
+
+** The fact that you are presently reading this means that you have had
+** knowledge of the CeCILL-C license and that you accept its terms.
+**/
+
+# include <xkrt/runtime.h>
+# include <xkrt/driver/device.hpp>
+# include <xkrt/logger/logger.h>
+
+# include <assert.h>
+# include <stdlib.h>
+
+# include <atomic>
+
+XKRT_NAMESPACE_USE;
+
+/* a (M x N) tile */
+# define M 256
+# define N 256
+
+static double A[M * N];
+static std::atomic<bool> go(false);
+
+/* spawn a device task with a single access on 'A' */
+static void
+spawn_device_task(
+    runtime_t & runtime,
+    device_global_id_t device_global_id,
+    task_access_counter_t ocr,
+    access_mode_t mode
+) {
+    thread_t * thread = thread_t::get_tls();
+    assert(thread);
+
+    # define AC 1
+    constexpr task_flag_bitfield_t flags = TASK_FLAG_DEPENDENT | TASK_FLAG_DEVICE;
+    constexpr size_t task_size = task_compute_size(flags, AC);
+
+    task_t * task = thread->allocate_task(task_size);
+    new (task) task_t(XKRT_TASK_FORMAT_NULL, flags);
+
+    task_dep_info_t * dep = TASK_DEP_INFO(task);
+    new (dep) task_dep_info_t(AC);
+
+    task_dev_info_t * dev = TASK_DEV_INFO(task);
+    new (dev) task_dev_info_t(device_global_id, ocr);
+
+    access_t * accesses = TASK_ACCESSES(task, flags);
+    new (accesses + 0) access_t(task, MATRIX_COLMAJOR, A, M, M, N, sizeof(double), mode);
+    thread->resolve(accesses, AC);
+    # undef AC
+
+    runtime.task_commit(task);
+}
+
+int
+main(void)
+{
+    setenv("XKRT_TASK_PREFETCH", "1", 1);
+
+    runtime_t runtime;
+    assert(runtime.init() == 0);
+
+    if (runtime.get_ndevices() < 2)
+    {
+        LOGGER_WARN("No device to prefetch onto, skipping");
+        assert(runtime.deinit() == 0);
+        return 0;
+    }
+    const device_global_id_t device_global_id = 1;
+
+    /* hold the writer on the device until the reader got spawned, so the
+     * reader is a successor when the writer completes */
+    runtime.task_spawn<1>(
+        [] (task_t * task, access_t * accesses) {
+            new (accesses + 0) access_t(task, MATRIX_COLMAJOR, A, M, M, N, sizeof(double), ACCESS_MODE_W);
+        },
+        [] (runtime_t * runtime, device_t * device, task_t * task) {
+            (void) runtime;
+            (void) device;
+            (void) task;
+            while (!go.load())
+                ;
+        }
+    );
+
+    /* the writer, that has no input to prefetch */
+    spawn_device_task(runtime, device_global_id, UNSPECIFIED_TASK_ACCESS, ACCESS_MODE_W);
+
+    /* the reader, executed by the owner of its access */
+    spawn_device_task(runtime, UNSPECIFIED_DEVICE_GLOBAL_ID, 0, ACCESS_MODE_R);
+
+    go = true;
+    runtime.task_wait();
+
+    # if XKRT_SUPPORT_STATS
+    /* the reader input was prefetched onto the writer device, once it completed */
+    device_t * device = runtime.device_get(device_global_id);
+    assert(device);
+    assert(device->stats.memory.coherence.prefetches.load() == 1);
+    assert(device->stats.memory.coherence.prefetched.load() == M * N * sizeof(double));
+    # endif /* XKRT_SUPPORT_STATS */
+
+    assert(runtime.deinit() == 0);
+
+    return 0;
+}